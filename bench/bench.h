@@ -0,0 +1,74 @@
+/**
+ * bench.h - вспомогательные функции для замеров производительности.
+ *
+ * Бенчмарки собираются вместе со всеми .c файлами из src/, команда сборки
+ * приведена в README.
+ */
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Возвращает значение монотонных часов в наносекундах.
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+static int bench_u64_cmp(const void *l, const void *r) {
+    const uint64_t a = *(const uint64_t *) l;
+    const uint64_t b = *(const uint64_t *) r;
+    return (a > b) - (a < b);
+}
+
+// Сортирует массив замеров и возвращает q-квантиль, 0 <= q <= 1.
+static inline uint64_t bench_percentile(uint64_t *samples, const size_t n, const double q) {
+    qsort(samples, n, sizeof(uint64_t), bench_u64_cmp);
+    size_t i = (size_t) (q * (double) (n - 1));
+    return samples[i];
+}
+
+// Аллоцирует n различных ключей вида "<prefix><i>", за каждым ключом остаётся
+// место ещё для одного символа. Ключи хранятся в одном участке памяти,
+// указатель на который записан за последним ключом (keys[n]), освобождается
+// bench_keys_free.
+static inline char **bench_keys_new(const char *prefix, const size_t n) {
+    char **keys = malloc((n + 1) * sizeof(char *));
+    // Префикс, не более 20 цифр size_t, запасной символ и '\0'.
+    const size_t stride = strlen(prefix) + 22;
+    char *buf = malloc(n * stride);
+    if (keys == NULL || buf == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = buf + i * stride;
+        snprintf(keys[i], stride, "%s%zu", prefix, i);
+    }
+    keys[n] = buf;
+
+    return keys;
+}
+
+static inline void bench_keys_free(char **keys, const size_t n) {
+    free(keys[n]);
+    free(keys);
+}
+
+// Перемешивает массив ключей (Фишер-Йетс).
+static inline void bench_keys_shuffle(char **keys, const size_t n) {
+    for (size_t i = n - 1; i > 0; i--) {
+        const size_t j = (size_t) rand() % (i + 1);
+        char *tmp = keys[i];
+        keys[i] = keys[j];
+        keys[j] = tmp;
+    }
+}
+
+#endif // BENCH_H
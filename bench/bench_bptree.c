@@ -0,0 +1,104 @@
+/**
+ * bench_bptree.c - время вставки и поиска и расход памяти на ключ
+ * в BPlusTree и AVLTree.
+ *
+ * AVLTree читает по узлу, то есть по промаху кэша, на каждое сравнение,
+ * BPlusTree - по узлу из нескольких кэш-линий на уровень, а сравнения
+ * внутри узла в основном идут по префиксам без обращения к строкам ключей.
+ * Разница растёт с размером, когда дерево перестаёт помещаться в кэш.
+ *
+ * Расход памяти определяется по статистике аллокатора glibc (mallinfo2)
+ * и включает копии ключей. Ключи вставляются в случайном порядке.
+ *
+ * Запуск: bench_bptree [количество ключей...], например bench_bptree 1000000
+ * 10000000 100000000. Для 10^8 ключей нужно около 16 ГБ памяти.
+ */
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "avltree.h"
+#include "bench.h"
+#include "bptree.h"
+#include "map.h"
+
+#define DEFAULT_N 1000000
+
+// Объём выделенной памяти, включая крупные блоки, выделенные через mmap.
+static size_t heap_in_use(void) {
+    const struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+}
+
+static void bench_class(const char *name, const imap_t *class, char **keys, char **misses,
+                        const size_t n) {
+    const size_t before = heap_in_use();
+
+    void *map = map_new(class);
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < n; i++)
+        map_insert(map, keys[i], (mval_t) i);
+    const double insert = (double) (bench_now_ns() - start) / (double) n;
+
+    const size_t bytes = heap_in_use() - before;
+
+    bench_keys_shuffle(keys, n);
+
+    size_t found = 0;
+    start = bench_now_ns();
+    for (size_t i = 0; i < n; i++)
+        found += map_lookup(map, keys[i]).ok;
+    const double hit = (double) (bench_now_ns() - start) / (double) n;
+
+    start = bench_now_ns();
+    for (size_t i = 0; i < n; i++)
+        found += map_lookup(map, misses[i]).ok;
+    const double miss = (double) (bench_now_ns() - start) / (double) n;
+
+    if (found != n) {
+        fprintf(stderr, "%s: found %zu of %zu\n", name, found, n);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%-10s %10.1f %10.1f %10.1f %10.1f\n", name, insert, hit, miss,
+           (double) bytes / (double) n);
+
+    map_destroy(map);
+}
+
+static void bench_size(const size_t n) {
+    char **keys = bench_keys_new("key-", n);
+    // Отсутствующие ключи лежат между существующими.
+    char **misses = bench_keys_new("key-", n);
+    for (size_t i = 0; i < n; i++)
+        strcat(misses[i], "~");
+    bench_keys_shuffle(keys, n);
+    bench_keys_shuffle(misses, n);
+
+    printf("keys: %zu\n", n);
+    printf("%-10s %10s %10s %10s %10s\n", "map", "insert ns", "hit ns", "miss ns", "bytes/key");
+    bench_class("AVLTree", AVLTree, keys, misses, n);
+    bench_class("BPlusTree", BPlusTree, keys, misses, n);
+
+    bench_keys_free(misses, n);
+    bench_keys_free(keys, n);
+}
+
+int main(const int argc, char **argv) {
+    if (argc == 1) {
+        bench_size(DEFAULT_N);
+        return EXIT_SUCCESS;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        const size_t n = strtoull(argv[i], NULL, 10);
+        if (n == 0) {
+            fprintf(stderr, "usage: %s [keys...]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        bench_size(n);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,121 @@
+/**
+ * bench_hash.c - скорость хэш-функций (hash.h) и качество распределения
+ * ключей по бакетам HashMap и цепочкам SimpleHashMap.
+ *
+ * Для каждой функции печатается пропускная способность на ключах разной
+ * длины и гистограммы длин цепочек для структурированных ключей
+ * (общий префикс и последовательные номера).
+ *
+ * Запуск: bench_hash [количество ключей]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "hash.h"
+#include "hmap.h"
+#include "map.h"
+#include "shmap.h"
+
+#define DEFAULT_N 1000000
+#define THROUGHPUT_BYTES (256u * 1024 * 1024)
+
+static const struct {
+    const char *name;
+    hash_func_t func;
+} funcs[] = {
+    { "djb2",   djb2   },
+    { "fnv1a",  fnv1a  },
+    { "wyhash", wyhash },
+    { "xxh3",   xxh3   },
+};
+
+static const size_t lengths[] = { 4, 8, 16, 32, 64, 256, 4096 };
+
+#define LEN(arr) (sizeof(arr) / sizeof(arr[0]))
+
+// Количество различных ключей, по кругу подаваемых на вход хэш-функции.
+#define THROUGHPUT_KEYS 16
+
+// Возвращает пропускную способность хэш-функции в ГБ/с на ключах длины len.
+static double bench_throughput(const hash_func_t func, const size_t len) {
+    // Различные ключи не дают компилятору вынести вызов из цикла.
+    // Ключи не изменяются во время замера: запись байта непосредственно
+    // перед чтением словами искажает замер из-за store forwarding.
+    char *keys[THROUGHPUT_KEYS];
+    for (size_t k = 0; k < THROUGHPUT_KEYS; k++) {
+        keys[k] = malloc(len + 1);
+        for (size_t i = 0; i < len; i++)
+            keys[k][i] = (char) ('a' + (i + k) % 26);
+        keys[k][len] = '\0';
+    }
+
+    const size_t iters = THROUGHPUT_BYTES / len;
+    volatile hash_t sink = 0;
+
+    const uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < iters; i++)
+        sink ^= func((hash_t) i, keys[i % THROUGHPUT_KEYS], len);
+    const uint64_t total = bench_now_ns() - start;
+
+    (void) sink;
+    for (size_t k = 0; k < THROUGHPUT_KEYS; k++)
+        free(keys[k]);
+
+    return (double) (iters * len) / (double) total;
+}
+
+static void print_hist(const size_t *hist, const size_t n) {
+    for (size_t i = 0; i < n; i++)
+        printf(" %zu%s:%zu", i, i == n - 1 ? "+" : "", hist[i]);
+    printf("\n");
+}
+
+int main(const int argc, char **argv) {
+    const size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_N;
+    if (n == 0) {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("throughput, GB/s\n");
+    printf("%-8s", "len");
+    for (size_t l = 0; l < LEN(lengths); l++)
+        printf(" %8zu", lengths[l]);
+    printf("\n");
+    for (size_t f = 0; f < LEN(funcs); f++) {
+        printf("%-8s", funcs[f].name);
+        for (size_t l = 0; l < LEN(lengths); l++)
+            printf(" %8.2f", bench_throughput(funcs[f].func, lengths[l]));
+        printf("\n");
+    }
+
+    char **keys = bench_keys_new("user:", n);
+
+    printf("\nkeys: %zu, chain length histograms (length:chains)\n", n);
+    for (size_t f = 0; f < LEN(funcs); f++) {
+        void *hmap = map_new(HashMap, funcs[f].func);
+        void *shmap = map_new(SimpleHashMap, (size_t) 0, funcs[f].func);
+        for (size_t i = 0; i < n; i++) {
+            map_insert(hmap, keys[i], (mval_t) i);
+            map_insert(shmap, keys[i], (mval_t) i);
+        }
+
+        const hmap_stats_t hs = hmap_stats(hmap);
+        printf("%-8s HashMap:       chains %zu, overflow buckets %zu, max %zu;",
+            funcs[f].name, hs.chains, hs.overflow, hs.max_chain);
+        print_hist(hs.hist, HMAP_STATS_HIST);
+
+        const shmap_stats_t ss = shmap_stats(shmap);
+        printf("%-8s SimpleHashMap: chains %zu, max %zu;", funcs[f].name, ss.chains, ss.max_chain);
+        print_hist(ss.hist, SHMAP_STATS_HIST);
+
+        map_destroy(shmap);
+        map_destroy(hmap);
+    }
+
+    bench_keys_free(keys, n);
+
+    return EXIT_SUCCESS;
+}
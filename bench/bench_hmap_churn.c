@@ -0,0 +1,109 @@
+/**
+ * bench_hmap_churn.c - расход памяти и время поиска отсутствующих ключей
+ * в HashMap после массового удаления.
+ *
+ * Сравниваются четыре состояния таблицы: заполненная n ключами, оставшаяся
+ * после удаления 95% ключей, она же после hmap_compact и заново построенная
+ * из оставшихся ключей. При удалении таблица постепенно уменьшается,
+ * а цепочки уплотняются, hmap_compact освобождает арену длинных ключей,
+ * поэтому расход памяти и время промаха должны приближаться к заново
+ * построенной.
+ *
+ * Расход памяти определяется по статистике аллокатора glibc (mallinfo2).
+ *
+ * Запуск: bench_hmap_churn [количество ключей]
+ */
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "hash.h"
+#include "hmap.h"
+#include "map.h"
+
+#define DEFAULT_N 1000000
+#define ROUNDS 3
+// Доля ключей, остающихся в таблице после удаления: 1/LIVE_DEN.
+#define LIVE_DEN 20
+
+// Объём выделенной памяти, включая крупные блоки, выделенные через mmap.
+static size_t heap_in_use(void) {
+    const struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+}
+
+// Возвращает среднее время поиска отсутствующего ключа в наносекундах.
+static double bench_miss(const void *map, char **misses, const size_t n) {
+    size_t found = 0;
+    const uint64_t start = bench_now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < n; i++)
+            found += map_lookup(map, misses[i]).ok;
+    }
+    const double ns = (double) (bench_now_ns() - start) / (double) (n * ROUNDS);
+
+    if (found != 0) {
+        fprintf(stderr, "found %zu missing keys\n", found);
+        exit(EXIT_FAILURE);
+    }
+    return ns;
+}
+
+static void report(const char *title, const void *map, const size_t bytes,
+                   char **misses, const size_t n) {
+    const hmap_stats_t stats = hmap_stats(map);
+    printf("%-10s %10zu %10.1f %10zu %10zu %10.1f\n",
+        title,
+        stats.count,
+        (double) bytes / (1 << 20),
+        stats.chains,
+        stats.overflow,
+        bench_miss(map, misses, n)
+    );
+}
+
+int main(const int argc, char **argv) {
+    const size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_N;
+    if (n < LIVE_DEN) {
+        fprintf(stderr, "usage: %s [keys >= %d]\n", argv[0], LIVE_DEN);
+        return EXIT_FAILURE;
+    }
+    const size_t live = n / LIVE_DEN;
+
+    // Длинные ключи хранятся в арене и тоже освобождаются при удалении.
+    char **keys = bench_keys_new("some/long/prefix-", n);
+    char **misses = bench_keys_new("some/long/missing-", n);
+    bench_keys_shuffle(keys, n);
+
+    printf("keys: %zu, live after delete: %zu\n", n, live);
+    printf("%-10s %10s %10s %10s %10s %10s\n", "state", "count", "heap MiB", "chains", "overflow", "miss ns");
+
+    size_t before = heap_in_use();
+    void *map = map_new(HashMap, djb2);
+    for (size_t i = 0; i < n; i++)
+        map_insert(map, keys[i], (mval_t) i);
+    report("full", map, heap_in_use() - before, misses, n);
+
+    for (size_t i = live; i < n; i++)
+        map_remove(map, keys[i]);
+    report("deleted", map, heap_in_use() - before, misses, n);
+    if (hmap_compact(map) != 0) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    report("compacted", map, heap_in_use() - before, misses, n);
+    map_destroy(map);
+
+    before = heap_in_use();
+    map = map_new(HashMap, djb2);
+    for (size_t i = 0; i < live; i++)
+        map_insert(map, keys[i], (mval_t) i);
+    report("rebuilt", map, heap_in_use() - before, misses, n);
+    map_destroy(map);
+
+    bench_keys_free(misses, n);
+    bench_keys_free(keys, n);
+
+    return EXIT_SUCCESS;
+}
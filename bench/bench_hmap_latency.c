@@ -0,0 +1,54 @@
+/**
+ * bench_hmap_latency.c - распределение задержки одной вставки в HashMap.
+ *
+ * Рост таблицы выполняется постепенно (см. HMAP_EVACUATE_STEP в hmap.c),
+ * поэтому хвост распределения (p99, p999, max) не должен содержать
+ * вставок, перестраивающих всю таблицу целиком.
+ *
+ * Запуск: bench_hmap_latency [количество ключей]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "hash.h"
+#include "hmap.h"
+#include "map.h"
+
+#define DEFAULT_N 100000
+
+int main(const int argc, char **argv) {
+    const size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_N;
+    if (n == 0) {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char **keys = bench_keys_new("key-", n);
+    uint64_t *samples = malloc(n * sizeof(uint64_t));
+    if (samples == NULL)
+        return EXIT_FAILURE;
+
+    void *map = map_new(HashMap, djb2);
+
+    const uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < n; i++) {
+        const uint64_t t = bench_now_ns();
+        map_insert(map, keys[i], (mval_t) i);
+        samples[i] = bench_now_ns() - t;
+    }
+    const uint64_t total = bench_now_ns() - start;
+
+    printf("keys:  %zu\n", n);
+    printf("total: %.3f ms\n", (double) total / 1e6);
+    printf("p50:   %llu ns\n", (unsigned long long) bench_percentile(samples, n, 0.50));
+    printf("p99:   %llu ns\n", (unsigned long long) bench_percentile(samples, n, 0.99));
+    printf("p999:  %llu ns\n", (unsigned long long) bench_percentile(samples, n, 0.999));
+    printf("max:   %llu ns\n", (unsigned long long) samples[n - 1]);
+
+    map_destroy(map);
+    free(samples);
+    bench_keys_free(keys, n);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,91 @@
+/**
+ * bench_hmap_memory.c - расход памяти на ключ и время поиска в HashMap
+ * для коротких и длинных ключей.
+ *
+ * Короткие ключи хранятся прямо в бакете, длинные - в куче, поэтому
+ * для коротких ключей поиск не обращается к отдельному участку памяти,
+ * а расход памяти не включает накладные расходы аллокатора на каждый ключ.
+ *
+ * Расход памяти определяется по статистике аллокатора glibc (mallinfo2).
+ *
+ * Запуск: bench_hmap_memory [количество ключей]
+ */
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "hash.h"
+#include "hmap.h"
+#include "map.h"
+
+#define DEFAULT_N 1000000
+#define ROUNDS 3
+
+// Объём выделенной памяти, включая крупные блоки, выделенные через mmap.
+static size_t heap_in_use(void) {
+    const struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+}
+
+static void bench_keys(const char *title, char **keys, char **misses, const size_t n) {
+    const size_t before = heap_in_use();
+
+    void *map = map_new(HashMap, djb2);
+    for (size_t i = 0; i < n; i++)
+        map_insert(map, keys[i], (mval_t) i);
+
+    const size_t bytes = heap_in_use() - before;
+
+    bench_keys_shuffle(keys, n);
+
+    size_t found = 0;
+    uint64_t start = bench_now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < n; i++)
+            found += map_lookup(map, keys[i]).ok;
+    }
+    const double hit = (double) (bench_now_ns() - start) / (double) (n * ROUNDS);
+
+    start = bench_now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < n; i++)
+            found += map_lookup(map, misses[i]).ok;
+    }
+    const double miss = (double) (bench_now_ns() - start) / (double) (n * ROUNDS);
+
+    if (found != n * ROUNDS) {
+        fprintf(stderr, "%s: found %zu of %zu\n", title, found, n * ROUNDS);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%-8s %14.1f %12.1f %12.1f\n", title, (double) bytes / (double) n, hit, miss);
+
+    map_destroy(map);
+}
+
+int main(const int argc, char **argv) {
+    const size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_N;
+    if (n == 0) {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Ключи до 12 символов и ключи длиннее 20 символов.
+    char **short_keys = bench_keys_new("k-", n);
+    char **short_misses = bench_keys_new("m-", n);
+    char **long_keys = bench_keys_new("some/long/prefix-", n);
+    char **long_misses = bench_keys_new("some/long/missing-", n);
+
+    printf("keys: %zu\n", n);
+    printf("%-8s %14s %12s %12s\n", "keys", "bytes/key", "hit ns", "miss ns");
+    bench_keys("short", short_keys, short_misses, n);
+    bench_keys("long", long_keys, long_misses, n);
+
+    bench_keys_free(long_misses, n);
+    bench_keys_free(long_keys, n);
+    bench_keys_free(short_misses, n);
+    bench_keys_free(short_keys, n);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,51 @@
+/**
+ * bench_hmap_scaling.c - пропускная способность вставки в HashMap
+ * в зависимости от количества ключей.
+ *
+ * Проверка коэффициента заполненности выполняется за O(1), поэтому
+ * среднее время одной вставки не должно расти линейно с размером таблицы.
+ *
+ * Запуск: bench_hmap_scaling [максимальное количество ключей]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "hash.h"
+#include "hmap.h"
+#include "map.h"
+
+#define DEFAULT_MAX_N 10000000
+
+int main(const int argc, char **argv) {
+    const size_t max_n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_MAX_N;
+    if (max_n < 1000) {
+        fprintf(stderr, "usage: %s [max keys >= 1000]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char **keys = bench_keys_new("key-", max_n);
+
+    printf("%12s %12s %12s %14s\n", "keys", "total ms", "ns/insert", "inserts/s");
+    for (size_t n = 1000; n <= max_n; n *= 10) {
+        void *map = map_new(HashMap, djb2);
+
+        const uint64_t start = bench_now_ns();
+        for (size_t i = 0; i < n; i++)
+            map_insert(map, keys[i], (mval_t) i);
+        const uint64_t total = bench_now_ns() - start;
+
+        printf("%12zu %12.3f %12.1f %14.0f\n",
+            n,
+            (double) total / 1e6,
+            (double) total / (double) n,
+            (double) n / ((double) total / 1e9)
+        );
+
+        map_destroy(map);
+    }
+
+    bench_keys_free(keys, max_n);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+/**
+ * bench_lru_zipf.c - пропускная способность LRUCache на ключах
+ * с распределением Ципфа.
+ *
+ * Каждый запрос ищет ключ в кэше и при промахе вставляет его, вытесняя
+ * давно не использовавшуюся запись. Ключ с рангом r запрашивается
+ * с вероятностью, пропорциональной 1 / r^s. Замер повторяется для
+ * нескольких ёмкостей кэша относительно количества различных ключей.
+ *
+ * Сборка с -lm.
+ *
+ * Запуск: bench_lru_zipf [количество различных ключей]
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "hash.h"
+#include "lrucache.h"
+#include "map.h"
+
+#define DEFAULT_N 1000000
+#define REQUESTS 10000000
+#define ZIPF_S 0.99
+
+// Доли ёмкости кэша от количества различных ключей, в процентах.
+static const int capacities[] = { 1, 5, 10, 50 };
+
+// Возвращает ранги REQUESTS запросов из n ключей с распределением Ципфа.
+// Ранг выбирается бинарным поиском по функции распределения.
+static size_t *zipf_requests(const size_t n) {
+    double *cdf = malloc(n * sizeof(double));
+    size_t *requests = malloc(REQUESTS * sizeof(size_t));
+    if (cdf == NULL || requests == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += 1 / pow((double) (i + 1), ZIPF_S);
+        cdf[i] = sum;
+    }
+
+    for (size_t i = 0; i < REQUESTS; i++) {
+        const double u = (double) rand() / RAND_MAX * sum;
+        size_t lo = 0, hi = n - 1;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (cdf[mid] < u)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        requests[i] = lo;
+    }
+
+    free(cdf);
+    return requests;
+}
+
+int main(const int argc, char **argv) {
+    const size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_N;
+    if (n == 0) {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char **keys = bench_keys_new("key-", n);
+    // Ранг ключа не должен совпадать с порядком генерации.
+    bench_keys_shuffle(keys, n);
+    size_t *requests = zipf_requests(n);
+
+    printf("keys: %zu, requests: %d, zipf s: %.2f\n", n, REQUESTS, ZIPF_S);
+    printf("%10s %12s %10s %12s\n", "capacity", "ns/request", "hit rate", "evictions");
+    for (size_t c = 0; c < sizeof(capacities) / sizeof(capacities[0]); c++) {
+        const size_t capacity = n * capacities[c] / 100 + 1;
+        void *cache = map_new(LRUCache, capacity, wyhash);
+
+        const uint64_t start = bench_now_ns();
+        for (size_t i = 0; i < REQUESTS; i++) {
+            char *key = keys[requests[i]];
+            if (!map_lookup(cache, key).ok)
+                map_insert(cache, key, (mval_t) i);
+        }
+        const uint64_t total = bench_now_ns() - start;
+
+        const lrucache_stats_t stats = lrucache_stats(cache);
+        printf("%10zu %12.1f %9.1f%% %12zu\n",
+            capacity,
+            (double) total / REQUESTS,
+            100.0 * (double) stats.hits / (double) (stats.hits + stats.misses),
+            stats.evictions
+        );
+
+        map_destroy(cache);
+    }
+
+    free(requests);
+    bench_keys_free(keys, n);
+
+    return EXIT_SUCCESS;
+}
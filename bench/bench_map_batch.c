@@ -0,0 +1,99 @@
+/**
+ * bench_map_batch.c - пропускная способность поиска в HashMap по одному
+ * ключу (map_lookup) и массивами ключей (map_lookup_batch).
+ *
+ * По умолчанию таблица занимает сотни мегабайт, то есть заведомо больше
+ * кэша последнего уровня, и почти каждый поиск - промах кэша. Для сравнения
+ * замер повторяется на таблице, помещающейся в кэш.
+ *
+ * Запуск: bench_map_batch [количество ключей]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "hash.h"
+#include "hmap.h"
+#include "map.h"
+
+#define DEFAULT_N 4000000
+#define SMALL_N 16384
+#define ROUNDS 3
+
+static const size_t batches[] = { 16, 256, 4096 };
+
+#define LEN(arr) (sizeof(arr) / sizeof(arr[0]))
+
+// Возвращает количество найденных ключей в секунду, поиск по одному ключу.
+static double bench_single(const void *map, char **keys, const size_t n, size_t *found) {
+    const uint64_t start = bench_now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < n; i++)
+            *found += map_lookup(map, keys[i]).ok;
+    }
+    return (double) (n * ROUNDS) * 1e3 / (double) (bench_now_ns() - start);
+}
+
+// Возвращает количество найденных ключей в секунду, поиск массивами ключей.
+static double bench_batch(const void *map, char **keys, const size_t n,
+                          const size_t batch, map_res_t *results, size_t *found) {
+    const uint64_t start = bench_now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < n; i += batch) {
+            const size_t m = n - i < batch ? n - i : batch;
+            map_lookup_batch(map, keys + i, m, results);
+            for (size_t j = 0; j < m; j++)
+                *found += results[j].ok;
+        }
+    }
+    return (double) (n * ROUNDS) * 1e3 / (double) (bench_now_ns() - start);
+}
+
+static int run(const size_t n) {
+    char **keys = bench_keys_new("key-", n);
+    map_res_t *results = malloc(batches[LEN(batches) - 1] * sizeof(map_res_t));
+    if (results == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    void *map = map_new(HashMap, djb2);
+    for (size_t i = 0; i < n; i++)
+        map_insert(map, keys[i], (mval_t) i);
+
+    // Случайный порядок поиска исключает аппаратную предвыборку.
+    bench_keys_shuffle(keys, n);
+
+    size_t found = 0;
+    printf("keys: %zu\n", n);
+    printf("%-16s %12.1f Mops/s\n", "single", bench_single(map, keys, n, &found));
+    for (size_t b = 0; b < LEN(batches); b++) {
+        printf("batch %-10zu %12.1f Mops/s\n",
+            batches[b], bench_batch(map, keys, n, batches[b], results, &found));
+    }
+
+    const size_t expected = n * ROUNDS * (LEN(batches) + 1);
+    if (found != expected) {
+        fprintf(stderr, "found %zu of %zu\n", found, expected);
+        return EXIT_FAILURE;
+    }
+
+    map_destroy(map);
+    free(results);
+    bench_keys_free(keys, n);
+
+    return EXIT_SUCCESS;
+}
+
+int main(const int argc, char **argv) {
+    const size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_N;
+    if (n == 0) {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (run(n) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    printf("\n");
+    return run(SMALL_N);
+}
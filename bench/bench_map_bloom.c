@@ -0,0 +1,109 @@
+/**
+ * bench_map_bloom.c - время поиска в деревьях с фильтром Блума (BloomMap)
+ * и без него.
+ *
+ * Промах в дереве стоит O(log n) сравнений строк, а в BloomMap
+ * в большинстве случаев - одной проверки кэш-линии фильтра.
+ * Попадание в BloomMap дороже на вычисление хэша и проверку фильтра.
+ *
+ * Запуск: bench_map_bloom [количество ключей]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "avltree.h"
+#include "bench.h"
+#include "bloommap.h"
+#include "bstree.h"
+#include "hash.h"
+#include "map.h"
+
+#define DEFAULT_N 1000000
+#define ROUNDS 3
+#define FPR 0.01
+
+static size_t n;
+
+static void *new_avltree(void) {
+    return map_new(AVLTree);
+}
+
+static void *new_bloom_avltree(void) {
+    return map_new(BloomMap, n, FPR, wyhash, AVLTree);
+}
+
+static void *new_bstree(void) {
+    return map_new(BinarySearchTree);
+}
+
+static void *new_bloom_bstree(void) {
+    return map_new(BloomMap, n, FPR, wyhash, BinarySearchTree);
+}
+
+static const struct {
+    const char *name;
+    void *(*new)(void);
+} maps[] = {
+    { "AVLTree",          new_avltree       },
+    { "BloomMap(AVL)",    new_bloom_avltree },
+    { "BinarySearchTree", new_bstree        },
+    { "BloomMap(BST)",    new_bloom_bstree  },
+};
+
+// Возвращает среднее время поиска одного ключа в наносекундах.
+static double bench_lookup(const void *map, char **keys, const size_t n, size_t *found) {
+    const uint64_t start = bench_now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < n; i++)
+            *found += map_lookup(map, keys[i]).ok;
+    }
+    return (double) (bench_now_ns() - start) / (double) (n * ROUNDS);
+}
+
+int main(const int argc, char **argv) {
+    n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_N;
+    if (n == 0) {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char **keys = bench_keys_new("key-", n);
+    // Отсутствующие ключи лежат между существующими, поэтому промах
+    // в дереве проходит путь полной длины, а не только крайний правый.
+    char **misses = bench_keys_new("key-", n);
+    for (size_t i = 0; i < n; i++)
+        strcat(misses[i], "~");
+    bench_keys_shuffle(misses, n);
+
+    // Без перемешивания BinarySearchTree вырождается в список.
+    bench_keys_shuffle(keys, n);
+
+    printf("keys: %zu, filter fpr: %.2f\n", n, FPR);
+    printf("%-18s %12s %12s %12s\n", "map", "insert ns", "hit ns", "miss ns");
+    for (size_t m = 0; m < sizeof(maps) / sizeof(maps[0]); m++) {
+        void *map = maps[m].new();
+
+        const uint64_t start = bench_now_ns();
+        for (size_t i = 0; i < n; i++)
+            map_insert(map, keys[i], (mval_t) i);
+        const double insert = (double) (bench_now_ns() - start) / (double) n;
+
+        size_t found = 0;
+        const double hit = bench_lookup(map, keys, n, &found);
+        const double miss = bench_lookup(map, misses, n, &found);
+        if (found != n * ROUNDS) {
+            fprintf(stderr, "%s: found %zu of %zu\n", maps[m].name, found, n * ROUNDS);
+            return EXIT_FAILURE;
+        }
+
+        printf("%-18s %12.1f %12.1f %12.1f\n", maps[m].name, insert, hit, miss);
+
+        map_destroy(map);
+    }
+
+    bench_keys_free(misses, n);
+    bench_keys_free(keys, n);
+
+    return EXIT_SUCCESS;
+}
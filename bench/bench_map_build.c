@@ -0,0 +1,122 @@
+/**
+ * bench_map_build.c - время загрузки упорядоченных ключей в AVLTree
+ * и BinarySearchTree по одному ключу (map_insert) и целиком
+ * (map_build_sorted, map_insert_sorted).
+ *
+ * build - загрузка всех ключей в пустое дерево, merge - вставка каждого
+ * четвёртого ключа в дерево из остальных. По одному ключи вставляются
+ * в AVLTree по порядку, а в BinarySearchTree - в случайном порядке:
+ * упорядоченная вставка вырождает BinarySearchTree в список.
+ *
+ * Запуск: bench_map_build [количество ключей], по умолчанию 10^6.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "avltree.h"
+#include "bench.h"
+#include "bstree.h"
+#include "map.h"
+
+#define DEFAULT_N 1000000
+
+static int key_cmp(const void *l, const void *r) {
+    return strcmp(*(char *const *) l, *(char *const *) r);
+}
+
+static double ms_since(const uint64_t start) {
+    return (double) (bench_now_ns() - start) / 1e6;
+}
+
+// Вставляет ключи по одному и возвращает время в миллисекундах.
+static double insert_each(void *map, char **keys, const mval_t *values, const size_t n,
+                          const int shuffle) {
+    if (shuffle)
+        bench_keys_shuffle(keys, n);
+    const uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < n; i++)
+        map_insert(map, keys[i], values[i]);
+    const double ms = ms_since(start);
+    if (shuffle)
+        qsort(keys, n, sizeof(char *), key_cmp);
+    return ms;
+}
+
+static void check(const void *map, char **keys, const size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (!map_lookup(map, keys[i]).ok) {
+            fprintf(stderr, "key %s not found\n", keys[i]);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+static void bench_class(const char *name, const imap_t *class, char **keys, char **base,
+                        char **batch, const mval_t *values, const size_t n, const int shuffle) {
+    const size_t nbatch = (n + 3) / 4;
+    const size_t nbase = n - nbatch;
+
+    void *map = map_new(class);
+    const double build_each = insert_each(map, keys, values, n, shuffle);
+    check(map, keys, n);
+    map_destroy(map);
+
+    uint64_t start = bench_now_ns();
+    map = map_build_sorted(class, keys, values, n);
+    const double build = ms_since(start);
+    check(map, keys, n);
+    map_destroy(map);
+
+    map = map_build_sorted(class, base, values, nbase);
+    const double merge_each = insert_each(map, batch, values, nbatch, shuffle);
+    check(map, keys, n);
+    map_destroy(map);
+
+    map = map_build_sorted(class, base, values, nbase);
+    start = bench_now_ns();
+    map_insert_sorted(map, batch, values, nbatch);
+    const double merge = ms_since(start);
+    check(map, keys, n);
+    map_destroy(map);
+
+    printf("%-18s %12.1f %12.1f %12.1f %12.1f\n", name, build_each, build, merge_each, merge);
+}
+
+int main(const int argc, char **argv) {
+    const size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_N;
+    if (n == 0) {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char **keys = bench_keys_new("key-", n);
+    qsort(keys, n, sizeof(char *), key_cmp);
+
+    char **base = malloc(n * sizeof(char *));
+    char **batch = malloc(n * sizeof(char *));
+    mval_t *values = malloc(n * sizeof(mval_t));
+    if (base == NULL || batch == NULL || values == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    size_t nbase = 0, nbatch = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (i % 4 == 0)
+            batch[nbatch++] = keys[i];
+        else
+            base[nbase++] = keys[i];
+        values[i] = (mval_t) i;
+    }
+
+    printf("keys: %zu\n", n);
+    printf("%-18s %12s %12s %12s %12s\n", "map", "insert ms", "build ms", "insert ms", "merge ms");
+    bench_class("AVLTree", AVLTree, keys, base, batch, values, n, 0);
+    bench_class("BinarySearchTree", BinarySearchTree, keys, base, batch, values, n, 1);
+
+    free(values);
+    free(batch);
+    free(base);
+    bench_keys_free(keys, n);
+    return EXIT_SUCCESS;
+}
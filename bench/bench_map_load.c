@@ -0,0 +1,101 @@
+/**
+ * bench_map_load.c - время массовой загрузки ключей и уничтожения мапы.
+ *
+ * Ключи всех мап хранятся в арене (arena.h), поэтому загрузка не вызывает
+ * malloc на каждый ключ, а уничтожение освобождает все ключи разом.
+ *
+ * Запуск: bench_map_load [количество ключей]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "avltree.h"
+#include "bench.h"
+#include "bstree.h"
+#include "hash.h"
+#include "hmap.h"
+#include "map.h"
+#include "rhmap.h"
+#include "shmap.h"
+#include "swissmap.h"
+
+#define DEFAULT_N 1000000
+
+static void *new_bstree(void) {
+    return map_new(BinarySearchTree);
+}
+
+static void *new_avltree(void) {
+    return map_new(AVLTree);
+}
+
+static void *new_shmap(void) {
+    return map_new(SimpleHashMap, (size_t) 0, djb2);
+}
+
+static void *new_hmap(void) {
+    return map_new(HashMap, djb2);
+}
+
+static void *new_swissmap(void) {
+    return map_new(SwissMap, djb2);
+}
+
+static void *new_rhmap(void) {
+    return map_new(RobinHoodMap, djb2);
+}
+
+static const struct {
+    const char *name;
+    void *(*new)(void);
+} maps[] = {
+    { "BinarySearchTree", new_bstree   },
+    { "AVLTree",          new_avltree  },
+    { "SimpleHashMap",    new_shmap    },
+    { "HashMap",          new_hmap     },
+    { "SwissMap",         new_swissmap },
+    { "RobinHoodMap",     new_rhmap    },
+};
+
+int main(const int argc, char **argv) {
+    const size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_N;
+    if (n == 0) {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Ключи длиннее места под ключ в бакете HashMap.
+    char **keys = bench_keys_new("some/long/prefix-", n);
+    // Без перемешивания бинарное дерево поиска вырождается в список.
+    bench_keys_shuffle(keys, n);
+
+    printf("keys: %zu\n", n);
+    printf("%-16s %12s %12s %12s\n", "map", "load ms", "churn ms", "destroy ms");
+    for (size_t m = 0; m < sizeof(maps) / sizeof(maps[0]); m++) {
+        void *map = maps[m].new();
+
+        uint64_t start = bench_now_ns();
+        for (size_t i = 0; i < n; i++)
+            map_insert(map, keys[i], (mval_t) i);
+        const double load = (double) (bench_now_ns() - start) / 1e6;
+
+        // Удаление и повторная вставка четверти ключей
+        // переиспользуют освобождённые блоки арены.
+        start = bench_now_ns();
+        for (size_t i = 0; i < n / 4; i++)
+            map_remove(map, keys[i]);
+        for (size_t i = 0; i < n / 4; i++)
+            map_insert(map, keys[i], (mval_t) i);
+        const double churn = (double) (bench_now_ns() - start) / 1e6;
+
+        start = bench_now_ns();
+        map_destroy(map);
+        const double destroy = (double) (bench_now_ns() - start) / 1e6;
+
+        printf("%-16s %12.1f %12.1f %12.1f\n", maps[m].name, load, churn, destroy);
+    }
+
+    bench_keys_free(keys, n);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+/**
+ * bench_map_lookup.c - время поиска существующих и отсутствующих ключей
+ * в хэш-таблицах при высоком коэффициенте заполненности.
+ *
+ * По умолчанию количество ключей подобрано так, что SwissMap заполнена
+ * почти до предельных 7/8.
+ *
+ * Запуск: bench_map_lookup [количество ключей]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "hash.h"
+#include "hmap.h"
+#include "map.h"
+#include "rhmap.h"
+#include "shmap.h"
+#include "swissmap.h"
+
+#define DEFAULT_N 900000
+#define ROUNDS 3
+
+static void *new_shmap(void) {
+    return map_new(SimpleHashMap, (size_t) 0, djb2);
+}
+
+static void *new_hmap(void) {
+    return map_new(HashMap, djb2);
+}
+
+static void *new_swissmap(void) {
+    return map_new(SwissMap, djb2);
+}
+
+static void *new_rhmap(void) {
+    return map_new(RobinHoodMap, djb2);
+}
+
+static void report_rhmap(const void *map) {
+    const rhmap_stats_t stats = rhmap_stats(map);
+    printf("%-16s load %.3f, probe length: mean %.3f, variance %.3f, max %zu\n",
+        "",
+        (double) stats.count / (double) stats.cap,
+        stats.mean_probe,
+        stats.var_probe,
+        stats.max_probe
+    );
+}
+
+static const struct {
+    const char *name;
+    void *(*new)(void);
+    // Печатает дополнительную статистику заполненной таблицы.
+    void (*report)(const void *);
+} maps[] = {
+    { "SimpleHashMap", new_shmap,    NULL         },
+    { "HashMap",       new_hmap,     NULL         },
+    { "SwissMap",      new_swissmap, NULL         },
+    { "RobinHoodMap",  new_rhmap,    report_rhmap },
+};
+
+// Возвращает среднее время поиска одного ключа в наносекундах.
+static double bench_lookup(const void *map, char **keys, const size_t n, size_t *found) {
+    const uint64_t start = bench_now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < n; i++)
+            *found += map_lookup(map, keys[i]).ok;
+    }
+    return (double) (bench_now_ns() - start) / (double) (n * ROUNDS);
+}
+
+int main(const int argc, char **argv) {
+    const size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_N;
+    if (n == 0) {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char **keys = bench_keys_new("key-", n);
+    char **misses = bench_keys_new("miss-", n);
+
+    printf("keys: %zu\n", n);
+    printf("%-16s %12s %12s %12s\n", "map", "insert ns", "hit ns", "miss ns");
+    for (size_t m = 0; m < sizeof(maps) / sizeof(maps[0]); m++) {
+        void *map = maps[m].new();
+
+        const uint64_t start = bench_now_ns();
+        for (size_t i = 0; i < n; i++)
+            map_insert(map, keys[i], (mval_t) i);
+        const double insert = (double) (bench_now_ns() - start) / (double) n;
+
+        bench_keys_shuffle(keys, n);
+
+        size_t found = 0;
+        const double hit = bench_lookup(map, keys, n, &found);
+        const double miss = bench_lookup(map, misses, n, &found);
+        if (found != n * ROUNDS) {
+            fprintf(stderr, "%s: found %zu of %zu\n", maps[m].name, found, n * ROUNDS);
+            return EXIT_FAILURE;
+        }
+
+        printf("%-16s %12.1f %12.1f %12.1f\n", maps[m].name, insert, hit, miss);
+        if (maps[m].report)
+            maps[m].report(map);
+
+        map_destroy(map);
+    }
+
+    bench_keys_free(misses, n);
+    bench_keys_free(keys, n);
+
+    return EXIT_SUCCESS;
+}
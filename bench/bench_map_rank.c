@@ -0,0 +1,93 @@
+/**
+ * bench_map_rank.c - время запросов порядковых статистик к AVLTree:
+ * ключа по рангу (map_select) и количества ключей в диапазоне
+ * (map_count_range) в сравнении с обходом курсором и map_range.
+ *
+ * Каждый запрос выбирает случайный ранг или диапазон. Обход проходит
+ * в среднем половину ключей, запросы порядковых статистик - один путь
+ * от корня.
+ *
+ * Запуск: bench_map_rank [количество ключей], по умолчанию 10^6.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "avltree.h"
+#include "bench.h"
+#include "map.h"
+
+#define DEFAULT_N 1000000
+
+// Количество запросов обходом и запросов порядковых статистик.
+#define SCAN_QUERIES 20
+#define QUERIES 1000000
+
+static int count_cb(const string_t *key, const mval_t value, void *arg) {
+    (void) key;
+    (void) value;
+    (*(size_t *) arg)++;
+    return 0;
+}
+
+int main(const int argc, char **argv) {
+    const size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_N;
+    if (n == 0) {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char **keys = bench_keys_new("key-", n);
+    bench_keys_shuffle(keys, n);
+    void *map = map_new(AVLTree);
+    for (size_t i = 0; i < n; i++)
+        map_insert(map, keys[i], (mval_t) i);
+
+    // Ключ по рангу: обход курсором от начала и map_select.
+    size_t sum = 0;
+    uint64_t start = bench_now_ns();
+    for (int q = 0; q < SCAN_QUERIES; q++) {
+        const size_t k = (size_t) rand() % n;
+        map_iter_t it;
+        map_iter_init(map, &it);
+        map_iter_next(&it);
+        for (size_t i = 0; i < k; i++)
+            map_iter_next(&it);
+        sum += (size_t) it.value;
+    }
+    const double select_scan = (double) (bench_now_ns() - start) / SCAN_QUERIES;
+
+    start = bench_now_ns();
+    for (int q = 0; q < QUERIES; q++) {
+        map_iter_t it;
+        map_select(map, (size_t) rand() % n, &it);
+        sum += (size_t) it.value;
+    }
+    const double select = (double) (bench_now_ns() - start) / QUERIES;
+
+    // Количество ключей в диапазоне: map_range и map_count_range.
+    start = bench_now_ns();
+    for (int q = 0; q < SCAN_QUERIES; q++) {
+        char *lo = keys[(size_t) rand() % n];
+        size_t count = 0;
+        map_range(map, lo, NULL, count_cb, &count);
+        sum += count;
+    }
+    const double count_scan = (double) (bench_now_ns() - start) / SCAN_QUERIES;
+
+    start = bench_now_ns();
+    for (int q = 0; q < QUERIES; q++) {
+        size_t count;
+        map_count_range(map, keys[(size_t) rand() % n], NULL, &count);
+        sum += count;
+    }
+    const double count = (double) (bench_now_ns() - start) / QUERIES;
+
+    printf("keys: %zu (checksum %zu)\n", n, sum);
+    printf("%-12s %14s %14s\n", "query", "scan ns", "log n ns");
+    printf("%-12s %14.1f %14.1f\n", "select", select_scan, select);
+    printf("%-12s %14.1f %14.1f\n", "count range", count_scan, count);
+
+    map_destroy(map);
+    bench_keys_free(keys, n);
+    return EXIT_SUCCESS;
+}
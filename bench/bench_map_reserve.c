@@ -0,0 +1,89 @@
+/**
+ * bench_map_reserve.c - время массовой загрузки ключей в хэш-таблицы
+ * без резервирования и с предварительным map_reserve.
+ *
+ * Без резервирования HashMap начинает с 16 бакетов и удваивается около
+ * 20 раз, перенося все записи при каждом удвоении.
+ *
+ * Запуск: bench_map_reserve [количество ключей]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "hash.h"
+#include "hmap.h"
+#include "map.h"
+#include "rhmap.h"
+#include "shmap.h"
+#include "swissmap.h"
+
+#define DEFAULT_N 10000000
+
+static void *new_shmap(void) {
+    return map_new(SimpleHashMap, (size_t) 0, djb2);
+}
+
+static void *new_hmap(void) {
+    return map_new(HashMap, djb2);
+}
+
+static void *new_swissmap(void) {
+    return map_new(SwissMap, djb2);
+}
+
+static void *new_rhmap(void) {
+    return map_new(RobinHoodMap, djb2);
+}
+
+static const struct {
+    const char *name;
+    void *(*new)(void);
+} maps[] = {
+    { "SimpleHashMap", new_shmap    },
+    { "HashMap",       new_hmap     },
+    { "SwissMap",      new_swissmap },
+    { "RobinHoodMap",  new_rhmap    },
+};
+
+// Возвращает время загрузки n ключей в миллисекундах.
+// Время резервирования входит в замер.
+static double bench_load(void *map, char **keys, const size_t n, const int reserve) {
+    const uint64_t start = bench_now_ns();
+    if (reserve && map_reserve(map, n) != 0) {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < n; i++)
+        map_insert(map, keys[i], (mval_t) i);
+    return (double) (bench_now_ns() - start) / 1e6;
+}
+
+int main(const int argc, char **argv) {
+    const size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_N;
+    if (n == 0) {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char **keys = bench_keys_new("key-", n);
+    bench_keys_shuffle(keys, n);
+
+    printf("keys: %zu\n", n);
+    printf("%-16s %12s %12s %8s\n", "map", "load ms", "reserve ms", "speedup");
+    for (size_t m = 0; m < sizeof(maps) / sizeof(maps[0]); m++) {
+        void *map = maps[m].new();
+        const double plain = bench_load(map, keys, n, 0);
+        map_destroy(map);
+
+        map = maps[m].new();
+        const double reserved = bench_load(map, keys, n, 1);
+        map_destroy(map);
+
+        printf("%-16s %12.1f %12.1f %7.2fx\n", maps[m].name, plain, reserved, plain / reserved);
+    }
+
+    bench_keys_free(keys, n);
+
+    return EXIT_SUCCESS;
+}
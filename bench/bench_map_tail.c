@@ -0,0 +1,95 @@
+/**
+ * bench_map_tail.c - распределение задержки одного поиска в CuckooMap и HashMap
+ * при заполненности таблицы кукушки 90% и выше.
+ *
+ * CuckooMap просматривает не более двух бакетов на любой запрос, поэтому
+ * хвост распределения (p99, p999) должен оставаться близким к медиане.
+ * В HashMap хвост определяется длиной цепочек бакетов переполнения.
+ * Каждый поиск замеряется отдельно, попадания и промахи - раздельно.
+ *
+ * Запуск: bench_map_tail [количество ключей]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "cuckoomap.h"
+#include "hash.h"
+#include "hmap.h"
+#include "map.h"
+
+#define DEFAULT_N 950000
+
+static void report(const char *name, uint64_t *samples, const size_t n) {
+    // bench_percentile сортирует замеры, поэтому максимум берётся после неё.
+    const uint64_t p50 = bench_percentile(samples, n, 0.50);
+    printf("  %-5s p50 %5llu ns  p99 %5llu ns  p999 %6llu ns  max %7llu ns\n", name,
+           (unsigned long long) p50,
+           (unsigned long long) bench_percentile(samples, n, 0.99),
+           (unsigned long long) bench_percentile(samples, n, 0.999),
+           (unsigned long long) samples[n - 1]);
+}
+
+static void bench_lookup(const char *name, void *map, char **keys, char **missing,
+                         const size_t n, uint64_t *samples) {
+    volatile mval_t sink = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        const uint64_t t = bench_now_ns();
+        sink += map_lookup(map, keys[i]).data;
+        samples[i] = bench_now_ns() - t;
+    }
+    printf("%s\n", name);
+    report("hit", samples, n);
+
+    for (size_t i = 0; i < n; i++) {
+        const uint64_t t = bench_now_ns();
+        sink += map_lookup(map, missing[i]).ok;
+        samples[i] = bench_now_ns() - t;
+    }
+    report("miss", samples, n);
+    (void) sink;
+}
+
+int main(const int argc, char **argv) {
+    const size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_N;
+    if (n == 0) {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char **keys = bench_keys_new("key-", n);
+    char **missing = bench_keys_new("missing-", n);
+    uint64_t *samples = malloc(n * sizeof(uint64_t));
+    if (samples == NULL)
+        return EXIT_FAILURE;
+
+    void *cuckoo = map_new(CuckooMap, djb2);
+    void *hmap = map_new(HashMap, djb2);
+    for (size_t i = 0; i < n; i++) {
+        map_insert(cuckoo, keys[i], (mval_t) i);
+        map_insert(hmap, keys[i], (mval_t) i);
+    }
+
+    const cuckoomap_stats_t cs = cuckoomap_stats(cuckoo);
+    const hmap_stats_t hs = hmap_stats(hmap);
+    printf("keys: %zu\n", n);
+    printf("CuckooMap: occupancy %.1f%%, stashed %zu\n",
+           100.0 * (double) cs.count / (double) cs.cap, cs.stashed);
+    printf("HashMap:   %.2f entries per chain, max chain %zu, overflow buckets %zu\n",
+           (double) hs.count / (double) hs.chains, hs.max_chain, hs.overflow);
+
+    bench_keys_shuffle(keys, n);
+    bench_keys_shuffle(missing, n);
+
+    bench_lookup("CuckooMap", cuckoo, keys, missing, n, samples);
+    bench_lookup("HashMap", hmap, keys, missing, n, samples);
+
+    map_destroy(hmap);
+    map_destroy(cuckoo);
+    free(samples);
+    bench_keys_free(missing, n);
+    bench_keys_free(keys, n);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+/**
+ * bench_pavltree.c - пропускная способность поиска в PersistentAVLTree
+ * и в AVLTree под блокировкой чтения-записи (pthread_rwlock_t) при
+ * одновременной записи.
+ *
+ * Читатели ищут случайные существующие ключи, один писатель всё это время
+ * обновляет значения и вставляет и удаляет дополнительные ключи. Для каждого
+ * количества читателей выводится суммарная пропускная способность поиска
+ * и записи.
+ *
+ * Сборка с -pthread.
+ *
+ * Запуск: bench_pavltree [количество ключей [наибольшее количество читателей]],
+ * по умолчанию 10^6 ключей и 8 читателей.
+ */
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "avltree.h"
+#include "bench.h"
+#include "map.h"
+#include "pavltree.h"
+
+#define DEFAULT_N 1000000
+#define DEFAULT_READERS 8
+
+// Количество поисков каждого читателя.
+#define LOOKUPS 1000000
+
+// Количество дополнительных ключей писателя.
+#define EXTRA_KEYS 4096
+
+typedef struct {
+    void             *map;
+    pthread_rwlock_t *lock; // NULL для PersistentAVLTree
+    char            **keys;
+    char            **extra;
+    size_t            n;
+    atomic_int        done;
+    size_t            writes;
+} bench_t;
+
+typedef struct {
+    bench_t *bench;
+    unsigned seed;
+    size_t   sum;
+} reader_t;
+
+static void *reader(void *arg) {
+    reader_t *r = arg;
+    const bench_t *b = r->bench;
+    for (int i = 0; i < LOOKUPS; i++) {
+        char *key = b->keys[(size_t) rand_r(&r->seed) % b->n];
+        if (b->lock != NULL)
+            pthread_rwlock_rdlock(b->lock);
+        const map_res_t res = map_lookup(b->map, key);
+        if (b->lock != NULL)
+            pthread_rwlock_unlock(b->lock);
+        if (!res.ok) {
+            fprintf(stderr, "key %s not found\n", key);
+            exit(EXIT_FAILURE);
+        }
+        r->sum += (size_t) res.data;
+    }
+    return NULL;
+}
+
+static void *writer(void *arg) {
+    bench_t *b = arg;
+    unsigned seed = 1;
+    for (size_t i = 0; !atomic_load_explicit(&b->done, memory_order_relaxed); i++) {
+        const size_t k = (size_t) rand_r(&seed);
+        if (b->lock != NULL)
+            pthread_rwlock_wrlock(b->lock);
+        switch (i % 3) {
+        case 0:
+            map_insert(b->map, b->keys[k % b->n], (mval_t) i);
+            break;
+        case 1:
+            map_insert(b->map, b->extra[k % EXTRA_KEYS], (mval_t) i);
+            break;
+        default:
+            map_remove(b->map, b->extra[k % EXTRA_KEYS]);
+        }
+        if (b->lock != NULL)
+            pthread_rwlock_unlock(b->lock);
+        b->writes++;
+    }
+    return NULL;
+}
+
+// Запускает читателей и писателя и возвращает пропускную способность
+// в миллионах операций в секунду.
+static void run(bench_t *b, const int nreaders, double *lookups, double *writes) {
+    reader_t *readers = malloc((size_t) nreaders * sizeof(reader_t));
+    pthread_t *threads = malloc((size_t) nreaders * sizeof(pthread_t));
+    if (readers == NULL || threads == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    atomic_store(&b->done, 0);
+    b->writes = 0;
+    pthread_t writer_thread;
+    const uint64_t start = bench_now_ns();
+    pthread_create(&writer_thread, NULL, writer, b);
+    for (int i = 0; i < nreaders; i++) {
+        readers[i] = (reader_t){.bench = b, .seed = (unsigned) i + 1};
+        pthread_create(&threads[i], NULL, reader, &readers[i]);
+    }
+    for (int i = 0; i < nreaders; i++)
+        pthread_join(threads[i], NULL);
+    const double sec = (double) (bench_now_ns() - start) / 1e9;
+    atomic_store(&b->done, 1);
+    pthread_join(writer_thread, NULL);
+
+    *lookups = (double) nreaders * LOOKUPS / sec / 1e6;
+    *writes = (double) b->writes / sec / 1e6;
+
+    free(threads);
+    free(readers);
+}
+
+int main(const int argc, char **argv) {
+    const size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_N;
+    const int max_readers = argc > 2 ? atoi(argv[2]) : DEFAULT_READERS;
+    if (n == 0 || max_readers <= 0) {
+        fprintf(stderr, "usage: %s [keys [readers]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char **keys = bench_keys_new("key-", n);
+    char **extra = bench_keys_new("extra-", EXTRA_KEYS);
+    bench_keys_shuffle(keys, n);
+
+    pthread_rwlock_t lock;
+    pthread_rwlock_init(&lock, NULL);
+    bench_t avl = {.map = map_new(AVLTree), .lock = &lock, .keys = keys, .extra = extra, .n = n};
+    bench_t pavl = {.map = map_new(PersistentAVLTree), .keys = keys, .extra = extra, .n = n};
+    for (size_t i = 0; i < n; i++) {
+        map_insert(avl.map, keys[i], (mval_t) i);
+        map_insert(pavl.map, keys[i], (mval_t) i);
+    }
+
+    printf("keys: %zu, lookups per reader: %d\n", n, LOOKUPS);
+    printf("%-8s %14s %14s %14s %14s\n", "", "rwlock AVL", "", "persistent", "");
+    printf("%-8s %14s %14s %14s %14s\n", "readers", "lookup Mop/s", "write Mop/s", "lookup Mop/s",
+           "write Mop/s");
+    for (int t = 1; t <= max_readers; t *= 2) {
+        double avl_lookups, avl_writes, pavl_lookups, pavl_writes;
+        run(&avl, t, &avl_lookups, &avl_writes);
+        run(&pavl, t, &pavl_lookups, &pavl_writes);
+        printf("%-8d %14.2f %14.2f %14.2f %14.2f\n", t, avl_lookups, avl_writes, pavl_lookups,
+               pavl_writes);
+    }
+
+    const pavltree_stats_t stats = pavltree_stats(pavl.map);
+    printf("pending versions: %zu, retired nodes: %zu\n", stats.versions, stats.retired);
+
+    map_destroy(pavl.map);
+    map_destroy(avl.map);
+    pthread_rwlock_destroy(&lock);
+    bench_keys_free(extra, EXTRA_KEYS);
+    bench_keys_free(keys, n);
+    return EXIT_SUCCESS;
+}
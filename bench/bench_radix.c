@@ -0,0 +1,96 @@
+/**
+ * bench_radix.c - время вставки и поиска и расход памяти на ключ
+ * в RadixTree, AVLTree и BPlusTree на ключах с длинным общим префиксом.
+ *
+ * Ключи - пути вида /srv/www/static/img-N. Деревья сравнений сравнивают
+ * общий префикс заново на каждом уровне, а RadixTree проходит его один
+ * раз и сравнивает ключ целиком только с ключом найденного листа.
+ *
+ * Расход памяти определяется по статистике аллокатора glibc (mallinfo2)
+ * и включает копии ключей. Ключи вставляются в случайном порядке.
+ *
+ * Запуск: bench_radix [количество ключей]
+ */
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "avltree.h"
+#include "bench.h"
+#include "bptree.h"
+#include "map.h"
+#include "radix.h"
+
+#define DEFAULT_N 1000000
+
+#define KEY_PREFIX "/srv/www/static/img-"
+
+// Объём выделенной памяти, включая крупные блоки, выделенные через mmap.
+static size_t heap_in_use(void) {
+    const struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+}
+
+static void bench_class(const char *name, const imap_t *class, char **keys, char **misses,
+                        const size_t n) {
+    const size_t before = heap_in_use();
+
+    void *map = map_new(class);
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < n; i++)
+        map_insert(map, keys[i], (mval_t) i);
+    const double insert = (double) (bench_now_ns() - start) / (double) n;
+
+    const size_t bytes = heap_in_use() - before;
+
+    bench_keys_shuffle(keys, n);
+
+    size_t found = 0;
+    start = bench_now_ns();
+    for (size_t i = 0; i < n; i++)
+        found += map_lookup(map, keys[i]).ok;
+    const double hit = (double) (bench_now_ns() - start) / (double) n;
+
+    start = bench_now_ns();
+    for (size_t i = 0; i < n; i++)
+        found += map_lookup(map, misses[i]).ok;
+    const double miss = (double) (bench_now_ns() - start) / (double) n;
+
+    if (found != n) {
+        fprintf(stderr, "%s: found %zu of %zu\n", name, found, n);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%-10s %10.1f %10.1f %10.1f %10.1f\n", name, insert, hit, miss,
+           (double) bytes / (double) n);
+
+    map_destroy(map);
+}
+
+int main(const int argc, char **argv) {
+    const size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_N;
+    if (n == 0) {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char **keys = bench_keys_new(KEY_PREFIX, n);
+    // Отсутствующие ключи отличаются от существующих последним байтом.
+    char **misses = bench_keys_new(KEY_PREFIX, n);
+    for (size_t i = 0; i < n; i++)
+        strcat(misses[i], "~");
+    bench_keys_shuffle(keys, n);
+    bench_keys_shuffle(misses, n);
+
+    printf("keys: %zu\n", n);
+    printf("%-10s %10s %10s %10s %10s\n", "map", "insert ns", "hit ns", "miss ns", "bytes/key");
+    bench_class("AVLTree", AVLTree, keys, misses, n);
+    bench_class("BPlusTree", BPlusTree, keys, misses, n);
+    bench_class("RadixTree", RadixTree, keys, misses, n);
+
+    bench_keys_free(misses, n);
+    bench_keys_free(keys, n);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+/**
+ * arena.h - арена (пул) памяти для хранения ключей ассоциативных массивов.
+ *
+ * Память выделяется крупными участками (чанками), из которых блоки
+ * нарезаются последовательно. Блоки округляются до классов размеров,
+ * кратных ARENA_ALIGN, и освобождённый блок попадает в список свободных
+ * блоков своего класса, откуда переиспользуется следующим выделением того
+ * же класса. Блоки больше ARENA_MAX_SMALL байт выделяются отдельно через
+ * malloc, но также принадлежат арене.
+ *
+ * Уничтожение арены освобождает все блоки разом, без обхода структуры
+ * данных, которая ими пользовалась.
+ */
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Выравнивание и шаг классов размеров блоков.
+#define ARENA_ALIGN 16
+
+// Максимальный размер блока, нарезаемого из чанка.
+#define ARENA_MAX_SMALL 256
+
+// Количество классов размеров: 16, 32, ..., ARENA_MAX_SMALL.
+#define ARENA_CLASSES (ARENA_MAX_SMALL / ARENA_ALIGN)
+
+// Размер чанка по умолчанию.
+#define ARENA_CHUNK_SIZE (64 * 1024)
+
+struct arena_chunk;
+struct arena_large;
+
+typedef struct {
+    // Список чанков, первый - текущий, из которого нарезаются блоки.
+    struct arena_chunk *chunks;
+
+    // Списки освобождённых блоков по классам размеров.
+    void *free_lists[ARENA_CLASSES];
+
+    // Список отдельно выделенных больших блоков.
+    struct arena_large *large;
+} arena_t;
+
+/**
+ * Инициализирует пустую арену. Память не выделяется.
+ * @param self арена.
+ */
+void arena_init(arena_t *self);
+
+/**
+ * Освобождает всю память арены, включая все выделенные из неё блоки.
+ * После вызова арена пуста и может использоваться повторно.
+ * @param self арена.
+ */
+void arena_destroy(arena_t *self);
+
+/**
+ * Передаёт все блоки арены other арене self, после чего other пуста.
+ * Блоки other остаются действительными и освобождаются вместе с self.
+ * @param self  арена-получатель.
+ * @param other арена, блоки которой передаются.
+ */
+void arena_merge(arena_t *self, arena_t *other);
+
+/**
+ * Выделяет блок памяти, выровненный по ARENA_ALIGN.
+ * @param  self арена.
+ * @param  size размер блока, > 0.
+ * @return Указатель на блок или NULL, если не удалось выделить память.
+ */
+void *arena_alloc(arena_t *self, size_t size);
+
+/**
+ * Возвращает блок в арену для переиспользования.
+ * @param self арена.
+ * @param p    блок, выделенный arena_alloc этой арены, или NULL.
+ * @param size размер, переданный arena_alloc при выделении блока.
+ */
+void arena_free(arena_t *self, void *p, size_t size);
+
+/**
+ * Копирует строку в арену.
+ * @param  self арена.
+ * @param  str  строка.
+ * @return Копия строки или NULL, если не удалось выделить память.
+ */
+char *arena_strdup(arena_t *self, const char *str);
+
+/**
+ * Копирует len байтов строки в арену и дописывает '\0'.
+ * @param  self арена.
+ * @param  str  строка, не обязательно оканчивающаяся '\0'.
+ * @param  len  длина строки.
+ * @return Копия строки или NULL, если не удалось выделить память.
+ */
+char *arena_strndup(arena_t *self, const char *str, size_t len);
+
+/**
+ * Возвращает строку, скопированную arena_strdup или arena_strndup, в арену.
+ * @param self арена.
+ * @param str  строка, скопированная arena_strdup этой арены, или NULL.
+ */
+void arena_free_str(arena_t *self, char *str);
+
+#endif // ARENA_H
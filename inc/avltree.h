@@ -1,6 +1,15 @@
 /**
  * avltree.h - Сбалансированное бинарное дерево поиска
  * из курса Типов и структур данных ИУ7.
+ *
+ * Узлы хранятся в одном растущем массиве и ссылаются на детей 32-битными
+ * индексами, освобождённые узлы переиспользуются через список свободных.
+ * Узел занимает 40 байтов без заголовка malloc, а уничтожение дерева
+ * освобождает все узлы одним вызовом free. map_reserve выделяет массив
+ * под заданное количество записей заранее.
+ *
+ * Узлы хранят размеры поддеревьев, поэтому map_rank, map_select
+ * и map_count_range работают за O(log n).
  */
 #ifndef AVLTREE_H
 #define AVLTREE_H
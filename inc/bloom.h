@@ -0,0 +1,102 @@
+/**
+ * bloom.h - блочный фильтр Блума.
+ *
+ * Фильтр отвечает на вопрос "мог ли ключ быть добавлен": ответ "нет" точен,
+ * ответ "да" ложен с вероятностью не больше заданной (FPR).
+ *
+ * Все биты одного ключа лежат в одном блоке размером с кэш-линию (64 байта),
+ * поэтому добавление и проверка обращаются ровно к одной кэш-линии.
+ * Платой является немного большая доля ложных срабатываний, чем у
+ * классического фильтра того же размера.
+ *
+ * Фильтр работает с хэшем ключа (hash.h), вычисленным вызывающей стороной,
+ * поэтому ключ хэшируется один раз, даже если хэш нужен и самой мапе.
+ *
+ * bloom_t хранит по одному биту на позицию и не поддерживает удаление.
+ * cbloom_t (counting) хранит 4-битные счётчики: удаление уменьшает счётчики
+ * ключа. Счётчик, достигший 15, больше не уменьшается, что может лишь
+ * увеличить долю ложных срабатываний.
+ */
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hash.h"
+
+// Размер блока в байтах.
+#define BLOOM_BLOCK_SIZE 64
+
+typedef struct {
+    uint64_t *blocks;     // nblocks блоков по BLOOM_BLOCK_SIZE байт.
+    size_t    nblocks;
+    unsigned  k;          // Количество бит на ключ.
+} bloom_t;
+
+typedef struct {
+    uint8_t  *blocks;     // nblocks блоков по BLOOM_BLOCK_SIZE байт, 2 счётчика в байте.
+    size_t    nblocks;
+    unsigned  k;          // Количество счётчиков на ключ.
+} cbloom_t;
+
+/**
+ * Инициализирует пустой фильтр, рассчитанный на n ключей с долей ложных
+ * срабатываний fpr. При большем количестве ключей фильтр продолжает
+ * работать, но доля ложных срабатываний растёт.
+ * @param  self фильтр.
+ * @param  n    ожидаемое количество ключей.
+ * @param  fpr  допустимая доля ложных срабатываний, 0 < fpr < 1.
+ * @return 0, EINVAL или ENOMEM (err.h).
+ */
+int bloom_init(bloom_t *self, size_t n, double fpr);
+
+/**
+ * Освобождает память фильтра.
+ * @param self фильтр.
+ */
+void bloom_destroy(bloom_t *self);
+
+/**
+ * Добавляет ключ с хэшем hash.
+ * @param self фильтр.
+ * @param hash хэш ключа.
+ */
+void bloom_add(bloom_t *self, hash_t hash);
+
+/**
+ * Проверяет, мог ли быть добавлен ключ с хэшем hash.
+ * @param  self фильтр.
+ * @param  hash хэш ключа.
+ * @return 0 если ключ точно не добавлялся, иначе 1.
+ */
+int bloom_test(const bloom_t *self, hash_t hash);
+
+/**
+ * Удаляет из фильтра все ключи.
+ * @param self фильтр.
+ */
+void bloom_clear(bloom_t *self);
+
+/**
+ * См. bloom_init. Фильтр со счётчиками занимает в 4 раза больше памяти.
+ */
+int cbloom_init(cbloom_t *self, size_t n, double fpr);
+
+void cbloom_destroy(cbloom_t *self);
+
+void cbloom_add(cbloom_t *self, hash_t hash);
+
+/**
+ * Удаляет ключ с хэшем hash. Ключ должен быть ранее добавлен,
+ * иначе фильтр может начать давать ложноотрицательные ответы.
+ * @param self фильтр.
+ * @param hash хэш ключа.
+ */
+void cbloom_remove(cbloom_t *self, hash_t hash);
+
+int cbloom_test(const cbloom_t *self, hash_t hash);
+
+void cbloom_clear(cbloom_t *self);
+
+#endif // BLOOM_H
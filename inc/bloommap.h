@@ -0,0 +1,30 @@
+/**
+ * bloommap.h - фильтр Блума перед произвольной мапой.
+ *
+ * Обёртка хранит записи во вложенной мапе любого класса и поддерживает
+ * блочный фильтр Блума со счётчиками (bloom.h) по её ключам. Поиск
+ * отсутствующего ключа в большинстве случаев завершается проверкой
+ * одной кэш-линии фильтра, без обхода вложенной мапы: это полезно для
+ * деревьев, где промах стоит O(log n) сравнений строк.
+ *
+ * Вставка и удаление изменяют и фильтр, и вложенную мапу. Фильтр не растёт:
+ * если ключей больше, чем ожидалось при создании, доля ложных срабатываний
+ * увеличивается, но ответы остаются верными.
+ */
+#ifndef BLOOMMAP_H
+#define BLOOMMAP_H
+
+#include "map.h"
+
+extern const imap_t BloomMapClass;
+// map_new(BloomMap, (size_t) expected_keys, (double) fpr, hash_function, InnerMap, inner_args...)
+static const imap_t *BloomMap = &BloomMapClass;
+
+/**
+ * Возвращает вложенную мапу.
+ * @param  self объект класса BloomMap.
+ * @return Вложенная мапа.
+ */
+void *bloommap_inner(const void *self);
+
+#endif // BLOOMMAP_H
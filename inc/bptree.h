@@ -0,0 +1,45 @@
+/**
+ * bptree.h - B+ дерево.
+ *
+ * Записи хранятся только в листьях, внутренние узлы содержат ключи-
+ * разделители и указатели на детей. Узел вмещает до BPTREE_MAX_KEYS ключей
+ * и занимает несколько кэш-линий, поэтому дерево из n записей имеет высоту
+ * порядка log16(n), а поиск читает по одному узлу на уровень, а не по узлу
+ * на каждое сравнение, как AVLTree.
+ *
+ * Рядом с указателем на ключ в узле хранятся первые 8 байтов ключа
+ * в порядке big-endian (префикс). Сравнение префиксов как целых чисел
+ * совпадает с лексикографическим сравнением строк, поэтому бинарный поиск
+ * внутри узла обращается к самому ключу только при совпадении префиксов.
+ *
+ * Листья связаны в двусвязанный список для последовательного обхода.
+ */
+#ifndef BPTREE_H
+#define BPTREE_H
+
+#include "map.h"
+
+// Максимальное количество ключей в узле.
+#define BPTREE_MAX_KEYS 16
+
+extern const imap_t BPlusTreeClass;
+// map_new(BPlusTree)
+static const imap_t *BPlusTree = &BPlusTreeClass;
+
+// Статистика дерева.
+typedef struct {
+    size_t count;       // Количество записей.
+    size_t height;      // Количество уровней, 1 - только корневой лист.
+    size_t leaves;      // Количество листьев.
+    size_t inners;      // Количество внутренних узлов.
+    size_t node_bytes;  // Память узлов, без копий ключей.
+} bptree_stats_t;
+
+/**
+ * Возвращает статистику дерева за O(1).
+ * @param  self объект класса BPlusTree.
+ * @return Статистика дерева.
+ */
+bptree_stats_t bptree_stats(const void *self);
+
+#endif // BPTREE_H
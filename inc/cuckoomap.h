@@ -0,0 +1,46 @@
+/**
+ * cuckoomap.h - хэш-таблица кукушки (cuckoo hashing) с бакетами.
+ *
+ * Каждый ключ может храниться только в одном из двух бакетов, номера
+ * которых вычисляются одной хэш-функцией с двумя разными зёрнами.
+ * Бакет содержит 4 записи и занимает одну кэш-линию, поэтому поиск
+ * просматривает не более двух кэш-линий бакетов независимо от заполненности.
+ *
+ * Если оба бакета нового ключа заполнены, поиском в ширину находится
+ * кратчайшая цепочка перемещений записей в их альтернативные бакеты,
+ * освобождающая место. Если такой цепочки нет, запись попадает в небольшой
+ * список переполнения (stash), а при его заполнении таблица перестраивается
+ * с новыми зёрнами и, если заполнена хотя бы наполовину, растёт.
+ * Заполненность таблицы может достигать 95%.
+ *
+ * Ключи, хэши которых совпадают при любом зерне (например, у djb2 - ключи
+ * одной длины из блоков "Aa" и "B@"), не разделит никакое перестроение.
+ * Такие записи остаются в списке переполнения, который растёт без
+ * ограничений; поиск просматривает его целиком.
+ */
+#ifndef CUCKOOMAP_H
+#define CUCKOOMAP_H
+
+#include "map.h"
+
+extern const imap_t CuckooMapClass;
+// map_new(CuckooMap, hash_function)
+static const imap_t *CuckooMap = &CuckooMapClass;
+
+// Статистика заполненности таблицы.
+typedef struct {
+    size_t count;       // Количество записей, включая список переполнения.
+    size_t cap;         // Количество мест во всех бакетах.
+    size_t stashed;     // Количество записей в списке переполнения.
+    size_t dropped;     // Количество записей, не вставленных из-за нехватки
+                        // памяти.
+} cuckoomap_stats_t;
+
+/**
+ * Возвращает статистику заполненности за O(1).
+ * @param  self объект класса CuckooMap.
+ * @return Статистика заполненности.
+ */
+cuckoomap_stats_t cuckoomap_stats(const void *self);
+
+#endif // CUCKOOMAP_H
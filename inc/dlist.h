@@ -75,6 +75,17 @@ static inline DNODE(T) *DLIST_ADD_HEAD(T) (DNODE(T) *prev, DNODE(T) *head) {
     return prev;
 }
 
+#define DLIST_DEL(type) GENERIC_METHOD(dlist, del, type)
+// Исключает узел из списка. Узел становится циклом из одного себя,
+// память узла не освобождается.
+static inline void DLIST_DEL(T) (DNODE(T) *node) {
+    assert(node);
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->next = node;
+    node->prev = node;
+}
+
 #define DLIST_ENTRY(type) GENERIC_METHOD(dlist, entry, type)
 // Возвращает данные узла.
 static inline T DLIST_ENTRY(T) (const DNODE(T) *node) {
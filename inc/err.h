@@ -6,6 +6,7 @@
 #define EIO    5    // Ошибка I/O.
 #define ENOMEM 12   // Ошибка выделения памяти.
 #define EINVAL 22   // Некорректные данные.
+#define ENOTSUP 95  // Операция не поддерживается.
 
 // Возвращает 1, если указатель является кодом ошибки.
 #define IS_ERR_VALUE(x) ((unsigned long)(void *)(x) >= (unsigned long)-MAX_ERRNO)
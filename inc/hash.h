@@ -1,9 +1,37 @@
 #ifndef HASH_H
 #define HASH_H
 
+#include <stddef.h>
+
 typedef unsigned hash_t;
-typedef hash_t (*hash_func_t)(hash_t seed, const char *key);
+// Хэш-функция от ключа длины len. Ключ не обязан оканчиваться '\0',
+// поэтому хэшировать можно подстроку буфера без копирования.
+typedef hash_t (*hash_func_t)(hash_t seed, const char *key, size_t len);
+
+// Хэш-функции семейства hash_func_t. Любая из них может быть передана
+// в конструктор хэш-таблицы, например map_new(HashMap, wyhash).
+
+// djb2 - сдвиг и сложение, один байт за итерацию.
+hash_t djb2(hash_t salt, const char *key, size_t len);
+
+// FNV-1a - xor и умножение, один байт за итерацию. Базовый уровень
+// для сравнения: распределяет лучше djb2 при той же скорости.
+hash_t fnv1a(hash_t salt, const char *key, size_t len);
+
+// wyhash - перемешивание 64-битным умножением с 128-битным результатом,
+// 8-16 байт за итерацию.
+hash_t wyhash(hash_t salt, const char *key, size_t len);
+
+// Хэш в стиле XXH3: блоки по 16 байт перемешиваются с секретом
+// умножением 64 x 64 -> 128 бит.
+hash_t xxh3(hash_t salt, const char *key, size_t len);
 
-hash_t djb2(hash_t salt, const char *key);
+/**
+ * Финальное перемешивание битов хэша (finalizer из MurmurHash3).
+ * Делает все биты результата зависимыми от всех битов аргумента.
+ * Используется таблицами с открытой адресацией, которым нужны хорошо
+ * перемешанные и младшие, и старшие биты хэша.
+ */
+hash_t hash_mix(hash_t h);
 
 #endif // HASH_H
@@ -3,12 +3,21 @@
  *
  * В сравнении с shmap.h улучшенная производительность достигается за счёт:
  * - развёрнутого списка (buckets) хранения;
- * - хранения high-order bytes (HOB) хэша для проверки отсутствия элемента в таблице;
+ * - хранения полного хэша ключа для проверки отсутствия элемента в таблице
+ *   и переноса записей при росте без повторного хэширования;
+ * - хранения коротких ключей прямо в бакете без отдельной аллокации;
+ * - постепенного роста таблицы: бакеты переносятся в новый массив
+ *   по несколько штук за вставку или удаление;
+ * - постепенного уменьшения таблицы и освобождения пустых бакетов
+ *   переполнения после массового удаления;
  * - использование побитовых операций с хэшем вместо арифметических.
  *
  * Аналогично shmap.h используются:
  * - метод деления для вычисления позиции элемента;
  * - открытая адресация (метод цепочек) для решения коллизий.
+ *
+ * Поиск (map_lookup, map_lookup_batch) не изменяет таблицу, поэтому
+ * допускается из нескольких потоков одновременно, если нет записи.
  */
 #ifndef HMAP_H
 #define HMAP_H
@@ -19,4 +28,38 @@ extern const imap_t HashMapClass;
 // map_new(HashMap, hash_function)
 static const imap_t *HashMap = &HashMapClass;
 
+// Количество столбцов гистограммы длин цепочек.
+#define HMAP_STATS_HIST 17
+
+// Статистика заполненности бакетов.
+// Цепочкой называется бакет основного массива вместе с его бакетами переполнения.
+typedef struct {
+    size_t count;       // Количество записей.
+    size_t chains;      // Количество цепочек.
+    size_t overflow;    // Количество бакетов переполнения.
+    size_t max_chain;   // Максимальное количество записей в цепочке.
+
+    // hist[i] - количество цепочек из i записей, последний столбец -
+    // цепочки из HMAP_STATS_HIST - 1 записей и более.
+    size_t hist[HMAP_STATS_HIST];
+} hmap_stats_t;
+
+/**
+ * Собирает статистику заполненности бакетов за O(количество бакетов).
+ * @param  self объект класса HashMap.
+ * @return Статистика заполненности.
+ */
+hmap_stats_t hmap_stats(const void *self);
+
+/**
+ * Завершает текущее изменение размера таблицы и уплотняет арену длинных
+ * ключей: копирует ключи в новую арену и освобождает старую целиком.
+ * Удаление освобождает место ключа только для повторного использования
+ * ареной, поэтому после массового удаления память возвращается этим
+ * вызовом за O(количество записей).
+ * @param  self объект класса HashMap.
+ * @return 0 или ENOMEM (err.h).
+ */
+int hmap_compact(void *self);
+
 #endif // HMAP_H
@@ -0,0 +1,46 @@
+/**
+ * lrucache.h - кэш ограниченной ёмкости с вытеснением давно не
+ * использовавшихся записей (LRU, least recently used).
+ *
+ * Индекс ключей - хэш-таблица с открытой адресацией и линейным
+ * пробированием, места которой хранят номера узлов; ключи сравниваются
+ * с единственной копией ключа в узле. Порядок использования хранится
+ * в двусвязанном циклическом списке (dlist.h): после головы идёт последняя
+ * использованная запись, перед головой - кандидат на вытеснение. Поиск,
+ * вставка и вытеснение выполняются за O(1).
+ *
+ * Узлы и индекс (не меньше двух мест на запись) выделяются в конструкторе,
+ * удаление из индекса сдвигает цепочку пробирования без удалённых мест,
+ * поэтому в установившемся режиме вставка с вытеснением не вызывает malloc
+ * и не перестраивает индекс, а копии ключей переиспользуют освобождённые
+ * блоки арены (arena.h).
+ *
+ * Поиск (map_lookup) считается использованием записи: он переносит запись
+ * в начало списка и обновляет счётчики, хотя принимает const void *.
+ */
+#ifndef LRUCACHE_H
+#define LRUCACHE_H
+
+#include "map.h"
+
+extern const imap_t LRUCacheClass;
+// map_new(LRUCache, (size_t) capacity, hash_function)
+static const imap_t *LRUCache = &LRUCacheClass;
+
+// Счётчики кэша.
+typedef struct {
+    size_t count;       // Количество записей.
+    size_t capacity;    // Максимальное количество записей.
+    size_t hits;        // Количество найденных ключей.
+    size_t misses;      // Количество не найденных ключей.
+    size_t evictions;   // Количество вытесненных записей.
+} lrucache_stats_t;
+
+/**
+ * Возвращает счётчики кэша за O(1).
+ * @param  self объект класса LRUCache.
+ * @return Счётчики кэша.
+ */
+lrucache_stats_t lrucache_stats(const void *self);
+
+#endif // LRUCACHE_H
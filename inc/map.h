@@ -7,6 +7,7 @@
 #ifndef MAP_H
 #define MAP_H
 
+#include <stdarg.h>
 #include <stddef.h>
 
 #include "str.h"
@@ -28,6 +29,27 @@ typedef struct {
     int    ok;    // 1 если значение найдено, иначе 0.
 } map_res_t;
 
+// Наибольшее количество узлов пути, которое хранит курсор.
+#define MAP_ITER_DEPTH 96
+
+// Курсор упорядоченного обхода мапы (см. map_iter_init).
+// Поля key и value - текущая запись. Остальные поля - состояние курсора,
+// которым распоряжается класс мапы.
+typedef struct {
+    const void     *map;
+    const string_t *key;    // Текущий ключ или NULL, если курсор в конце.
+    mval_t          value;  // Значение текущего ключа.
+
+    const void     *node;
+    size_t          pos;
+    int             depth;
+    const void     *path[MAP_ITER_DEPTH];
+} map_iter_t;
+
+// Функция, которую map_range вызывает для каждой записи диапазона.
+// Возвращает 0, чтобы продолжить обход, иначе обход прекращается.
+typedef int (*map_range_cb_t)(const string_t *key, mval_t value, void *arg);
+
 // Дескриптор мапы (словаря).
 typedef struct {
     // size указывает на объём памяти, требуемый для выделения
@@ -43,10 +65,48 @@ typedef struct {
     void (*dtor)(void *);
 
     // Методы мапы.
+    // Класс реализует методы для ключей, оканчивающихся '\0', методы для
+    // ключей, заданных указателем и длиной (_n), или оба варианта.
+    // Недостающий вариант выражается через имеющийся.
 
     void (*insert)(void *, mkey_t, mval_t);
     map_res_t (*lookup)(const void *, mkey_t);
     int (*remove)(void *, mkey_t);
+
+    void (*insert_n)(void *, const string_t *, size_t, mval_t);
+    map_res_t (*lookup_n)(const void *, const string_t *, size_t);
+    int (*remove_n)(void *, const string_t *, size_t);
+
+    // Поиск массива ключей. Необязательный метод: если класс его
+    // не реализует, ключи ищутся по одному.
+    void (*lookup_batch)(const void *, const mkey_t *, size_t, map_res_t *);
+
+    // Резервирование места под n записей. Необязательный метод: классы,
+    // которым нечего резервировать, его не реализуют.
+    int (*reserve)(void *, size_t);
+
+    // Вставка n ключей, упорядоченных по возрастанию. Необязательный метод:
+    // если класс его не реализует, ключи вставляются по одному. Деревья
+    // сливают ключи со своими записями и перестраиваются за O(n + size),
+    // в пустое дерево ключи вставляются за O(n).
+    int (*insert_sorted)(void *, const mkey_t *, const mval_t *, size_t);
+
+    // Упорядоченный обход. Необязательные методы: классы, не хранящие
+    // ключи в порядке (хэш-таблицы), их не реализуют.
+    // iter_seek ставит курсор на первый ключ, не меньший данного.
+    // iter_next и iter_prev из конца переходят к первому и последнему ключу.
+    // Методы возвращают 1, если курсор стоит на записи, и 0, если в конце.
+    int (*iter_seek)(map_iter_t *, const string_t *, size_t);
+    int (*iter_next)(map_iter_t *);
+    int (*iter_prev)(map_iter_t *);
+
+    // Порядковые статистики. Необязательные методы: их реализуют деревья,
+    // хранящие размеры поддеревьев, вместе с упорядоченным обходом.
+    // rank возвращает количество ключей, меньших данного; ключ NULL больше
+    // любого ключа. iter_select ставит курсор на ключ с номером k по
+    // порядку, начиная с 0, или в конец, если ключей не больше k.
+    size_t (*rank)(const void *, const string_t *, size_t);
+    int (*iter_select)(map_iter_t *, size_t);
 } imap_t;
 
 
@@ -59,6 +119,16 @@ typedef struct {
  */
 void *map_new(const imap_t *class, ...);
 
+/**
+ * Создаёт объект указанного класса, как map_new, но параметры конструктора
+ * передаются списком ap. Позволяет классу-обёртке создать вложенную мапу
+ * из оставшихся параметров своего конструктора.
+ * @param  class класс, реализующий интерфейс imap_t.
+ * @param  ap    параметры конструктора класса.
+ * @return Проинициализированный объект класса или ошибку (err.h).
+ */
+void *map_vnew(const imap_t *class, va_list *ap);
+
 /**
  * Освобождает память, использованную для объекта.
  * Сначала вызывает деструктор класса, если таковой имеется, затем
@@ -106,4 +176,176 @@ map_res_t map_lookup(const void *self, mkey_t key);
  */
 int map_remove(void *self, mkey_t key);
 
+/**
+ * Резервирует место под n записей, чтобы вставка n ключей не приводила
+ * к росту (перестроению) таблицы. Место выделяется одним вызовом,
+ * уже хранящиеся записи переносятся сразу.
+ * Если класс не поддерживает резервирование, ничего не делает.
+ * @param  self объект класса, реализующего интерфейс imap_t.
+ * @param  n    ожидаемое количество записей.
+ * @return 0 или ENOMEM (err.h).
+ */
+int map_reserve(void *self, size_t n);
+
+/**
+ * Вставляет n ключей, строго упорядоченных по возрастанию (strcmp),
+ * как n вызовов map_insert, но классы деревьев сливают ключи со своими
+ * записями и перестраиваются в сбалансированное дерево за O(n + size)
+ * вместо O(n log size). При ENOMEM вставлена часть ключей с начала массива.
+ * @param  self   объект класса, реализующего интерфейс imap_t.
+ * @param  keys   массив ключей длины n.
+ * @param  values массив значений длины n, values[i] - значение keys[i].
+ * @param  n      количество ключей.
+ * @return 0, EINVAL (err.h), если ключи не упорядочены строго по
+ *         возрастанию (мапа не изменяется), или ENOMEM (err.h).
+ */
+int map_insert_sorted(void *self, const mkey_t *keys, const mval_t *values, size_t n);
+
+/**
+ * Создаёт объект указанного класса, как map_new, и вставляет в него
+ * ключи, как map_insert_sorted. Дерево из n ключей строится за O(n),
+ * сразу идеально сбалансированным.
+ * @param  class  класс, реализующий интерфейс imap_t.
+ * @param  keys   массив ключей длины n, строго упорядоченных по возрастанию.
+ * @param  values массив значений длины n.
+ * @param  n      количество ключей.
+ * @param  ...    параметры конструктора класса.
+ * @return Объект класса или ошибку EINVAL или ENOMEM (err.h).
+ */
+void *map_build_sorted(const imap_t *class, const mkey_t *keys, const mval_t *values,
+                       size_t n, ...);
+
+/**
+ * Сопоставляет ключу, заданному указателем и длиной, указанное значение.
+ * Ключ не обязан оканчиваться '\0', поэтому можно использовать подстроку
+ * буфера без копирования. Ключ не должен содержать символ '\0'.
+ * @param self  объект класса, реализующего интерфейс imap_t.
+ * @param key   указатель на начало ключа.
+ * @param len   длина ключа.
+ * @param value значение.
+ */
+void map_insert_n(void *self, const string_t *key, size_t len, mval_t value);
+
+/**
+ * Находит значение по ключу, заданному указателем и длиной.
+ * @param  self объект класса, реализующего интерфейс imap_t.
+ * @param  key  указатель на начало ключа.
+ * @param  len  длина ключа.
+ * @return См. map_lookup.
+ */
+map_res_t map_lookup_n(const void *self, const string_t *key, size_t len);
+
+/**
+ * Находит значения n ключей.
+ * Реализация класса может искать ключи группами: сначала вычислить хэши
+ * группы и запросить предвыборку (prefetch) их бакетов, затем сравнить ключи,
+ * чтобы промахи кэша независимых ключей перекрывались по времени.
+ * @param self    объект класса, реализующего интерфейс imap_t.
+ * @param keys    массив ключей длины n.
+ * @param n       количество ключей.
+ * @param results массив длины n, results[i] - результат поиска keys[i]
+ *                (см. map_lookup).
+ */
+void map_lookup_batch(const void *self, const mkey_t *keys, size_t n, map_res_t *results);
+
+/**
+ * Удаляет значение по ключу, заданному указателем и длиной, если существует.
+ * @param  self объект класса, реализующего интерфейс imap_t.
+ * @param  key  указатель на начало ключа.
+ * @param  len  длина ключа.
+ * @return 1 если значение по ключу было удалено;
+ *         0 если по ключу нет значения.
+ */
+int map_remove_n(void *self, const string_t *key, size_t len);
+
+/**
+ * Инициализирует курсор упорядоченного обхода и ставит его в конец.
+ * Конец замыкает ключи в кольцо, как голова списка в dlist.h: из конца
+ * map_iter_next переходит к первому ключу, map_iter_prev - к последнему.
+ *
+ * Пример использования:
+ *     map_iter_t it;
+ *     if (map_iter_init(map, &it) == 0)
+ *         for (int ok = map_iter_seek(&it, "b"); ok; ok = map_iter_next(&it))
+ *             printf("%s %d\n", it.key, it.value);
+ *
+ * Любое изменение мапы делает её курсоры недействительными.
+ * @param  self объект класса, реализующего интерфейс imap_t.
+ * @param  it   курсор.
+ * @return 0 или ENOTSUP (err.h), если класс не хранит ключи в порядке.
+ */
+int map_iter_init(const void *self, map_iter_t *it);
+
+/**
+ * Ставит курсор на первый ключ, не меньший данного, за O(log n).
+ * @param  it  курсор, инициализированный map_iter_init.
+ * @param  key ключ.
+ * @return 1, если курсор стоит на записи; 0, если такого ключа нет
+ *         и курсор в конце.
+ */
+int map_iter_seek(map_iter_t *it, mkey_t key);
+
+/**
+ * См. map_iter_seek. Ключ задан указателем и длиной.
+ */
+int map_iter_seek_n(map_iter_t *it, const string_t *key, size_t len);
+
+/**
+ * Переводит курсор к следующему ключу.
+ * @param  it курсор, инициализированный map_iter_init.
+ * @return 1, если курсор стоит на записи; 0, если курсор в конце.
+ */
+int map_iter_next(map_iter_t *it);
+
+/**
+ * Переводит курсор к предыдущему ключу.
+ * @param  it курсор, инициализированный map_iter_init.
+ * @return 1, если курсор стоит на записи; 0, если курсор в конце.
+ */
+int map_iter_prev(map_iter_t *it);
+
+/**
+ * Вызывает callback для записей с ключами из [lo, hi) в порядке
+ * возрастания ключей, за O(log n + k) для k записей диапазона.
+ * @param  self     объект класса, реализующего интерфейс imap_t.
+ * @param  lo       нижняя граница (включительно) или NULL - без границы.
+ * @param  hi       верхняя граница (не включительно) или NULL - без границы.
+ * @param  callback функция, вызываемая для каждой записи; обход
+ *                  прекращается, если она вернула не 0.
+ * @param  arg      аргумент callback.
+ * @return 0 или ENOTSUP (err.h), если класс не хранит ключи в порядке.
+ */
+int map_range(const void *self, mkey_t lo, mkey_t hi, map_range_cb_t callback, void *arg);
+
+/**
+ * Находит номер ключа по порядку (ранг) за O(log n): количество ключей
+ * мапы, меньших данного. Ключ может отсутствовать в мапе.
+ * @param  self объект класса, реализующего интерфейс imap_t.
+ * @param  key  ключ.
+ * @param  rank количество ключей, меньших key.
+ * @return 0 или ENOTSUP (err.h), если класс не хранит размеры поддеревьев.
+ */
+int map_rank(const void *self, mkey_t key, size_t *rank);
+
+/**
+ * Инициализирует курсор (см. map_iter_init) и ставит его на ключ с номером
+ * k по порядку, начиная с 0, за O(log n). Если ключей не больше k, курсор
+ * в конце (it->key == NULL). Например, медиана - ключ с номером n / 2.
+ * @param  self объект класса, реализующего интерфейс imap_t.
+ * @param  k    номер ключа.
+ * @param  it   курсор.
+ * @return 0 или ENOTSUP (err.h), если класс не хранит размеры поддеревьев.
+ */
+int map_select(const void *self, size_t k, map_iter_t *it);
+
+/**
+ * Считает записи с ключами из [lo, hi) за O(log n).
+ * @param  self  объект класса, реализующего интерфейс imap_t.
+ * @param  lo    нижняя граница (включительно) или NULL - без границы.
+ * @param  hi    верхняя граница (не включительно) или NULL - без границы.
+ * @param  count количество записей диапазона.
+ * @return 0 или ENOTSUP (err.h), если класс не хранит размеры поддеревьев.
+ */
+int map_count_range(const void *self, mkey_t lo, mkey_t hi, size_t *count);
+
 #endif // MAP_H
@@ -0,0 +1,68 @@
+/**
+ * pavltree.h - персистентное AVL дерево для чтения без блокировок.
+ *
+ * Опубликованные узлы не изменяются. Запись копирует узлы пути от корня
+ * до изменяемого узла (и узлы, затронутые поворотами), то есть O(log n)
+ * узлов, и публикует новую версию дерева одной атомарной записью корня.
+ * Остальные узлы новая версия разделяет с предыдущей.
+ *
+ * Читатели не берут блокировок: поиск закрепляет текущую версию счётчиком
+ * читателей своего потока и проходит по ней, сколько бы записей ни
+ * произошло за это время. Счётчики потоков занимают отдельные кэш-линии,
+ * поэтому читатели разных ядер не делят изменяемую память. Версии,
+ * вытесненные записями, освобождаются по порядку, когда их и более старые
+ * версии не читает ни один читатель. Долгий снимок задерживает
+ * освобождение всех более новых версий.
+ *
+ * Запись в дерево допускается только из одного потока (или под внешней
+ * блокировкой писателей), поиск - из любого количества потоков
+ * одновременно с записью. Упорядоченный обход не поддерживается.
+ */
+#ifndef PAVLTREE_H
+#define PAVLTREE_H
+
+#include "map.h"
+
+extern const imap_t PersistentAVLTreeClass;
+// map_new(PersistentAVLTree)
+static const imap_t *PersistentAVLTree = &PersistentAVLTreeClass;
+
+// Статистика дерева.
+typedef struct {
+    size_t versions;  // Вытесненные, ещё не освобождённые версии.
+    size_t retired;   // Узлы этих версий, ожидающие освобождения.
+} pavltree_stats_t;
+
+/**
+ * Закрепляет текущую версию дерева (снимок). Снимок не меняется при
+ * последующих записях, пока не будет освобождён pavltree_snapshot_release.
+ * Можно вызывать из любого потока одновременно с записью, освобождать
+ * снимок можно в другом потоке.
+ * @param  self объект класса PersistentAVLTree.
+ * @return Снимок.
+ */
+const void *pavltree_snapshot(const void *self);
+
+/**
+ * Находит значение по ключу в снимке.
+ * @param  snapshot снимок, полученный pavltree_snapshot.
+ * @param  key      указатель на начало ключа.
+ * @param  len      длина ключа.
+ * @return См. map_lookup.
+ */
+map_res_t pavltree_snapshot_lookup(const void *snapshot, const string_t *key, size_t len);
+
+/**
+ * Освобождает снимок. Узлы версии освобождаются одной из следующих записей.
+ * @param snapshot снимок, полученный pavltree_snapshot.
+ */
+void pavltree_snapshot_release(const void *snapshot);
+
+/**
+ * Возвращает статистику дерева. Вызывается писателем.
+ * @param  self объект класса PersistentAVLTree.
+ * @return Статистика дерева.
+ */
+pavltree_stats_t pavltree_stats(const void *self);
+
+#endif // PAVLTREE_H
@@ -0,0 +1,65 @@
+/**
+ * pool.h - пул (slab) объектов одного размера.
+ *
+ * Объекты нарезаются из крупных участков памяти (слэбов) без округления
+ * до классов размеров, освобождённый объект попадает в список свободных
+ * объектов и переиспользуется следующим выделением.
+ *
+ * В отличие от арены (arena.h), пул предназначен для узлов структур данных:
+ * все объекты имеют одинаковый размер, заданный при инициализации.
+ * Уничтожение пула освобождает все объекты разом.
+ */
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+
+// Размер слэба по умолчанию.
+#define POOL_SLAB_SIZE (64 * 1024)
+
+struct pool_slab;
+
+typedef struct {
+    // Размер объекта, не меньше размера указателя и кратный ему.
+    size_t size;
+
+    // Список слэбов, первый - текущий, из которого нарезаются объекты.
+    struct pool_slab *slabs;
+
+    // Граница нарезанной части текущего слэба и конец слэба.
+    char *next;
+    char *end;
+
+    // Список освобождённых объектов.
+    void *free_list;
+} pool_t;
+
+/**
+ * Инициализирует пустой пул объектов размера size. Память не выделяется.
+ * @param self пул.
+ * @param size размер объекта, > 0.
+ */
+void pool_init(pool_t *self, size_t size);
+
+/**
+ * Освобождает всю память пула, включая все выделенные из него объекты.
+ * После вызова пул пуст и может использоваться повторно.
+ * @param self пул.
+ */
+void pool_destroy(pool_t *self);
+
+/**
+ * Выделяет объект, выровненный по размеру указателя.
+ * @param  self пул.
+ * @return Указатель на объект или NULL, если не удалось выделить память.
+ */
+void *pool_alloc(pool_t *self);
+
+/**
+ * Возвращает объект в пул для переиспользования.
+ * @param self пул.
+ * @param p    объект, выделенный pool_alloc этого пула, или NULL.
+ */
+void pool_free(pool_t *self, void *p);
+
+#endif // POOL_H
@@ -0,0 +1,61 @@
+/**
+ * radix.h - адаптивное префиксное дерево (Adaptive Radix Tree, ART).
+ *
+ * Ключ разбирается побайтово: внутренний узел выбирает ребёнка по очередному
+ * байту ключа, поэтому поиск сравнивает не больше длины ключа байтов и не
+ * сравнивает ключ целиком ни с одним ключом, кроме найденного.
+ *
+ * Узел хранит столько мест для детей, сколько нужно: 4, 16, 48 или 256.
+ * Узел из 16 детей ищет байт одним SSE2 сравнением (без SSE2 - поэлементно).
+ *
+ * Сжатие путей: общий префикс ключей поддерева хранится в узле, а не
+ * цепочкой узлов с одним ребёнком. Первые 8 байтов префикса хранятся
+ * в узле, остальные при поиске пропускаются и проверяются сравнением
+ * с ключом найденного листа.
+ *
+ * Ленивое расширение: ключ, единственный в поддереве, хранится листом
+ * прямо на месте поддерева. Узлы появляются только там, где ключи
+ * расходятся, поэтому ключи с длинными общими префиксами (пути, URL)
+ * занимают меньше памяти, чем в деревьях сравнений.
+ */
+#ifndef RADIX_H
+#define RADIX_H
+
+#include "map.h"
+
+extern const imap_t RadixTreeClass;
+// map_new(RadixTree)
+static const imap_t *RadixTree = &RadixTreeClass;
+
+// Статистика дерева.
+typedef struct {
+    size_t count;       // Количество записей.
+    size_t node4;       // Количество узлов каждого вида.
+    size_t node16;
+    size_t node48;
+    size_t node256;
+    size_t node_bytes;  // Память внутренних узлов, без листов.
+} radix_stats_t;
+
+/**
+ * Вызывает callback для всех записей, ключи которых начинаются с prefix,
+ * в порядке возрастания ключей.
+ * @param  self     объект класса RadixTree.
+ * @param  prefix   префикс, пустая строка - все записи.
+ * @param  len      длина префикса.
+ * @param  callback функция, вызываемая для каждой записи; обход
+ *                  прекращается, если она вернула не 0.
+ * @param  arg      аргумент callback.
+ * @return 0 или ENOMEM (err.h).
+ */
+int radix_prefix_scan(const void *self, const string_t *prefix, size_t len,
+                      map_range_cb_t callback, void *arg);
+
+/**
+ * Возвращает статистику дерева за O(1).
+ * @param  self объект класса RadixTree.
+ * @return Статистика дерева.
+ */
+radix_stats_t radix_stats(const void *self);
+
+#endif // RADIX_H
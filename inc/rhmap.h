@@ -0,0 +1,39 @@
+/**
+ * rhmap.h - хэш-таблица с открытой адресацией по методу Робин Гуда
+ * (Robin Hood hashing).
+ *
+ * Записи (хэш, указатель на ключ, значение) хранятся в едином массиве
+ * без цепочек и отдельно аллоцированных бакетов. При вставке запись,
+ * ушедшая дальше от своей начальной ячейки, вытесняет запись, стоящую
+ * ближе к своей, поэтому длины проб выравниваются и имеют малую дисперсию.
+ * Удаление выполняется обратным сдвигом (backward-shift deletion)
+ * без меток удалённых ячеек.
+ */
+#ifndef RHMAP_H
+#define RHMAP_H
+
+#include "map.h"
+
+extern const imap_t RobinHoodMapClass;
+// map_new(RobinHoodMap, hash_function)
+static const imap_t *RobinHoodMap = &RobinHoodMapClass;
+
+// Статистика длин проб таблицы.
+// Длина пробы записи - расстояние от начальной ячейки ключа до ячейки,
+// в которой запись хранится (0, если запись лежит в начальной ячейке).
+typedef struct {
+    size_t count;       // Количество записей.
+    size_t cap;         // Количество ячеек.
+    size_t max_probe;   // Максимальная длина пробы.
+    double mean_probe;  // Средняя длина пробы.
+    double var_probe;   // Дисперсия длины пробы.
+} rhmap_stats_t;
+
+/**
+ * Собирает статистику длин проб за O(cap).
+ * @param  self объект класса RobinHoodMap.
+ * @return Статистика длин проб.
+ */
+rhmap_stats_t rhmap_stats(const void *self);
+
+#endif // RHMAP_H
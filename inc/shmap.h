@@ -4,7 +4,9 @@
  *
  * Используется:
  * - метод деления для вычисления позиции элемента.
- * - метод цепочек (открытая адресация) для решения коллизий.
+ * - метод цепочек (открытая адресация) для решения коллизий;
+ * - рост таблицы при средней длине цепочки больше 1;
+ * - пул (pool.h) для узлов цепочек вместо malloc на каждый узел.
  */
 #ifndef SHMAP_H
 #define SHMAP_H
@@ -16,4 +18,25 @@ extern const imap_t SimpleHashMapClass;
 // map_new(SimpleHashMap, capacity, hash_function)
 static const imap_t *SimpleHashMap = &SimpleHashMapClass;
 
+// Количество столбцов гистограммы длин цепочек.
+#define SHMAP_STATS_HIST 9
+
+// Статистика длин цепочек.
+typedef struct {
+    size_t count;       // Количество записей.
+    size_t chains;      // Количество цепочек (ёмкость таблицы).
+    size_t max_chain;   // Максимальная длина цепочки.
+
+    // hist[i] - количество цепочек длины i, последний столбец -
+    // цепочки длины SHMAP_STATS_HIST - 1 и более.
+    size_t hist[SHMAP_STATS_HIST];
+} shmap_stats_t;
+
+/**
+ * Собирает статистику длин цепочек за O(n).
+ * @param  self объект класса SimpleHashMap.
+ * @return Статистика длин цепочек.
+ */
+shmap_stats_t shmap_stats(const void *self);
+
 #endif // SHMAP_H
@@ -1,6 +1,7 @@
 #ifndef STR_H
 #define STR_H
 
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h> // to not remove
 
@@ -9,6 +10,60 @@ typedef char string_t;
 #define STR_EQ(x, y) (strcmp((x), (y)) == 0)
 #define STR_EMPTY(x) (*(x) == '\0')
 
+// Равенство строк, заданных указателем и длиной: сравниваются длины, затем байты.
+#define STRN_EQ(x, xlen, y, ylen) ((xlen) == (ylen) && memcmp((x), (y), (xlen)) == 0)
+
+// Сравнивает строку s, оканчивающуюся '\0', со строкой key длины len,
+// не содержащей '\0', в том же порядке, что и strcmp. Позволяет не хранить
+// длину рядом со строкой.
+static inline int strz_cmp(const char *s, const char *key, const size_t len) {
+    const int cmp = strncmp(s, key, len);
+    if (cmp != 0)
+        return cmp;
+    return s[len] != '\0';
+}
+
+// Равенство строки, оканчивающейся '\0', и строки, заданной указателем и длиной.
+#define STRZ_EQ(s, key, len) (strz_cmp((s), (key), (len)) == 0)
+
+// Количество байтов строки в префиксе str_prefix.
+#define STR_PREFIX_LEN 8
+
+// Первые 8 байтов строки key длины len в порядке big-endian, дополненные
+// нулями. Сравнение префиксов как чисел совпадает со сравнением первых
+// 8 байтов строк функцией strcmp. Префикс хранят рядом с указателем
+// на строку, чтобы сравнивать строки без обращения к их байтам.
+static inline uint64_t str_prefix(const char *key, const size_t len) {
+    uint64_t prefix = 0;
+    if (len >= STR_PREFIX_LEN) {
+        memcpy(&prefix, key, STR_PREFIX_LEN);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        prefix = __builtin_bswap64(prefix);
+#endif
+        return prefix;
+    }
+
+    for (size_t i = 0; i < len; i++)
+        prefix |= (uint64_t) (unsigned char) key[i] << (56 - 8 * i);
+    return prefix;
+}
+
+// Сравнивает строку key длины len и префиксом prefix (str_prefix) со
+// строкой s, оканчивающейся '\0', и префиксом sprefix в том же порядке,
+// что и strcmp. К байтам s функция обращается, только если префиксы
+// совпадают, а key не короче префикса.
+static inline int strzp_cmp(const uint64_t prefix, const char *key, const size_t len,
+                            const uint64_t sprefix, const char *s) {
+    if (prefix != sprefix)
+        return prefix < sprefix ? -1 : 1;
+
+    // Строки не содержат '\0', поэтому при совпадении префиксов строка
+    // короче префикса совпадает с s целиком.
+    if (len < STR_PREFIX_LEN)
+        return 0;
+    return -strz_cmp(s + STR_PREFIX_LEN, key + STR_PREFIX_LEN, len - STR_PREFIX_LEN);
+}
+
 /**
  * Safe fgets function that can check buffer overflow.
  * @attention Writes into the buffer read line without a newline.
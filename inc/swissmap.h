@@ -0,0 +1,20 @@
+/**
+ * swissmap.h - хэш-таблица с открытой адресацией и групповым поиском
+ * по управляющим байтам (SwissTable).
+ *
+ * Каждой ячейке таблицы соответствует управляющий байт: признак пустой
+ * или удалённой ячейки либо 7 бит хэша занятой ячейки. Ячейки объединены
+ * в группы по 16 штук, и вся группа сравнивается с искомым тегом одной
+ * SSE2 инструкцией сравнения и movemask (без SSE2 - поэлементно).
+ * Строки сравниваются только для ячеек с совпавшим тегом.
+ */
+#ifndef SWISSMAP_H
+#define SWISSMAP_H
+
+#include "map.h"
+
+extern const imap_t SwissMapClass;
+// map_new(SwissMap, hash_function)
+static const imap_t *SwissMap = &SwissMapClass;
+
+#endif // SWISSMAP_H
@@ -0,0 +1,184 @@
+#include "arena.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+struct arena_chunk {
+    struct arena_chunk *next;
+
+    // Количество занятых байтов data.
+    size_t used;
+
+    // Размер data.
+    size_t cap;
+
+    _Alignas(ARENA_ALIGN) char data[];
+};
+
+// Заголовок большого блока. Блок следует сразу за заголовком.
+struct arena_large {
+    struct arena_large *prev;
+    struct arena_large *next;
+    _Alignas(ARENA_ALIGN) char data[];
+};
+
+// Свободный блок хранит указатель на следующий свободный блок того же класса.
+typedef struct arena_free_block {
+    struct arena_free_block *next;
+} arena_free_block_t;
+
+// Номер класса размеров блока.
+static inline size_t arena_class(const size_t size) {
+    return (size + ARENA_ALIGN - 1) / ARENA_ALIGN - 1;
+}
+
+void arena_init(arena_t *self) {
+    self->chunks = NULL;
+    memset(self->free_lists, 0, sizeof(self->free_lists));
+    self->large = NULL;
+}
+
+void arena_destroy(arena_t *self) {
+    struct arena_chunk *chunk = self->chunks;
+    while (chunk) {
+        struct arena_chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    struct arena_large *large = self->large;
+    while (large) {
+        struct arena_large *next = large->next;
+        free(large);
+        large = next;
+    }
+
+    arena_init(self);
+}
+
+void arena_merge(arena_t *self, arena_t *other) {
+    // Текущим чанком self остаётся его первый чанк, чанки other
+    // добавляются в конец списка.
+    struct arena_chunk **chunk = &self->chunks;
+    while (*chunk)
+        chunk = &(*chunk)->next;
+    *chunk = other->chunks;
+
+    for (size_t class = 0; class < ARENA_CLASSES; class++) {
+        arena_free_block_t **block = (arena_free_block_t **) &self->free_lists[class];
+        while (*block)
+            block = &(*block)->next;
+        *block = other->free_lists[class];
+    }
+
+    struct arena_large *large = other->large;
+    while (large) {
+        struct arena_large *next = large->next;
+        large->prev = NULL;
+        large->next = self->large;
+        if (self->large)
+            self->large->prev = large;
+        self->large = large;
+        large = next;
+    }
+
+    arena_init(other);
+}
+
+static void *arena_alloc_large(arena_t *self, const size_t size) {
+    struct arena_large *large = malloc(sizeof(struct arena_large) + size);
+    if (large == NULL)
+        return NULL;
+
+    large->prev = NULL;
+    large->next = self->large;
+    if (self->large)
+        self->large->prev = large;
+    self->large = large;
+
+    return large->data;
+}
+
+static void arena_free_large(arena_t *self, void *p) {
+    struct arena_large *large = (struct arena_large *) ((char *) p - offsetof(struct arena_large, data));
+
+    if (large->prev)
+        large->prev->next = large->next;
+    else
+        self->large = large->next;
+    if (large->next)
+        large->next->prev = large->prev;
+
+    free(large);
+}
+
+void *arena_alloc(arena_t *self, const size_t size) {
+    assert(size > 0);
+
+    if (size > ARENA_MAX_SMALL)
+        return arena_alloc_large(self, size);
+
+    const size_t class = arena_class(size);
+
+    // Сначала переиспользуем освобождённый блок того же класса.
+    arena_free_block_t *block = self->free_lists[class];
+    if (block) {
+        self->free_lists[class] = block->next;
+        return block;
+    }
+
+    const size_t rounded = (class + 1) * ARENA_ALIGN;
+    struct arena_chunk *chunk = self->chunks;
+    if (chunk == NULL || chunk->cap - chunk->used < rounded) {
+        // Остаток текущего чанка не используется: он меньше ARENA_MAX_SMALL.
+        chunk = malloc(sizeof(struct arena_chunk) + ARENA_CHUNK_SIZE);
+        if (chunk == NULL)
+            return NULL;
+        chunk->used = 0;
+        chunk->cap = ARENA_CHUNK_SIZE;
+        chunk->next = self->chunks;
+        self->chunks = chunk;
+    }
+
+    void *p = chunk->data + chunk->used;
+    chunk->used += rounded;
+
+    return p;
+}
+
+void arena_free(arena_t *self, void *p, const size_t size) {
+    if (p == NULL)
+        return;
+
+    if (size > ARENA_MAX_SMALL) {
+        arena_free_large(self, p);
+        return;
+    }
+
+    const size_t class = arena_class(size);
+    arena_free_block_t *block = p;
+    block->next = self->free_lists[class];
+    self->free_lists[class] = block;
+}
+
+char *arena_strdup(arena_t *self, const char *str) {
+    return arena_strndup(self, str, strlen(str));
+}
+
+char *arena_strndup(arena_t *self, const char *str, const size_t len) {
+    char *dup = arena_alloc(self, len + 1);
+    if (dup == NULL)
+        return NULL;
+
+    memcpy(dup, str, len);
+    dup[len] = '\0';
+    return dup;
+}
+
+void arena_free_str(arena_t *self, char *str) {
+    if (str == NULL)
+        return;
+    arena_free(self, str, strlen(str) + 1);
+}
@@ -1,104 +1,193 @@
 #include "avltree.h"
 
 #include <assert.h>
+#include <stdint.h>
 #include <stdlib.h>
 
+#include "arena.h"
 #include "err.h"
 
+// Наибольшая высота пути от корня. Высота AVL дерева из n узлов меньше
+// 1.4405 * log2(n + 2), что для любого n в size_t меньше 96.
+#define AVLTREE_MAX_HEIGHT 96
+
+// Узлы хранятся в одном массиве и ссылаются друг на друга 32-битными
+// индексами. Элемент 0 не используется и играет роль пустой ветви:
+// его высота 0, поэтому высоту ребёнка можно читать без проверки.
+#define AVLTREE_NIL 0
+
+// Начальная ёмкость массива узлов.
+#define AVLTREE_MIN_NODES 16
+
+// Наибольшая ёмкость массива узлов, включая элемент AVLTREE_NIL.
+#define AVLTREE_MAX_NODES ((size_t) UINT32_MAX)
+
+// Упорядоченные ключи вставляются слиянием с перестроением дерева, если
+// их не меньше 1/AVLTREE_MERGE_RATIO от количества записей. Слияние
+// читает каждый узел один раз, а вставка по одному - порядка log2(count)
+// узлов на ключ, поэтому для малых пакетов слияние невыгодно.
+#define AVLTREE_MERGE_RATIO 16
+
+typedef uint32_t avltree_idx_t;
+
+// Рядом с указателем на ключ хранится префикс ключа (str_prefix), поэтому
+// сравнение на очередном уровне обычно не обращается к байтам ключа.
+// Размер поддерева (количество его узлов) позволяет найти ранг ключа
+// и ключ по рангу за один спуск. Узел занимает 40 байтов без заголовка
+// malloc. У свободного узла left - следующий узел списка свободных узлов.
 typedef struct {
-    mut_mkey_t key;
-    mval_t     value;
-} pair_t;
-
-struct avltree_node;
-typedef struct avltree_node avltree_node_t;
-
-struct avltree_node {
-    pair_t          data;
-    avltree_node_t *left;
-    avltree_node_t *right;
-    int             height;
-};
+    uint64_t      prefix;
+    mut_mkey_t    key;
+    avltree_idx_t left;
+    avltree_idx_t right;
+    mval_t        value;
+    int           height;
+    uint32_t      size;
+} avltree_node_t;
 
 typedef struct {
     const imap_t   *class;
-    avltree_node_t *root;
+    avltree_idx_t   root;
+
+    // Массив узлов ёмкостью cap, элементы с индексами от len ещё
+    // не выделялись.
+    avltree_node_t *nodes;
+    size_t          len;
+    size_t          cap;
+
+    // Список освобождённых узлов.
+    avltree_idx_t   free_list;
+
+    // Арена для ключей узлов.
+    arena_t         arena;
 } avltree_t;
 
 _Static_assert(offsetof(avltree_t, class) == 0);
 
 void *avltree_ctor(void *_class, va_list *ap) {
     avltree_t *bst = _class;
-    bst->root = NULL;
+    bst->root = AVLTREE_NIL;
+    bst->nodes = NULL;
+    bst->len = AVLTREE_NIL + 1;
+    bst->cap = 0;
+    bst->free_list = AVLTREE_NIL;
+    arena_init(&bst->arena);
     return bst;
 }
 
-void avltree_node_destroy(avltree_node_t *node) {
-    if (node != NULL) {
-        avltree_node_destroy(node->left);
-        avltree_node_destroy(node->right);
-        free(node->data.key);
-        free(node);
-    }
-}
-
 void avltree_destroy(void *_self) {
     avltree_t *self = _self;
-    avltree_node_destroy(self->root);
-    self->root = NULL;
+    // Узлы и ключи всех узлов освобождаются разом.
+    free(self->nodes);
+    self->nodes = NULL;
+    self->root = AVLTREE_NIL;
+    arena_destroy(&self->arena);
 }
 
-avltree_node_t *avltree_node_create(const mkey_t key, const mval_t value) {
-    avltree_node_t *node = malloc(sizeof(avltree_node_t));
-    if (node == NULL)
-        return ERR_PTR(-ENOMEM);
+// Перевыделяет массив узлов ёмкостью cap. Возвращает 0 или ENOMEM (err.h).
+static int avltree_resize(avltree_t *self, const size_t cap) {
+    if (cap > AVLTREE_MAX_NODES || cap > SIZE_MAX / sizeof(avltree_node_t))
+        return ENOMEM;
 
-    node->left = NULL;
-    node->right = NULL;
-    node->data = (pair_t){ strdup(key), value };
-    node->height = 1;
+    avltree_node_t *nodes = realloc(self->nodes, cap * sizeof(avltree_node_t));
+    if (nodes == NULL)
+        return ENOMEM;
 
-    return node;
+    if (self->nodes == NULL)
+        nodes[AVLTREE_NIL] = (avltree_node_t){0};
+    self->nodes = nodes;
+    self->cap = cap;
+    return 0;
 }
 
-static inline int avltree_node_height(const avltree_node_t *node) {
-    if (node == NULL)
+int avltree_reserve(void *_self, const size_t n) {
+    avltree_t *self = _self;
+
+    // Каждый выделенный узел, кроме свободных, хранит запись, поэтому
+    // при n + 1 элементах вставка до n записей не расширяет массив.
+    if (n >= AVLTREE_MAX_NODES)
+        return ENOMEM;
+    if (n + 1 <= self->cap)
         return 0;
-    return node->height;
+    return avltree_resize(self, n + 1);
 }
 
-static inline int avltree_node_balance(const avltree_node_t *node) {
-    if (node == NULL)
+// Обеспечивает место под ещё один узел. Массив перевыделяется до спуска
+// по дереву: адреса ветвей, записанные при спуске, остаются верными.
+static int avltree_reserve_node(avltree_t *self) {
+    if (self->free_list != AVLTREE_NIL || self->len < self->cap)
         return 0;
-    return avltree_node_height(node->left) - avltree_node_height(node->right);
+    if (self->cap == 0)
+        return avltree_resize(self, AVLTREE_MIN_NODES);
+    if (self->cap >= AVLTREE_MAX_NODES)
+        return ENOMEM;
+    return avltree_resize(self, self->cap < AVLTREE_MAX_NODES / 2
+                                    ? self->cap * 2 : AVLTREE_MAX_NODES);
+}
+
+// Выделяет узел из списка свободных или следующий невыделенный узел.
+// Место под узел должно быть обеспечено avltree_reserve_node.
+static avltree_idx_t avltree_node_alloc(avltree_t *self) {
+    const avltree_idx_t i = self->free_list;
+    if (i != AVLTREE_NIL) {
+        self->free_list = self->nodes[i].left;
+        return i;
+    }
+
+    assert(self->len < self->cap);
+    return (avltree_idx_t) self->len++;
+}
+
+static void avltree_node_free(avltree_t *self, const avltree_idx_t i) {
+    self->nodes[i].left = self->free_list;
+    self->free_list = i;
 }
 
 static inline int max(const int x, const int y) {
     return x > y ? x : y;
 }
 
-static avltree_node_t *avltree_right_rotate(avltree_node_t *y) {
-    avltree_node_t *x = y->left;
-    avltree_node_t *t2 = x->right;
-    x->right = y;
-    y->left = t2;
-    y->height = 1 + max(avltree_node_height(y->left), avltree_node_height(y->right));
-    x->height = 1 + max(avltree_node_height(x->left), avltree_node_height(x->right));
+// Количество записей - размер корня.
+static inline size_t avltree_count(const avltree_t *self) {
+    return self->root != AVLTREE_NIL ? self->nodes[self->root].size : 0;
+}
+
+static inline void avltree_node_update_size(avltree_node_t *nodes, const avltree_idx_t i) {
+    avltree_node_t *node = &nodes[i];
+    node->size = 1 + nodes[node->left].size + nodes[node->right].size;
+}
+
+static inline void avltree_node_update(avltree_node_t *nodes, const avltree_idx_t i) {
+    avltree_node_t *node = &nodes[i];
+    node->height = 1 + max(nodes[node->left].height, nodes[node->right].height);
+    avltree_node_update_size(nodes, i);
+}
+
+static inline int avltree_node_balance(const avltree_node_t *nodes, const avltree_idx_t i) {
+    return nodes[nodes[i].left].height - nodes[nodes[i].right].height;
+}
+
+static avltree_idx_t avltree_right_rotate(avltree_node_t *nodes, const avltree_idx_t y) {
+    const avltree_idx_t x = nodes[y].left;
+    nodes[y].left = nodes[x].right;
+    nodes[x].right = y;
+    avltree_node_update(nodes, y);
+    avltree_node_update(nodes, x);
     return x;
 }
 
-static avltree_node_t *avltree_left_rotate(avltree_node_t *x) {
-    avltree_node_t *y = x->right;
-    avltree_node_t *t2 = y->left;
-    y->left = x;
-    x->right = t2;
-    x->height = 1 + max(avltree_node_height(x->left), avltree_node_height(x->right));
-    y->height = 1 + max(avltree_node_height(y->left), avltree_node_height(y->right));
+static avltree_idx_t avltree_left_rotate(avltree_node_t *nodes, const avltree_idx_t x) {
+    const avltree_idx_t y = nodes[x].right;
+    nodes[x].right = nodes[y].left;
+    nodes[y].left = x;
+    avltree_node_update(nodes, x);
+    avltree_node_update(nodes, y);
     return y;
 }
 
-static avltree_node_t *avltree_balance(avltree_node_t *node) {
-    const int balance = avltree_node_balance(node);
+static avltree_idx_t avltree_balance(avltree_node_t *nodes, const avltree_idx_t i) {
+    avltree_node_t *node = &nodes[i];
+    const int balance = avltree_node_balance(nodes, i);
 
     // Случай LL.
     //       3          2
@@ -106,8 +195,8 @@ static avltree_node_t *avltree_balance(avltree_node_t *node) {
     //     2     ->   1   3
     //    /
     //   1
-    if (balance > 1 && avltree_node_balance(node->left) >= 0)
-        return avltree_right_rotate(node);
+    if (balance > 1 && avltree_node_balance(nodes, node->left) >= 0)
+        return avltree_right_rotate(nodes, i);
 
     // Случай LR.
     //    4          4        3
@@ -115,9 +204,9 @@ static avltree_node_t *avltree_balance(avltree_node_t *node) {
     //  2     ->   3    ->  2   4
     //   \        /
     //    3      2
-    if (balance > 1 && avltree_node_balance(node->left) < 0) {
-        node->left = avltree_left_rotate(node->left);
-        return avltree_right_rotate(node);
+    if (balance > 1 && avltree_node_balance(nodes, node->left) < 0) {
+        node->left = avltree_left_rotate(nodes, node->left);
+        return avltree_right_rotate(nodes, i);
     }
 
     // Случай RR.
@@ -126,8 +215,8 @@ static avltree_node_t *avltree_balance(avltree_node_t *node) {
     //     2    ->  1   3
     //      \
     //       3
-    if (balance < -1 && avltree_node_balance(node->right) <= 0)
-        return avltree_left_rotate(node);
+    if (balance < -1 && avltree_node_balance(nodes, node->right) <= 0)
+        return avltree_left_rotate(nodes, i);
 
     // Случай RL.
     //  2        2            3
@@ -135,164 +224,444 @@ static avltree_node_t *avltree_balance(avltree_node_t *node) {
     //    4   ->   3    ->  2   4
     //   /          \
     //  3            4
-    if (balance < -1 && avltree_node_balance(node->right) > 0) {
-        node->right = avltree_right_rotate(node->right);
-        return avltree_left_rotate(node);
+    if (balance < -1 && avltree_node_balance(nodes, node->right) > 0) {
+        node->right = avltree_right_rotate(nodes, node->right);
+        return avltree_left_rotate(nodes, i);
     }
 
-    return node;
+    return i;
 }
 
-static avltree_node_t *avltree_node_insert(avltree_node_t *node, const mkey_t key, const mval_t value) {
-    assert(key);
+// Путь от корня до узла: адреса индексов узлов пути (корня или ветви
+// родителя). Через адрес узел пути заменяется после поворота. Адреса
+// верны, пока массив узлов не перевыделяется.
+typedef struct {
+    avltree_idx_t *links[AVLTREE_MAX_HEIGHT];
+    int            len;
+} avltree_path_t;
+
+static inline void avltree_path_push(avltree_path_t *path, avltree_idx_t *link) {
+    assert(path->len < AVLTREE_MAX_HEIGHT);
+    path->links[path->len++] = link;
+}
 
-    // Если корня нет, то новый узел становится корнем.
-    if (node == NULL) {
-        avltree_node_t *new_root = avltree_node_create(key, value);
-        if (IS_ERR(new_root))
-            return ERR_CAST(new_root);
-        return new_root;
+// Восстанавливает высоты, размеры и баланс узлов пути снизу вверх.
+// Балансировка останавливается, как только высота поддерева перестаёт
+// меняться: выше по пути высоты и баланс от изменения не зависят,
+// а размеры поддеревьев обновляются до корня.
+static void avltree_path_rebalance(avltree_node_t *nodes, avltree_path_t *path) {
+    while (path->len > 0) {
+        avltree_idx_t *link = path->links[--path->len];
+
+        const int height = nodes[*link].height;
+        avltree_node_update(nodes, *link);
+        *link = avltree_balance(nodes, *link);
+
+        if (nodes[*link].height == height)
+            break;
     }
 
-    const int cmp = strcmp(key, node->data.key);
-    if (cmp < 0)
-        node->left = avltree_node_insert(node->left, key, value);
-    else if (cmp > 0)
-        node->right = avltree_node_insert(node->right, key, value);
-    else
-        node->data.value = value; // обновляем существующее значение
+    while (path->len > 0)
+        avltree_node_update_size(nodes, *path->links[--path->len]);
+}
+
+// Спускается от корня к ключу, записывая в path адреса индексов
+// пройденных узлов. Возвращает адрес индекса узла с ключом или пустой
+// ветви, где узел с ключом должен находиться.
+static avltree_idx_t *avltree_descend(avltree_t *self, avltree_path_t *path,
+                                      const char *key, const size_t len) {
+    assert(key);
 
-    node->height = 1 + max(avltree_node_height(node->left), avltree_node_height(node->right));
-    return avltree_balance(node);
+    avltree_node_t *nodes = self->nodes;
+    const uint64_t prefix = str_prefix(key, len);
+    avltree_idx_t *link = &self->root;
+    while (*link != AVLTREE_NIL) {
+        avltree_node_t *node = &nodes[*link];
+        const int cmp = strzp_cmp(prefix, key, len, node->prefix, node->key);
+        if (cmp == 0)
+            break;
+        avltree_path_push(path, link);
+        link = cmp < 0 ? &node->left : &node->right;
+    }
+    return link;
 }
 
-void avltree_insert(void *_self, const mkey_t key, const mval_t value) {
+void avltree_insert_n(void *_self, const char *key, const size_t len, const mval_t value) {
     avltree_t *self = _self;
-    self->root = avltree_node_insert(self->root, key, value);
+
+    // Если места под узел нет, дерево остаётся прежним.
+    if (avltree_reserve_node(self) != 0)
+        return;
+
+    avltree_path_t path = { .len = 0 };
+    avltree_idx_t *link = avltree_descend(self, &path, key, len);
+    if (*link != AVLTREE_NIL) {
+        self->nodes[*link].value = value; // обновляем существующее значение
+        return;
+    }
+
+    mut_mkey_t dup = arena_strndup(&self->arena, key, len);
+    if (dup == NULL)
+        return;
+
+    const avltree_idx_t i = avltree_node_alloc(self);
+    self->nodes[i] = (avltree_node_t){
+        .prefix = str_prefix(dup, len),
+        .key    = dup,
+        .left   = AVLTREE_NIL,
+        .right  = AVLTREE_NIL,
+        .value  = value,
+        .height = 1,
+        .size   = 1,
+    };
+
+    *link = i;
+    avltree_path_rebalance(self->nodes, &path);
 }
 
-static avltree_node_t *avltree_node_lookup(avltree_node_t *self, const char *key) {
+map_res_t avltree_lookup_n(const void *_self, const char *key, const size_t len) {
+    const avltree_t *self = _self;
     assert(key);
 
-    if (self == NULL)
-        return NULL;
-
-    const int cmp = strcmp(key, self->data.key);
-    if (cmp < 0)
-        return avltree_node_lookup(self->left, key);
-    if (cmp > 0)
-        return avltree_node_lookup(self->right, key);
+    const avltree_node_t *nodes = self->nodes;
+    const uint64_t prefix = str_prefix(key, len);
+    avltree_idx_t i = self->root;
+    while (i != AVLTREE_NIL) {
+        const avltree_node_t *node = &nodes[i];
+        const int cmp = strzp_cmp(prefix, key, len, node->prefix, node->key);
+        if (cmp == 0) {
+            return (map_res_t){
+                .data = node->value,
+                .ok   = 1,
+            };
+        }
+        i = cmp < 0 ? node->left : node->right;
+    }
 
-    return self;
+    return (map_res_t){0};
 }
 
-static avltree_node_t *avltree_min_node(avltree_node_t *self) {
-    if (self == NULL)
-        return NULL;
+int avltree_remove_n(void *_self, const char *key, const size_t len) {
+    avltree_t *self = _self;
+    avltree_node_t *nodes = self->nodes;
 
-    while (self->left != NULL)
-        self = self->left;
+    avltree_path_t path = { .len = 0 };
+    avltree_idx_t *link = avltree_descend(self, &path, key, len);
+    const avltree_idx_t i = *link;
+    if (i == AVLTREE_NIL)
+        return 0;
 
-    return self;
+    avltree_node_t *node = &nodes[i];
+    arena_free_str(&self->arena, node->key);
+
+    // Нет ветвей или одна ветвь: узел заменяется единственной ветвью.
+    //  1             3
+    //   \           / \
+    //    3    ->   2   4
+    //   / \
+    //  2   4
+    if (node->left == AVLTREE_NIL || node->right == AVLTREE_NIL) {
+        *link = node->left != AVLTREE_NIL ? node->left : node->right;
+        avltree_node_free(self, i);
+        avltree_path_rebalance(nodes, &path);
+        return 1;
+    }
+
+    // У узла есть обе ветви. Данные минимального узла правой ветви
+    // переносятся в узел без копирования ключа, а сам минимальный узел,
+    // у которого нет левой ветви, заменяется своей правой ветвью.
+    //
+    //      3              4             4
+    //     / \            / \           / \
+    //    2   5    ->    2   5    ->   2   5
+    //   /   / \        /   / \       /     \
+    //  1   4   6      1   4   6     1       6
+    //      ^
+    //  минимальный в
+    //  правой  ветви
+    avltree_path_push(&path, link);
+    avltree_idx_t *min_link = &node->right;
+    while (nodes[*min_link].left != AVLTREE_NIL) {
+        avltree_path_push(&path, min_link);
+        min_link = &nodes[*min_link].left;
+    }
+
+    const avltree_idx_t min = *min_link;
+    node->prefix = nodes[min].prefix;
+    node->key = nodes[min].key;
+    node->value = nodes[min].value;
+    *min_link = nodes[min].right;
+    avltree_node_free(self, min);
+
+    avltree_path_rebalance(nodes, &path);
+    return 1;
 }
 
-map_res_t avltree_lookup(const void *_self, const mkey_t key) {
-    const avltree_t *self = _self;
+// Строит идеально сбалансированное дерево из n узлов с индексами out,
+// упорядоченных по ключам. Размеры ветвей каждого узла отличаются не больше
+// чем на 1, поэтому дерево сбалансировано и как AVL дерево. Глубина
+// рекурсии - log2(n).
+static avltree_idx_t avltree_build(avltree_node_t *nodes, const avltree_idx_t *out, const size_t n) {
+    if (n == 0)
+        return AVLTREE_NIL;
+
+    const size_t mid = n / 2;
+    const avltree_idx_t i = out[mid];
+    nodes[i].left = avltree_build(nodes, out, mid);
+    nodes[i].right = avltree_build(nodes, out + mid + 1, n - mid - 1);
+    avltree_node_update(nodes, i);
+    return i;
+}
 
-    const avltree_node_t *found = avltree_node_lookup(self->root, key);
-    if (found == NULL)
-        return (map_res_t){0};
+// Стек симметричного обхода: узлы пути, левые ветви которых пройдены.
+typedef struct {
+    avltree_idx_t nodes[AVLTREE_MAX_HEIGHT];
+    int           len;
+} avltree_stack_t;
+
+static void avltree_stack_push_left(avltree_stack_t *stack, const avltree_node_t *nodes,
+                                    avltree_idx_t i) {
+    for (; i != AVLTREE_NIL; i = nodes[i].left) {
+        assert(stack->len < AVLTREE_MAX_HEIGHT);
+        stack->nodes[stack->len++] = i;
+    }
+}
 
-    return (map_res_t){
-        .data = found->data.value,
-        .ok   = 1,
-    };
+// Возвращает следующий по порядку ключей узел или AVLTREE_NIL.
+static avltree_idx_t avltree_stack_next(avltree_stack_t *stack, const avltree_node_t *nodes) {
+    if (stack->len == 0)
+        return AVLTREE_NIL;
+    const avltree_idx_t i = stack->nodes[--stack->len];
+    avltree_stack_push_left(stack, nodes, nodes[i].right);
+    return i;
 }
 
-static avltree_node_t *avltree_node_remove(avltree_node_t *node, const char *key) {
-    if (node == NULL)
-        return NULL;
+int avltree_insert_sorted(void *_self, const mkey_t *keys, const mval_t *values, const size_t n) {
+    avltree_t *self = _self;
 
-    const int cmp = strcmp(key, node->data.key);
-    if (cmp < 0) {
-        node->left = avltree_node_remove(node->left, key);
-    } else if (cmp > 0) {
-        node->right = avltree_node_remove(node->right, key);
-    } else {
-        // cmp == 0
+    if (n == 0)
+        return 0;
+    if (n > AVLTREE_MAX_NODES - self->len)
+        return ENOMEM;
+
+    const size_t count = avltree_count(self);
+    if (n < count / AVLTREE_MERGE_RATIO) {
+        if (avltree_reserve(self, count + n) != 0)
+            return ENOMEM;
+        for (size_t i = 0; i < n; i++)
+            avltree_insert_n(self, keys[i], strlen(keys[i]), values[i]);
+        return 0;
+    }
 
-        // Нет ветвей, лист.
-        if (node->left == NULL && node->right == NULL) {
-            free(node->data.key);
-            free(node);
-            return NULL;
+    // Место под узлы выделяется до изменения дерева. Узлы пустого дерева
+    // выделяются подряд и лежат в массиве по порядку ключей.
+    if (self->len + n > self->cap && avltree_resize(self, self->len + n) != 0)
+        return ENOMEM;
+    avltree_idx_t *out = malloc((count + n) * sizeof(avltree_idx_t));
+    if (out == NULL)
+        return ENOMEM;
+
+    // Слияние записей дерева с ключами: out - индексы узлов по порядку ключей.
+    avltree_node_t *nodes = self->nodes;
+    avltree_stack_t stack = { .len = 0 };
+    avltree_stack_push_left(&stack, nodes, self->root);
+    avltree_idx_t e = avltree_stack_next(&stack, nodes);
+    size_t m = 0;
+    int err = 0;
+    for (size_t i = 0; i < n && err == 0; i++) {
+        const size_t len = strlen(keys[i]);
+        const uint64_t prefix = str_prefix(keys[i], len);
+
+        int cmp = 1;
+        while (e != AVLTREE_NIL
+               && (cmp = strzp_cmp(prefix, keys[i], len, nodes[e].prefix, nodes[e].key)) > 0) {
+            out[m++] = e;
+            e = avltree_stack_next(&stack, nodes);
+        }
+        if (e != AVLTREE_NIL && cmp == 0) {
+            nodes[e].value = values[i]; // обновляем существующее значение
+            out[m++] = e;
+            e = avltree_stack_next(&stack, nodes);
+            continue;
         }
 
-        // Одна ветвь: правая.
-        //  1             3
-        //   \           / \
-        //    3    ->   2   4
-        //   / \
-        //  2   4
-        if (node->left == NULL) {
-            avltree_node_t *next = node->right;
-            free(node->data.key);
-            free(node);
-            return next;
+        mut_mkey_t dup = arena_strndup(&self->arena, keys[i], len);
+        if (dup == NULL) {
+            err = ENOMEM;
+            break;
         }
+        const avltree_idx_t j = avltree_node_alloc(self);
+        nodes[j] = (avltree_node_t){
+            .prefix = prefix,
+            .key    = dup,
+            .value  = values[i],
+        };
+        out[m++] = j;
+    }
+    for (; e != AVLTREE_NIL; e = avltree_stack_next(&stack, nodes))
+        out[m++] = e;
+
+    self->root = avltree_build(nodes, out, m);
+    free(out);
+    return err;
+}
+
+// Курсор хранит путь от корня, текущий узел - it->path[it->depth - 1].
+// Путь не длиннее высоты дерева, поэтому всегда помещается в курсор.
+_Static_assert(MAP_ITER_DEPTH >= AVLTREE_MAX_HEIGHT);
+
+static int avltree_iter_load(map_iter_t *it) {
+    if (it->depth == 0) {
+        it->key = NULL;
+        it->value = 0;
+        return 0;
+    }
 
-        // Одна ветвь: левая.
-        //      4         2
-        //     /         / \
-        //    2    ->   1   3
-        //   / \
-        //  1   3
-        if (node->right == NULL) {
-            avltree_node_t *next = node->left;
-            free(node->data.key);
-            free(node);
-            return next;
+    const avltree_node_t *node = it->path[it->depth - 1];
+    it->key = node->key;
+    it->value = node->value;
+    return 1;
+}
+
+// Дописывает в путь спуск от узла i до крайнего левого (right = 0)
+// или крайнего правого (right = 1) узла поддерева.
+static void avltree_iter_descend(map_iter_t *it, avltree_idx_t i, const int right) {
+    const avltree_t *self = it->map;
+    while (i != AVLTREE_NIL) {
+        const avltree_node_t *node = &self->nodes[i];
+        it->path[it->depth++] = node;
+        i = right ? node->right : node->left;
+    }
+}
+
+// Поднимается по пути, пока пройденный узел - правый (right = 1)
+// или левый (right = 0) ребёнок следующего узла пути.
+static void avltree_iter_ascend(map_iter_t *it, const int right) {
+    const avltree_t *self = it->map;
+    const avltree_node_t *child, *parent;
+    do {
+        child = it->path[--it->depth];
+        parent = it->depth > 0 ? it->path[it->depth - 1] : NULL;
+    } while (parent != NULL && &self->nodes[right ? parent->right : parent->left] == child);
+}
+
+int avltree_iter_seek(map_iter_t *it, const char *key, const size_t len) {
+    const avltree_t *self = it->map;
+
+    // Длина пути до наименьшего из пройденных узлов, не меньших ключа.
+    const uint64_t prefix = str_prefix(key, len);
+    int found = 0;
+    it->depth = 0;
+    for (avltree_idx_t i = self->root; i != AVLTREE_NIL;) {
+        const avltree_node_t *node = &self->nodes[i];
+        it->path[it->depth++] = node;
+        const int cmp = strzp_cmp(prefix, key, len, node->prefix, node->key);
+        if (cmp > 0) {
+            i = node->right;
+            continue;
         }
+        found = it->depth;
+        if (cmp == 0)
+            break;
+        i = node->left;
+    }
+    it->depth = found;
+
+    return avltree_iter_load(it);
+}
 
-        // У узла есть обе ветви. Выбирается минимальный элемент
-        // в правой ветви или максимальный в левой и встаёт на место
-        // корня.
-
-        //      3              4             4
-        //     / \            / \           / \
-        //    2   5    ->    2   5    ->   2   5
-        //   /   / \        /   / \       /     \
-        //  1   4   6      1   4   6     1       6
-        //      ^
-        //  минимальный в
-        //  правой  ветви
-        const avltree_node_t *min = avltree_min_node(node->right);
-        free(node->data.key);
-        node->data.key = strdup(min->data.key);
-        node->data.value = min->data.value;
-        node->right = avltree_node_remove(node->right, min->data.key);
+int avltree_iter_next(map_iter_t *it) {
+    if (it->key == NULL) {
+        const avltree_t *self = it->map;
+        it->depth = 0;
+        avltree_iter_descend(it, self->root, 0);
+    } else {
+        const avltree_node_t *node = it->path[it->depth - 1];
+        if (node->right != AVLTREE_NIL)
+            avltree_iter_descend(it, node->right, 0);
+        else
+            avltree_iter_ascend(it, 1);
     }
 
-    node->height = max(avltree_node_height(node->left), avltree_node_height(node->right));
-    return avltree_balance(node);
+    return avltree_iter_load(it);
 }
 
-int avltree_remove(void *_self, const mkey_t key) {
-    avltree_t *self = _self;
+int avltree_iter_prev(map_iter_t *it) {
+    if (it->key == NULL) {
+        const avltree_t *self = it->map;
+        it->depth = 0;
+        avltree_iter_descend(it, self->root, 1);
+    } else {
+        const avltree_node_t *node = it->path[it->depth - 1];
+        if (node->left != AVLTREE_NIL)
+            avltree_iter_descend(it, node->left, 1);
+        else
+            avltree_iter_ascend(it, 0);
+    }
 
-    if (avltree_lookup(_self, key).ok == 0)
-        return 0;
+    return avltree_iter_load(it);
+}
+
+size_t avltree_rank(const void *_self, const char *key, const size_t len) {
+    const avltree_t *self = _self;
+    if (key == NULL)
+        return avltree_count(self);
+
+    // Ключи левой ветви и сам узел меньше ключа, если спуск идёт направо.
+    const avltree_node_t *nodes = self->nodes;
+    const uint64_t prefix = str_prefix(key, len);
+    size_t rank = 0;
+    for (avltree_idx_t i = self->root; i != AVLTREE_NIL;) {
+        const avltree_node_t *node = &nodes[i];
+        const int cmp = strzp_cmp(prefix, key, len, node->prefix, node->key);
+        if (cmp <= 0) {
+            if (cmp == 0)
+                return rank + nodes[node->left].size;
+            i = node->left;
+        } else {
+            rank += nodes[node->left].size + 1;
+            i = node->right;
+        }
+    }
+    return rank;
+}
 
-    self->root = avltree_node_remove(self->root, key);
+int avltree_iter_select(map_iter_t *it, size_t k) {
+    const avltree_t *self = it->map;
+    const avltree_node_t *nodes = self->nodes;
+
+    it->depth = 0;
+    for (avltree_idx_t i = self->root; i != AVLTREE_NIL;) {
+        const avltree_node_t *node = &nodes[i];
+        it->path[it->depth++] = node;
+
+        const size_t left = nodes[node->left].size;
+        if (k == left)
+            return avltree_iter_load(it);
+        if (k < left) {
+            i = node->left;
+        } else {
+            k -= left + 1;
+            i = node->right;
+        }
+    }
+    it->depth = 0;
 
-    return 1;
+    return avltree_iter_load(it);
 }
 
 const imap_t AVLTreeClass = {
     .size   = sizeof(avltree_t),
     .ctor   = avltree_ctor,
     .dtor   = avltree_destroy,
-    .insert = avltree_insert,
-    .lookup = avltree_lookup,
-    .remove = avltree_remove,
+    .insert_n = avltree_insert_n,
+    .lookup_n = avltree_lookup_n,
+    .remove_n = avltree_remove_n,
+    .reserve  = avltree_reserve,
+    .insert_sorted = avltree_insert_sorted,
+    .iter_seek = avltree_iter_seek,
+    .iter_next = avltree_iter_next,
+    .iter_prev = avltree_iter_prev,
+    .rank        = avltree_rank,
+    .iter_select = avltree_iter_select,
 };
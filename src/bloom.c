@@ -0,0 +1,261 @@
+#include "bloom.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "err.h"
+
+// Количество позиций (бит или счётчиков) в блоке.
+#define BLOOM_BLOCK_BITS      (BLOOM_BLOCK_SIZE * 8)
+#define CBLOOM_BLOCK_COUNTERS (BLOOM_BLOCK_SIZE * 2)
+
+// Двоичные логарифмы количества позиций в блоке.
+#define BLOOM_BLOCK_LOG  9
+#define CBLOOM_BLOCK_LOG 7
+
+_Static_assert(BLOOM_BLOCK_BITS == 1 << BLOOM_BLOCK_LOG);
+_Static_assert(CBLOOM_BLOCK_COUNTERS == 1 << CBLOOM_BLOCK_LOG);
+
+#define BLOOM_MAX_K 16
+
+// Максимальное значение 4-битного счётчика.
+#define CBLOOM_COUNTER_MAX 15
+
+// Зерно второго перемешивания хэша, из которого получаются позиции в блоке.
+#define BLOOM_SALT 0x9e3779b9u
+
+// ln 2. M_LN2 не входит в C11, а libm библиотеке не нужна.
+#define BLOOM_LN2 0.69314718055994530942
+
+// Натуральный логарифм x > 0. x = m * 2^e, 1/2 <= m < 1, и
+// ln m = 2 atanh(z), z = (m - 1) / (m + 1), |z| <= 1/3; ряд atanh
+// сходится до точности double за два десятка членов.
+static double bloom_ln(double x) {
+    int e = 0;
+    for (; x >= 1; x /= 2)
+        e++;
+    for (; x < 0.5; x *= 2)
+        e--;
+
+    const double z = (x - 1) / (x + 1);
+    double term = z, sum = 0;
+    for (int i = 1; i < 40; i += 2) {
+        sum += term / i;
+        term *= z * z;
+    }
+    return 2 * sum + e * BLOOM_LN2;
+}
+
+// x в степени n.
+static double bloom_pow(double x, unsigned n) {
+    double r = 1;
+    for (; n > 0; n >>= 1) {
+        if (n & 1)
+            r *= x;
+        x *= x;
+    }
+    return r;
+}
+
+// Оценка доли ложных срабатываний блочного фильтра из блоков по slots
+// позиций, k позиций на ключ, при среднем количестве ключей в блоке load.
+// Количество ключей в блоке распределено по Пуассону, а блок с L ключами
+// ведёт себя как классический фильтр из slots позиций.
+// Вероятности Пуассона вычисляются от моды p(L + 1) = p(L) load / (L + 1)
+// в обе стороны, пока не станут пренебрежимо малы, и затем нормируются.
+static double bloom_estimate(const double load, const size_t slots, const unsigned k) {
+    const double miss = 1 - 1.0 / (double) slots;
+    const unsigned mode = (unsigned) load;
+    double fpr = 0, total = 0;
+
+    double p = 1;
+    for (unsigned l = mode; p > 1e-18 * total; l++) {
+        fpr += p * bloom_pow(1 - bloom_pow(miss, k * l), k);
+        total += p;
+        p *= load / (l + 1);
+    }
+
+    p = 1;
+    for (unsigned l = mode; l > 0 && p > 1e-18 * total;) {
+        p *= l / load;
+        l--;
+        fpr += p * bloom_pow(1 - bloom_pow(miss, k * l), k);
+        total += p;
+    }
+
+    return fpr / total;
+}
+
+// Вычисляет количество блоков по slots позиций и количество позиций
+// на ключ для n ключей с долей ложных срабатываний fpr.
+static int bloom_size(const size_t n, const double fpr, const size_t slots,
+                      size_t *nblocks, unsigned *k) {
+    if (!(fpr > 0 && fpr < 1))
+        return EINVAL;
+
+    // Размер и количество позиций классического фильтра:
+    // m = -n ln(fpr) / ln(2)^2, k = m / n ln(2).
+    const double bits = -bloom_ln(fpr) / (BLOOM_LN2 * BLOOM_LN2);
+    unsigned kk = (unsigned) (bits * BLOOM_LN2 + 0.5);
+    kk = kk < 1 ? 1 : kk > BLOOM_MAX_K ? BLOOM_MAX_K : kk;
+    const double exact = (double) n * bits / (double) slots;
+    size_t blocks = (size_t) exact;
+    if ((double) blocks < exact || blocks == 0)
+        blocks++;
+
+    // Ключи распределяются по блокам неравномерно, поэтому блочному фильтру
+    // для той же доли ложных срабатываний нужно больше памяти.
+    // Номер блока вычисляется из 32-битного хэша.
+    while (n > 0 && blocks < UINT32_MAX
+           && bloom_estimate((double) n / (double) blocks, slots, kk) > fpr)
+        blocks += blocks / 32 + 1;
+
+    *nblocks = blocks < UINT32_MAX ? blocks : UINT32_MAX;
+    *k = kk;
+    return 0;
+}
+
+static void *bloom_blocks_new(const size_t nblocks) {
+    void *blocks = aligned_alloc(BLOOM_BLOCK_SIZE, nblocks * BLOOM_BLOCK_SIZE);
+    if (blocks != NULL)
+        memset(blocks, 0, nblocks * BLOOM_BLOCK_SIZE);
+    return blocks;
+}
+
+// Нечётные множители позиций ключа в блоке, по одному на позицию.
+static const hash_t bloom_salts[BLOOM_MAX_K] = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+    0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u,
+    0x9e3779b9u, 0x85ebca6bu, 0xc2b2ae35u, 0x27d4eb2fu,
+    0x165667b1u, 0xd3a2646du, 0xfd7046c5u, 0xb55a4f09u,
+};
+
+// Позиции ключа: номер блока и хэш, из которого позиция i в блоке
+// получается умножением на bloom_salts[i] и взятием старших бит.
+// В отличие от арифметической прогрессии a + i * b, позиции разных
+// ключей почти независимы, и доля ложных срабатываний совпадает с расчётной.
+typedef struct {
+    size_t block;
+    hash_t hash;
+} bloom_pos_t;
+
+static inline bloom_pos_t bloom_pos(const size_t nblocks, const hash_t hash) {
+    const hash_t h1 = hash_mix(hash);
+    const hash_t h2 = hash_mix(h1 ^ BLOOM_SALT);
+
+    return (bloom_pos_t){
+        .block = (size_t) (((uint64_t) h1 * nblocks) >> 32),
+        .hash  = h2,
+    };
+}
+
+// Позиция i ключа в блоке из 2^bits позиций.
+#define BLOOM_SLOT(pos, i, bits) ((hash_t) ((pos).hash * bloom_salts[i]) >> (32 - (bits)))
+
+int bloom_init(bloom_t *self, const size_t n, const double fpr) {
+    const int err = bloom_size(n, fpr, BLOOM_BLOCK_BITS, &self->nblocks, &self->k);
+    if (err)
+        return err;
+
+    self->blocks = bloom_blocks_new(self->nblocks);
+    if (self->blocks == NULL)
+        return ENOMEM;
+    return 0;
+}
+
+void bloom_destroy(bloom_t *self) {
+    free(self->blocks);
+    self->blocks = NULL;
+    self->nblocks = 0;
+}
+
+void bloom_add(bloom_t *self, const hash_t hash) {
+    const bloom_pos_t pos = bloom_pos(self->nblocks, hash);
+    uint64_t *block = self->blocks + pos.block * (BLOOM_BLOCK_SIZE / sizeof(uint64_t));
+
+    for (unsigned i = 0; i < self->k; i++) {
+        const unsigned bit = BLOOM_SLOT(pos, i, BLOOM_BLOCK_LOG);
+        block[bit / 64] |= (uint64_t) 1 << (bit % 64);
+    }
+}
+
+int bloom_test(const bloom_t *self, const hash_t hash) {
+    const bloom_pos_t pos = bloom_pos(self->nblocks, hash);
+    const uint64_t *block = self->blocks + pos.block * (BLOOM_BLOCK_SIZE / sizeof(uint64_t));
+
+    for (unsigned i = 0; i < self->k; i++) {
+        const unsigned bit = BLOOM_SLOT(pos, i, BLOOM_BLOCK_LOG);
+        if (!(block[bit / 64] & (uint64_t) 1 << (bit % 64)))
+            return 0;
+    }
+    return 1;
+}
+
+void bloom_clear(bloom_t *self) {
+    memset(self->blocks, 0, self->nblocks * BLOOM_BLOCK_SIZE);
+}
+
+int cbloom_init(cbloom_t *self, const size_t n, const double fpr) {
+    const int err = bloom_size(n, fpr, CBLOOM_BLOCK_COUNTERS, &self->nblocks, &self->k);
+    if (err)
+        return err;
+
+    self->blocks = bloom_blocks_new(self->nblocks);
+    if (self->blocks == NULL)
+        return ENOMEM;
+    return 0;
+}
+
+void cbloom_destroy(cbloom_t *self) {
+    free(self->blocks);
+    self->blocks = NULL;
+    self->nblocks = 0;
+}
+
+// Счётчик с номером i хранится в половине байта i / 2.
+#define CBLOOM_SHIFT(i) (((i) % 2) * 4)
+#define CBLOOM_COUNTER(block, i) (((block)[(i) / 2] >> CBLOOM_SHIFT(i)) & 0xf)
+
+void cbloom_add(cbloom_t *self, const hash_t hash) {
+    const bloom_pos_t pos = bloom_pos(self->nblocks, hash);
+    uint8_t *block = self->blocks + pos.block * BLOOM_BLOCK_SIZE;
+
+    for (unsigned i = 0; i < self->k; i++) {
+        const unsigned c = BLOOM_SLOT(pos, i, CBLOOM_BLOCK_LOG);
+        if (CBLOOM_COUNTER(block, c) < CBLOOM_COUNTER_MAX)
+            block[c / 2] += 1 << CBLOOM_SHIFT(c);
+    }
+}
+
+void cbloom_remove(cbloom_t *self, const hash_t hash) {
+    const bloom_pos_t pos = bloom_pos(self->nblocks, hash);
+    uint8_t *block = self->blocks + pos.block * BLOOM_BLOCK_SIZE;
+
+    for (unsigned i = 0; i < self->k; i++) {
+        const unsigned c = BLOOM_SLOT(pos, i, CBLOOM_BLOCK_LOG);
+        const unsigned count = CBLOOM_COUNTER(block, c);
+
+        // Насыщенный счётчик мог быть увеличен и другими ключами сверх 15,
+        // поэтому его значение больше не уменьшается.
+        assert(count > 0);
+        if (count > 0 && count < CBLOOM_COUNTER_MAX)
+            block[c / 2] -= 1 << CBLOOM_SHIFT(c);
+    }
+}
+
+int cbloom_test(const cbloom_t *self, const hash_t hash) {
+    const bloom_pos_t pos = bloom_pos(self->nblocks, hash);
+    const uint8_t *block = self->blocks + pos.block * BLOOM_BLOCK_SIZE;
+
+    for (unsigned i = 0; i < self->k; i++) {
+        const unsigned c = BLOOM_SLOT(pos, i, CBLOOM_BLOCK_LOG);
+        if (CBLOOM_COUNTER(block, c) == 0)
+            return 0;
+    }
+    return 1;
+}
+
+void cbloom_clear(cbloom_t *self) {
+    memset(self->blocks, 0, self->nblocks * BLOOM_BLOCK_SIZE);
+}
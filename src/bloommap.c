@@ -0,0 +1,108 @@
+#include "bloommap.h"
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdlib.h>
+
+#include "bloom.h"
+#include "err.h"
+#include "hash.h"
+
+typedef struct {
+    const imap_t *class;
+    void         *inner;   // Вложенная мапа, хранящая записи.
+    cbloom_t      filter;  // Фильтр по ключам вложенной мапы.
+    hash_t        seed;
+    hash_func_t   hash;
+} bloommap_t;
+
+_Static_assert(offsetof(bloommap_t, class) == 0);
+
+
+void *bloommap_ctor(void *_self, va_list *ap) {
+    bloommap_t *self = _self;
+
+    const size_t n = va_arg(*ap, size_t);
+    const double fpr = va_arg(*ap, double);
+
+    self->seed = rand();
+    self->hash = va_arg(*ap, hash_func_t);
+    assert(self->hash != NULL);
+
+    const int err = cbloom_init(&self->filter, n, fpr);
+    if (err)
+        return ERR_PTR(-(long) err);
+
+    // Оставшиеся параметры принадлежат конструктору вложенной мапы.
+    const imap_t *inner = va_arg(*ap, const imap_t *);
+    self->inner = map_vnew(inner, ap);
+    if (IS_ERR(self->inner)) {
+        cbloom_destroy(&self->filter);
+        return ERR_CAST(self->inner);
+    }
+
+    return self;
+}
+
+void bloommap_dtor(void *_self) {
+    bloommap_t *self = _self;
+
+    map_destroy(self->inner);
+    cbloom_destroy(&self->filter);
+}
+
+void bloommap_insert_n(void *_self, const char *key, const size_t len, const mval_t value) {
+    bloommap_t *self = _self;
+
+    const hash_t hash = self->hash(self->seed, key, len);
+
+    // Счётчики увеличиваются только для нового ключа, иначе удаление
+    // не вернуло бы их к прежним значениям. Если фильтр не знает ключа,
+    // ключ точно новый и искать его во вложенной мапе не нужно.
+    if (!cbloom_test(&self->filter, hash) || !map_lookup_n(self->inner, key, len).ok)
+        cbloom_add(&self->filter, hash);
+
+    map_insert_n(self->inner, key, len, value);
+}
+
+map_res_t bloommap_lookup_n(const void *_self, const char *key, const size_t len) {
+    const bloommap_t *self = _self;
+
+    if (!cbloom_test(&self->filter, self->hash(self->seed, key, len)))
+        return (map_res_t){0};
+    return map_lookup_n(self->inner, key, len);
+}
+
+int bloommap_remove_n(void *_self, const char *key, const size_t len) {
+    bloommap_t *self = _self;
+
+    const hash_t hash = self->hash(self->seed, key, len);
+    if (!cbloom_test(&self->filter, hash))
+        return 0;
+    if (!map_remove_n(self->inner, key, len))
+        return 0;
+
+    cbloom_remove(&self->filter, hash);
+    return 1;
+}
+
+int bloommap_reserve(void *_self, const size_t n) {
+    bloommap_t *self = _self;
+    return map_reserve(self->inner, n);
+}
+
+void *bloommap_inner(const void *_self) {
+    const bloommap_t *self = _self;
+    assert(*(const imap_t *const *) _self == &BloomMapClass);
+    return self->inner;
+}
+
+const imap_t BloomMapClass = {
+    .size     = sizeof(bloommap_t),
+    .ctor     = bloommap_ctor,
+    .dtor     = bloommap_dtor,
+    .insert_n = bloommap_insert_n,
+    .lookup_n = bloommap_lookup_n,
+    .remove_n = bloommap_remove_n,
+    .reserve  = bloommap_reserve,
+};
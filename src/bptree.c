@@ -0,0 +1,642 @@
+#include "bptree.h"
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "err.h"
+#include "pool.h"
+
+// Минимальное количество ключей в некорневом узле. Узел с меньшим
+// количеством ключей занимает ключ у соседа или сливается с ним.
+#define BPTREE_MIN_KEYS (BPTREE_MAX_KEYS / 2)
+
+// Количество записей, остающихся в левом листе при разделении
+// переполненного листа из BPTREE_MAX_KEYS + 1 записей.
+#define BPTREE_LEAF_SPLIT ((BPTREE_MAX_KEYS + 2) / 2)
+
+// Наибольшая высота дерева. Некорневой внутренний узел имеет не меньше
+// BPTREE_MIN_KEYS + 1 детей, поэтому 32 уровней достаточно для любого n.
+#define BPTREE_MAX_HEIGHT 32
+
+// Общая часть листа и внутреннего узла. Массивы вмещают на один ключ
+// больше максимума: узел переполняется вставкой и сразу разделяется.
+typedef struct {
+    uint16_t   n;       // Количество ключей.
+    uint16_t   leaf;    // 1 для листа.
+    uint64_t   prefixes[BPTREE_MAX_KEYS + 1];
+    mut_mkey_t keys[BPTREE_MAX_KEYS + 1];
+} bptree_node_t;
+
+typedef struct bptree_leaf bptree_leaf_t;
+
+struct bptree_leaf {
+    bptree_node_t  node;
+    mval_t         values[BPTREE_MAX_KEYS + 1];
+    bptree_leaf_t *prev;
+    bptree_leaf_t *next;
+};
+
+// Все ключи поддерева children[i] меньше keys[i], все ключи поддерева
+// children[i + 1] не меньше keys[i]. Ключи внутренних узлов - копии
+// ключей листьев, владеет ими внутренний узел.
+typedef struct {
+    bptree_node_t  node;
+    bptree_node_t *children[BPTREE_MAX_KEYS + 2];
+} bptree_inner_t;
+
+typedef struct {
+    const imap_t  *class;
+    bptree_node_t *root;
+
+    size_t         count;
+    size_t         height;
+    size_t         nleaves;
+    size_t         ninners;
+
+    pool_t         leaves;  // Пул листьев.
+    pool_t         inners;  // Пул внутренних узлов.
+    arena_t        arena;   // Арена для ключей.
+} bptree_t;
+
+_Static_assert(offsetof(bptree_t, class) == 0);
+
+// Путь от корня до листа: внутренние узлы и номера детей, по которым
+// продолжился спуск.
+typedef struct {
+    bptree_inner_t *nodes[BPTREE_MAX_HEIGHT];
+    int             idx[BPTREE_MAX_HEIGHT];
+    int             len;
+} bptree_path_t;
+
+
+#define BPTREE_INNER(node) ((bptree_inner_t *) (node))
+#define BPTREE_LEAF(node) ((bptree_leaf_t *) (node))
+
+// Сравнивает ключ с ключом i узла: < 0, если ключ меньше, 0, если равен,
+// > 0, если больше.
+static inline int bptree_key_cmp(const bptree_node_t *node, const size_t i,
+                                 const uint64_t prefix, const char *key, const size_t len) {
+    return strzp_cmp(prefix, key, len, node->prefixes[i], node->keys[i]);
+}
+
+// Бинарный поиск в узле. Возвращает номер первого ключа, не меньшего
+// данного, found - 1, если этот ключ равен данному.
+static inline size_t bptree_search(const bptree_node_t *node, const uint64_t prefix,
+                                   const char *key, const size_t len, int *found) {
+    size_t lo = 0, hi = node->n;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        const int cmp = bptree_key_cmp(node, mid, prefix, key, len);
+        if (cmp == 0) {
+            *found = 1;
+            return mid;
+        }
+        if (cmp < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    *found = 0;
+    return lo;
+}
+
+// Спускается от корня к листу, в котором находится или должен находиться
+// ключ. Если path не NULL, записывает в него пройденные внутренние узлы.
+static bptree_leaf_t *bptree_descend(const bptree_t *self, bptree_path_t *path,
+                                     const uint64_t prefix, const char *key, const size_t len) {
+    bptree_node_t *node = self->root;
+    if (path)
+        path->len = 0;
+
+    while (!node->leaf) {
+        int found;
+        const size_t i = bptree_search(node, prefix, key, len, &found);
+        // Ключ, равный разделителю, находится в правом поддереве.
+        const size_t child = found ? i + 1 : i;
+
+        if (path) {
+            assert(path->len < BPTREE_MAX_HEIGHT);
+            path->nodes[path->len] = BPTREE_INNER(node);
+            path->idx[path->len] = (int) child;
+            path->len++;
+        }
+        node = BPTREE_INNER(node)->children[child];
+    }
+
+    return BPTREE_LEAF(node);
+}
+
+static bptree_leaf_t *bptree_leaf_new(bptree_t *self) {
+    bptree_leaf_t *leaf = pool_alloc(&self->leaves);
+    if (leaf == NULL)
+        return NULL;
+
+    leaf->node.n = 0;
+    leaf->node.leaf = 1;
+    leaf->prev = NULL;
+    leaf->next = NULL;
+    self->nleaves++;
+    return leaf;
+}
+
+static void bptree_leaf_free(bptree_t *self, bptree_leaf_t *leaf) {
+    pool_free(&self->leaves, leaf);
+    self->nleaves--;
+}
+
+static void bptree_inner_free(bptree_t *self, bptree_inner_t *inner) {
+    pool_free(&self->inners, inner);
+    self->ninners--;
+}
+
+// Сдвигает ключи узла, начиная с i, на count позиций вправо (count > 0)
+// или влево (count < 0). Количество ключей не меняется.
+static inline void bptree_keys_shift(bptree_node_t *node, const size_t i, const int count) {
+    const size_t n = node->n - i;
+    memmove(&node->prefixes[i + count], &node->prefixes[i], n * sizeof(uint64_t));
+    memmove(&node->keys[i + count], &node->keys[i], n * sizeof(mut_mkey_t));
+}
+
+static void bptree_leaf_insert_at(bptree_leaf_t *leaf, const size_t i, const uint64_t prefix,
+                                  const mut_mkey_t key, const mval_t value) {
+    bptree_keys_shift(&leaf->node, i, 1);
+    memmove(&leaf->values[i + 1], &leaf->values[i], (leaf->node.n - i) * sizeof(mval_t));
+    leaf->node.prefixes[i] = prefix;
+    leaf->node.keys[i] = key;
+    leaf->values[i] = value;
+    leaf->node.n++;
+}
+
+static void bptree_leaf_remove_at(bptree_leaf_t *leaf, const size_t i) {
+    bptree_keys_shift(&leaf->node, i + 1, -1);
+    memmove(&leaf->values[i], &leaf->values[i + 1], (leaf->node.n - i - 1) * sizeof(mval_t));
+    leaf->node.n--;
+}
+
+// Вставляет в узел разделитель с номером i и правого от него ребёнка.
+static void bptree_inner_insert_at(bptree_inner_t *inner, const size_t i, const uint64_t prefix,
+                                   const mut_mkey_t key, bptree_node_t *child) {
+    memmove(&inner->children[i + 2], &inner->children[i + 1],
+            (inner->node.n - i) * sizeof(bptree_node_t *));
+    bptree_keys_shift(&inner->node, i, 1);
+    inner->node.prefixes[i] = prefix;
+    inner->node.keys[i] = key;
+    inner->children[i + 1] = child;
+    inner->node.n++;
+}
+
+// Удаляет из узла разделитель с номером i и правого от него ребёнка.
+static void bptree_inner_remove_at(bptree_inner_t *inner, const size_t i) {
+    memmove(&inner->children[i + 1], &inner->children[i + 2],
+            (inner->node.n - i - 1) * sizeof(bptree_node_t *));
+    bptree_keys_shift(&inner->node, i + 1, -1);
+    inner->node.n--;
+}
+
+void *bptree_ctor(void *_self, va_list *ap) {
+    bptree_t *self = _self;
+
+    pool_init(&self->leaves, sizeof(bptree_leaf_t));
+    pool_init(&self->inners, sizeof(bptree_inner_t));
+    arena_init(&self->arena);
+    self->count = 0;
+    self->nleaves = 0;
+    self->ninners = 0;
+
+    bptree_leaf_t *root = bptree_leaf_new(self);
+    if (root == NULL)
+        return ERR_PTR(-ENOMEM);
+    self->root = &root->node;
+    self->height = 1;
+
+    return self;
+}
+
+void bptree_dtor(void *_self) {
+    bptree_t *self = _self;
+
+    // Узлы и ключи освобождаются разом, без обхода дерева.
+    pool_destroy(&self->leaves);
+    pool_destroy(&self->inners);
+    arena_destroy(&self->arena);
+    self->root = NULL;
+}
+
+map_res_t bptree_lookup_n(const void *_self, const char *key, const size_t len) {
+    const bptree_t *self = _self;
+
+    const uint64_t prefix = str_prefix(key, len);
+    const bptree_leaf_t *leaf = bptree_descend(self, NULL, prefix, key, len);
+
+    int found;
+    const size_t i = bptree_search(&leaf->node, prefix, key, len, &found);
+    if (!found)
+        return (map_res_t){0};
+
+    return (map_res_t){
+        .data = leaf->values[i],
+        .ok   = 1,
+    };
+}
+
+void bptree_insert_n(void *_self, const char *key, const size_t len, const mval_t value) {
+    bptree_t *self = _self;
+
+    const uint64_t prefix = str_prefix(key, len);
+    bptree_path_t path;
+    bptree_leaf_t *leaf = bptree_descend(self, &path, prefix, key, len);
+
+    int found;
+    const size_t pos = bptree_search(&leaf->node, prefix, key, len, &found);
+    if (found) {
+        leaf->values[pos] = value;  // update existing value.
+        return;
+    }
+
+    // Вся память, нужная для вставки, выделяется до изменения дерева,
+    // чтобы при ошибке выделения дерево осталось прежним.
+    // Переполненный лист разделяется, разделитель - копия первого ключа
+    // правой половины. Полные внутренние узлы пути снизу вверх тоже
+    // разделяются, а если полон и корень, над ним появляется новый корень.
+    bptree_inner_t *spare[BPTREE_MAX_HEIGHT + 1];
+    int nspare = 0;
+    bptree_leaf_t *right = NULL;
+    mut_mkey_t sep = NULL;
+
+    const mut_mkey_t dup = arena_strndup(&self->arena, key, len);
+    if (dup == NULL)
+        return;
+
+    if (leaf->node.n == BPTREE_MAX_KEYS) {
+        int d = path.len - 1;
+        while (d >= 0 && path.nodes[d]->node.n == BPTREE_MAX_KEYS)
+            d--;
+        const int need = path.len - 1 - d + (d < 0);
+
+        // Первый ключ правой половины листа после вставки ключа в pos.
+        const size_t s = BPTREE_LEAF_SPLIT;
+        if (s == pos)
+            sep = arena_strndup(&self->arena, key, len);
+        else
+            sep = arena_strdup(&self->arena, leaf->node.keys[s < pos ? s : s - 1]);
+        right = bptree_leaf_new(self);
+
+        for (; nspare < need; nspare++) {
+            spare[nspare] = pool_alloc(&self->inners);
+            if (spare[nspare] == NULL)
+                break;
+        }
+
+        if (sep == NULL || right == NULL || nspare < need) {
+            while (nspare > 0)
+                pool_free(&self->inners, spare[--nspare]);
+            if (right)
+                bptree_leaf_free(self, right);
+            arena_free_str(&self->arena, sep);
+            arena_free_str(&self->arena, dup);
+            return;
+        }
+        self->ninners += nspare;
+    }
+
+    bptree_leaf_insert_at(leaf, pos, prefix, dup, value);
+    self->count++;
+    if (leaf->node.n <= BPTREE_MAX_KEYS)
+        return;
+
+    // Разделение листа: правая половина переносится в новый лист,
+    // который встаёт в список листов следом за исходным.
+    const size_t moved = leaf->node.n - BPTREE_LEAF_SPLIT;
+    memcpy(right->node.prefixes, &leaf->node.prefixes[BPTREE_LEAF_SPLIT], moved * sizeof(uint64_t));
+    memcpy(right->node.keys, &leaf->node.keys[BPTREE_LEAF_SPLIT], moved * sizeof(mut_mkey_t));
+    memcpy(right->values, &leaf->values[BPTREE_LEAF_SPLIT], moved * sizeof(mval_t));
+    right->node.n = moved;
+    leaf->node.n = BPTREE_LEAF_SPLIT;
+
+    right->next = leaf->next;
+    right->prev = leaf;
+    if (leaf->next)
+        leaf->next->prev = right;
+    leaf->next = right;
+
+    // Подъём разделителя по пути.
+    uint64_t sep_prefix = right->node.prefixes[0];
+    bptree_node_t *child = &right->node;
+    for (int d = path.len - 1;; d--) {
+        if (d < 0) {
+            bptree_inner_t *root = spare[--nspare];
+            root->node.n = 1;
+            root->node.leaf = 0;
+            root->node.prefixes[0] = sep_prefix;
+            root->node.keys[0] = sep;
+            root->children[0] = self->root;
+            root->children[1] = child;
+            self->root = &root->node;
+            self->height++;
+            break;
+        }
+
+        bptree_inner_t *parent = path.nodes[d];
+        bptree_inner_insert_at(parent, path.idx[d], sep_prefix, sep, child);
+        if (parent->node.n <= BPTREE_MAX_KEYS)
+            break;
+
+        // Разделение внутреннего узла: средний ключ поднимается выше,
+        // ключи и дети правее него переносятся в новый узел.
+        bptree_inner_t *split = spare[--nspare];
+        const size_t mid = BPTREE_MAX_KEYS / 2;
+        const size_t rn = parent->node.n - mid - 1;
+        split->node.leaf = 0;
+        split->node.n = rn;
+        memcpy(split->node.prefixes, &parent->node.prefixes[mid + 1], rn * sizeof(uint64_t));
+        memcpy(split->node.keys, &parent->node.keys[mid + 1], rn * sizeof(mut_mkey_t));
+        memcpy(split->children, &parent->children[mid + 1], (rn + 1) * sizeof(bptree_node_t *));
+        parent->node.n = mid;
+
+        sep_prefix = parent->node.prefixes[mid];
+        sep = parent->node.keys[mid];
+        child = &split->node;
+    }
+    assert(nspare == 0);
+}
+
+// Заменяет разделитель i внутреннего узла копией ключа key.
+// Возвращает 0 или ENOMEM, если копию не удалось выделить.
+static int bptree_replace_sep(bptree_t *self, bptree_inner_t *inner, const size_t i,
+                              const uint64_t prefix, const char *key) {
+    const mut_mkey_t dup = arena_strdup(&self->arena, key);
+    if (dup == NULL)
+        return ENOMEM;
+
+    arena_free_str(&self->arena, inner->node.keys[i]);
+    inner->node.keys[i] = dup;
+    inner->node.prefixes[i] = prefix;
+    return 0;
+}
+
+// Восстанавливает заполненность листа после удаления: занимает запись
+// у соседнего листа или сливается с ним.
+// Возвращает 1, если лист слился с соседом и родитель лишился ребёнка.
+static int bptree_leaf_rebalance(bptree_t *self, bptree_inner_t *parent, const size_t c,
+                                 bptree_leaf_t *leaf) {
+    bptree_leaf_t *left = c > 0 ? BPTREE_LEAF(parent->children[c - 1]) : NULL;
+    bptree_leaf_t *right = c < parent->node.n ? BPTREE_LEAF(parent->children[c + 1]) : NULL;
+
+    // Если копию разделителя не удалось выделить, лист остаётся
+    // неполным: поиск по такому дереву остаётся верным.
+    if (left && left->node.n > BPTREE_MIN_KEYS) {
+        const size_t last = left->node.n - 1;
+        if (bptree_replace_sep(self, parent, c - 1, left->node.prefixes[last], left->node.keys[last]))
+            return 0;
+        bptree_leaf_insert_at(leaf, 0, left->node.prefixes[last], left->node.keys[last],
+                              left->values[last]);
+        left->node.n--;
+        return 0;
+    }
+
+    if (right && right->node.n > BPTREE_MIN_KEYS) {
+        if (bptree_replace_sep(self, parent, c, right->node.prefixes[1], right->node.keys[1]))
+            return 0;
+        bptree_leaf_insert_at(leaf, leaf->node.n, right->node.prefixes[0], right->node.keys[0],
+                              right->values[0]);
+        bptree_leaf_remove_at(right, 0);
+        return 0;
+    }
+
+    // Слияние с соседом: правый лист дописывается в левый.
+    size_t sep;
+    if (left) {
+        sep = c - 1;
+        right = leaf;
+    } else if (right) {
+        sep = c;
+        left = leaf;
+    } else {
+        return 0;
+    }
+
+    const size_t ln = left->node.n, rn = right->node.n;
+    memcpy(&left->node.prefixes[ln], right->node.prefixes, rn * sizeof(uint64_t));
+    memcpy(&left->node.keys[ln], right->node.keys, rn * sizeof(mut_mkey_t));
+    memcpy(&left->values[ln], right->values, rn * sizeof(mval_t));
+    left->node.n = ln + rn;
+
+    left->next = right->next;
+    if (right->next)
+        right->next->prev = left;
+    bptree_leaf_free(self, right);
+
+    arena_free_str(&self->arena, parent->node.keys[sep]);
+    bptree_inner_remove_at(parent, sep);
+    return 1;
+}
+
+// Восстанавливает заполненность внутреннего узла: поворотом через
+// разделитель родителя занимает ребёнка у соседа или сливается с ним.
+// Возвращает 1, если узел слился с соседом и родитель лишился ребёнка.
+static int bptree_inner_rebalance(bptree_t *self, bptree_inner_t *parent, const size_t c,
+                                  bptree_inner_t *inner) {
+    bptree_inner_t *left = c > 0 ? BPTREE_INNER(parent->children[c - 1]) : NULL;
+    bptree_inner_t *right = c < parent->node.n ? BPTREE_INNER(parent->children[c + 1]) : NULL;
+
+    if (left && left->node.n > BPTREE_MIN_KEYS) {
+        const size_t last = left->node.n - 1;
+        memmove(&inner->children[1], &inner->children[0], (inner->node.n + 1) * sizeof(bptree_node_t *));
+        bptree_keys_shift(&inner->node, 0, 1);
+        inner->node.prefixes[0] = parent->node.prefixes[c - 1];
+        inner->node.keys[0] = parent->node.keys[c - 1];
+        inner->children[0] = left->children[last + 1];
+        inner->node.n++;
+
+        parent->node.prefixes[c - 1] = left->node.prefixes[last];
+        parent->node.keys[c - 1] = left->node.keys[last];
+        left->node.n--;
+        return 0;
+    }
+
+    if (right && right->node.n > BPTREE_MIN_KEYS) {
+        const size_t n = inner->node.n;
+        inner->node.prefixes[n] = parent->node.prefixes[c];
+        inner->node.keys[n] = parent->node.keys[c];
+        inner->children[n + 1] = right->children[0];
+        inner->node.n++;
+
+        parent->node.prefixes[c] = right->node.prefixes[0];
+        parent->node.keys[c] = right->node.keys[0];
+        memmove(&right->children[0], &right->children[1], right->node.n * sizeof(bptree_node_t *));
+        bptree_keys_shift(&right->node, 1, -1);
+        right->node.n--;
+        return 0;
+    }
+
+    // Слияние с соседом: разделитель родителя опускается между ключами
+    // левого и правого узлов.
+    size_t sep;
+    if (left) {
+        sep = c - 1;
+        right = inner;
+    } else if (right) {
+        sep = c;
+        left = inner;
+    } else {
+        return 0;
+    }
+
+    const size_t ln = left->node.n, rn = right->node.n;
+    left->node.prefixes[ln] = parent->node.prefixes[sep];
+    left->node.keys[ln] = parent->node.keys[sep];
+    memcpy(&left->node.prefixes[ln + 1], right->node.prefixes, rn * sizeof(uint64_t));
+    memcpy(&left->node.keys[ln + 1], right->node.keys, rn * sizeof(mut_mkey_t));
+    memcpy(&left->children[ln + 1], right->children, (rn + 1) * sizeof(bptree_node_t *));
+    left->node.n = ln + 1 + rn;
+    bptree_inner_free(self, right);
+
+    bptree_inner_remove_at(parent, sep);
+    return 1;
+}
+
+int bptree_remove_n(void *_self, const char *key, const size_t len) {
+    bptree_t *self = _self;
+
+    const uint64_t prefix = str_prefix(key, len);
+    bptree_path_t path;
+    bptree_leaf_t *leaf = bptree_descend(self, &path, prefix, key, len);
+
+    int found;
+    const size_t pos = bptree_search(&leaf->node, prefix, key, len, &found);
+    if (!found)
+        return 0;
+
+    // Разделители, равные удалённому ключу, остаются: они по-прежнему
+    // разделяют ключи левого и правого поддеревьев.
+    arena_free_str(&self->arena, leaf->node.keys[pos]);
+    bptree_leaf_remove_at(leaf, pos);
+    self->count--;
+
+    bptree_node_t *node = &leaf->node;
+    for (int d = path.len - 1; d >= 0 && node->n < BPTREE_MIN_KEYS; d--) {
+        bptree_inner_t *parent = path.nodes[d];
+        const size_t c = path.idx[d];
+
+        const int merged = node->leaf
+            ? bptree_leaf_rebalance(self, parent, c, BPTREE_LEAF(node))
+            : bptree_inner_rebalance(self, parent, c, BPTREE_INNER(node));
+        if (!merged)
+            break;
+        node = &parent->node;
+    }
+
+    // Корень без разделителей заменяется единственным ребёнком.
+    if (!self->root->leaf && self->root->n == 0) {
+        bptree_inner_t *root = BPTREE_INNER(self->root);
+        self->root = root->children[0];
+        bptree_inner_free(self, root);
+        self->height--;
+    }
+
+    return 1;
+}
+
+// Курсор хранит текущий лист (it->node) и номер записи в нём (it->pos).
+// Соседние записи находятся по списку листов без обращения к внутренним
+// узлам. Пустые листы пропускаются: они остаются, только если при
+// удалении не удалось выделить память.
+static int bptree_iter_load(map_iter_t *it) {
+    const bptree_leaf_t *leaf = it->node;
+    if (leaf == NULL) {
+        it->key = NULL;
+        it->value = 0;
+        return 0;
+    }
+
+    it->key = leaf->node.keys[it->pos];
+    it->value = leaf->values[it->pos];
+    return 1;
+}
+
+// Ставит курсор на запись pos листа leaf или, если её нет, на первую
+// запись следующих листов.
+static int bptree_iter_forward(map_iter_t *it, const bptree_leaf_t *leaf, size_t pos) {
+    while (leaf != NULL && pos >= leaf->node.n) {
+        leaf = leaf->next;
+        pos = 0;
+    }
+    it->node = leaf;
+    it->pos = pos;
+    return bptree_iter_load(it);
+}
+
+// Ставит курсор на последнюю запись листа leaf или предыдущих листов.
+static int bptree_iter_backward(map_iter_t *it, const bptree_leaf_t *leaf) {
+    while (leaf != NULL && leaf->node.n == 0)
+        leaf = leaf->prev;
+    it->node = leaf;
+    it->pos = leaf ? leaf->node.n - 1 : 0;
+    return bptree_iter_load(it);
+}
+
+// Крайний левый (right = 0) или крайний правый (right = 1) лист.
+static const bptree_leaf_t *bptree_edge_leaf(const bptree_t *self, const int right) {
+    const bptree_node_t *node = self->root;
+    while (!node->leaf)
+        node = BPTREE_INNER(node)->children[right ? node->n : 0];
+    return BPTREE_LEAF(node);
+}
+
+int bptree_iter_seek(map_iter_t *it, const char *key, const size_t len) {
+    const bptree_t *self = it->map;
+
+    const uint64_t prefix = str_prefix(key, len);
+    const bptree_leaf_t *leaf = bptree_descend(self, NULL, prefix, key, len);
+
+    int found;
+    const size_t pos = bptree_search(&leaf->node, prefix, key, len, &found);
+    return bptree_iter_forward(it, leaf, pos);
+}
+
+int bptree_iter_next(map_iter_t *it) {
+    if (it->key == NULL)
+        return bptree_iter_forward(it, bptree_edge_leaf(it->map, 0), 0);
+    return bptree_iter_forward(it, it->node, it->pos + 1);
+}
+
+int bptree_iter_prev(map_iter_t *it) {
+    if (it->key == NULL)
+        return bptree_iter_backward(it, bptree_edge_leaf(it->map, 1));
+
+    const bptree_leaf_t *leaf = it->node;
+    if (it->pos > 0) {
+        it->pos--;
+        return bptree_iter_load(it);
+    }
+    return bptree_iter_backward(it, leaf->prev);
+}
+
+bptree_stats_t bptree_stats(const void *_self) {
+    const bptree_t *self = _self;
+    assert(*(const imap_t *const *) _self == &BPlusTreeClass);
+
+    return (bptree_stats_t){
+        .count      = self->count,
+        .height     = self->height,
+        .leaves     = self->nleaves,
+        .inners     = self->ninners,
+        .node_bytes = self->nleaves * sizeof(bptree_leaf_t) + self->ninners * sizeof(bptree_inner_t),
+    };
+}
+
+const imap_t BPlusTreeClass = {
+    .size      = sizeof(bptree_t),
+    .ctor      = bptree_ctor,
+    .dtor      = bptree_dtor,
+    .insert_n  = bptree_insert_n,
+    .lookup_n  = bptree_lookup_n,
+    .remove_n  = bptree_remove_n,
+    .iter_seek = bptree_iter_seek,
+    .iter_next = bptree_iter_next,
+    .iter_prev = bptree_iter_prev,
+};
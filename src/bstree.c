@@ -1,11 +1,20 @@
 #include "bstree.h"
 
 #include <assert.h>
+#include <stdint.h>
 #include <stdlib.h>
 
+#include "arena.h"
 #include "err.h"
 
+// Упорядоченные ключи вставляются слиянием с перестроением дерева, если
+// их не меньше 1/BSTREE_MERGE_RATIO от количества записей (см. avltree.c).
+#define BSTREE_MERGE_RATIO 16
+
+// Рядом с указателем на ключ хранится префикс ключа (str_prefix), поэтому
+// сравнение на очередном уровне обычно не обращается к байтам ключа.
 typedef struct {
+    uint64_t   prefix;
     mut_mkey_t key;
     mval_t     value;
 } pair_t;
@@ -20,8 +29,12 @@ struct bstree_node {
 };
 
 typedef struct {
-    const imap_t *class;
+    const imap_t  *class;
     bstree_node_t *root;
+    size_t         count;
+
+    // Арена для ключей узлов.
+    arena_t        arena;
 } bstree_t;
 
 _Static_assert(offsetof(bstree_t, class) == 0);
@@ -29,15 +42,26 @@ _Static_assert(offsetof(bstree_t, class) == 0);
 void *bstree_ctor(void *_class, va_list *ap) {
     bstree_t *bst = _class;
     bst->root = NULL;
+    bst->count = 0;
+    arena_init(&bst->arena);
     return bst;
 }
 
+// Освобождает узлы поддерева без рекурсии: левые ветви поворотами
+// переносятся направо, после чего узлы освобождаются по правой цепочке.
+// Глубина дерева не ограничена, поэтому рекурсия могла бы переполнить стек.
 void bstree_node_destroy(bstree_node_t *node) {
-    if (node != NULL) {
-        bstree_node_destroy(node->left);
-        bstree_node_destroy(node->right);
-        free(node->data.key);
-        free(node);
+    while (node != NULL) {
+        if (node->left != NULL) {
+            bstree_node_t *left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        } else {
+            bstree_node_t *next = node->right;
+            free(node);
+            node = next;
+        }
     }
 }
 
@@ -45,136 +69,108 @@ void bstree_destroy(void *_self) {
     bstree_t *self = _self;
     bstree_node_destroy(self->root);
     self->root = NULL;
+    self->count = 0;
+    // Ключи всех узлов освобождаются разом.
+    arena_destroy(&self->arena);
 }
 
-bstree_node_t *bstree_node_create(const mkey_t key, const mval_t value) {
+bstree_node_t *bstree_node_create(arena_t *arena, const char *key, const size_t len, const mval_t value) {
+    mut_mkey_t dup = arena_strndup(arena, key, len);
+    if (dup == NULL)
+        return ERR_PTR(-ENOMEM);
+
     bstree_node_t *node = malloc(sizeof(bstree_node_t));
-    if (node == NULL)
+    if (node == NULL) {
+        arena_free_str(arena, dup);
         return ERR_PTR(-ENOMEM);
+    }
 
     node->left = NULL;
     node->right = NULL;
-    node->data = (pair_t){ strdup(key), value };
+    node->data = (pair_t){ str_prefix(dup, len), dup, value };
 
     return node;
 }
 
-static bstree_node_t *bstree_node_insert(bstree_node_t *node, const mkey_t key, const mval_t value) {
+// Спускается от корня к ключу. Возвращает адрес указателя на узел
+// с ключом (корня или ветви родителя) или на пустую ветвь, где узел
+// с ключом должен находиться.
+static bstree_node_t **bstree_descend(bstree_t *self, const char *key, const size_t len) {
     assert(key);
 
-    // Если корня нет, то новый узел становится корнем.
-    if (node == NULL) {
-        bstree_node_t *new_root = bstree_node_create(key, value);
-        if (IS_ERR(new_root))
-            return ERR_CAST(new_root);
-        return new_root;
+    const uint64_t prefix = str_prefix(key, len);
+    bstree_node_t **link = &self->root;
+    while (*link != NULL) {
+        const int cmp = strzp_cmp(prefix, key, len, (*link)->data.prefix, (*link)->data.key);
+        if (cmp == 0)
+            break;
+        link = cmp < 0 ? &(*link)->left : &(*link)->right;
     }
-
-    const int cmp = strcmp(key, node->data.key);
-    if (cmp < 0)
-        node->left = bstree_node_insert(node->left, key, value);
-    else if (cmp > 0)
-        node->right = bstree_node_insert(node->right, key, value);
-    else
-        node->data.value = value;
-
-    return node;
+    return link;
 }
 
-void bstree_insert(void *_self, const mkey_t key, const mval_t value) {
+void bstree_insert_n(void *_self, const char *key, const size_t len, const mval_t value) {
     bstree_t *self = _self;
-    self->root = bstree_node_insert(self->root, key, value);
-}
-
-static bstree_node_t *bstree_node_lookup(bstree_node_t *node, const char *key) {
-    assert(key);
-
-    if (node == NULL)
-        return NULL;
-
-    const int cmp = strcmp(key, node->data.key);
-    if (cmp < 0)
-        return bstree_node_lookup(node->left, key);
-    if (cmp > 0)
-        return bstree_node_lookup(node->right, key);
-
-    return node;
-}
-
-static bstree_node_t *bstree_min_node(bstree_node_t *self) {
-    if (self == NULL)
-        return NULL;
 
-    while (self->left != NULL)
-        self = self->left;
+    bstree_node_t **link = bstree_descend(self, key, len);
+    if (*link != NULL) {
+        (*link)->data.value = value;
+        return;
+    }
 
-    return self;
+    bstree_node_t *node = bstree_node_create(&self->arena, key, len, value);
+    if (IS_ERR(node))
+        return;
+    *link = node;
+    self->count++;
 }
 
-map_res_t bstree_lookup(const void *_self, const mkey_t key) {
+map_res_t bstree_lookup_n(const void *_self, const char *key, const size_t len) {
     const bstree_t *self = _self;
+    assert(key);
 
-    const bstree_node_t *found = bstree_node_lookup(self->root, key);
-    if (found == NULL)
-        return (map_res_t){0};
+    const uint64_t prefix = str_prefix(key, len);
+    const bstree_node_t *node = self->root;
+    while (node != NULL) {
+        const int cmp = strzp_cmp(prefix, key, len, node->data.prefix, node->data.key);
+        if (cmp == 0) {
+            return (map_res_t){
+                .data = node->data.value,
+                .ok   = 1,
+            };
+        }
+        node = cmp < 0 ? node->left : node->right;
+    }
 
-    return (map_res_t){
-        .data = found->data.value,
-        .ok   = 1,
-    };
+    return (map_res_t){0};
 }
 
-static bstree_node_t *bstree_node_remove(bstree_node_t *node, const char *key) {
-    if (node == NULL)
-        return NULL;
-
-    const int cmp = strcmp(key, node->data.key);
-    if (cmp < 0) {
-        node->left = bstree_node_remove(node->left, key);
-        return node;
-    }
-    if (cmp > 0) {
-        node->right = bstree_node_remove(node->right, key);
-        return node;
-    }
+int bstree_remove_n(void *_self, const char *key, const size_t len) {
+    bstree_t *self = _self;
 
-    // cmp == 0
+    bstree_node_t **link = bstree_descend(self, key, len);
+    bstree_node_t *node = *link;
+    if (node == NULL)
+        return 0;
 
-    if (node->left == NULL && node->right == NULL) {
-        free(node->data.key);
-        free(node);
-        return NULL;
-    }
+    arena_free_str(&self->arena, node->data.key);
+    self->count--;
 
-    // One branch: right
+    // No branches or one branch: the node is replaced by its only branch.
     //  1             3
     //   \           / \
     //    3    ->   2   4
     //   / \
     //  2   4
-
-    if (node->left == NULL) {
-        bstree_node_t *next = node->right;
-        free(node->data.key);
+    if (node->left == NULL || node->right == NULL) {
+        *link = node->left != NULL ? node->left : node->right;
         free(node);
-        return next;
+        return 1;
     }
 
-    // One branch: left
-    //      4         2
-    //     /         / \
-    //    2    ->   1   3
-    //   / \
-    //  1   3
-
-    if (node->right == NULL) {
-        bstree_node_t *next = node->left;
-        free(node->data.key);
-        free(node);
-        return next;
-    }
-
-    // Both branches
+    // Both branches: the payload of the min node in the right branch
+    // is moved into the node without copying the key, and the min node,
+    // which has no left branch, is replaced by its right branch.
     //      3              4             4
     //     / \            / \           / \
     //    2   5    ->    2   5    ->   2   5
@@ -183,31 +179,227 @@ static bstree_node_t *bstree_node_remove(bstree_node_t *node, const char *key) {
     //      ^
     //  min in the
     //  right branch
+    bstree_node_t **min_link = &node->right;
+    while ((*min_link)->left != NULL)
+        min_link = &(*min_link)->left;
+
+    bstree_node_t *min = *min_link;
+    node->data = min->data;
+    *min_link = min->right;
+    free(min);
+
+    return 1;
+}
 
-    const bstree_node_t *min = bstree_min_node(node->right);
-    free(node->data.key);
-    node->data.key = strdup(min->data.key);
-    node->data.value = min->data.value;
-    node->right = bstree_node_remove(node->right, min->data.key);
+// Строит идеально сбалансированное дерево из n узлов out, упорядоченных
+// по ключам. Глубина рекурсии - log2(n).
+static bstree_node_t *bstree_build(bstree_node_t **out, const size_t n) {
+    if (n == 0)
+        return NULL;
+
+    const size_t mid = n / 2;
+    bstree_node_t *node = out[mid];
+    node->left = bstree_build(out, mid);
+    node->right = bstree_build(out + mid + 1, n - mid - 1);
     return node;
 }
 
-int bstree_remove(void *_self, const mkey_t key) {
+int bstree_insert_sorted(void *_self, const mkey_t *keys, const mval_t *values, const size_t n) {
     bstree_t *self = _self;
 
-    if (bstree_lookup(_self, key).ok == 0)
+    if (n == 0)
         return 0;
 
-    self->root = bstree_node_remove(self->root, key);
+    if (n < self->count / BSTREE_MERGE_RATIO) {
+        for (size_t i = 0; i < n; i++)
+            bstree_insert_n(self, keys[i], strlen(keys[i]), values[i]);
+        return 0;
+    }
+
+    if (self->count > SIZE_MAX / sizeof(bstree_node_t *) - n)
+        return ENOMEM;
+    bstree_node_t **out = malloc((self->count + n) * sizeof(bstree_node_t *));
+    if (out == NULL)
+        return ENOMEM;
+
+    // Узлы дерева по порядку ключей выписываются в конец out без стека:
+    // левые ветви поворотами переносятся направо, как в bstree_node_destroy.
+    bstree_node_t **old = out + n;
+    size_t count = 0;
+    for (bstree_node_t *node = self->root; node != NULL;) {
+        if (node->left != NULL) {
+            bstree_node_t *left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        } else {
+            old[count++] = node;
+            node = node->right;
+        }
+    }
+    assert(count == self->count);
+
+    // Слияние записей дерева с ключами пишет в начало out. Новых узлов
+    // записано меньше n, поэтому запись не обгоняет чтение из old.
+    size_t m = 0, e = 0;
+    int err = 0;
+    for (size_t i = 0; i < n && err == 0; i++) {
+        const size_t len = strlen(keys[i]);
+        const uint64_t prefix = str_prefix(keys[i], len);
+
+        int cmp = 1;
+        while (e < count
+               && (cmp = strzp_cmp(prefix, keys[i], len, old[e]->data.prefix, old[e]->data.key)) > 0)
+            out[m++] = old[e++];
+        if (e < count && cmp == 0) {
+            old[e]->data.value = values[i]; // обновляем существующее значение
+            out[m++] = old[e++];
+            continue;
+        }
+
+        bstree_node_t *node = bstree_node_create(&self->arena, keys[i], len, values[i]);
+        if (IS_ERR(node)) {
+            err = ENOMEM;
+            break;
+        }
+        out[m++] = node;
+    }
+    while (e < count)
+        out[m++] = old[e++];
+
+    self->root = bstree_build(out, m);
+    self->count = m;
+    free(out);
+    return err;
+}
+
+// Курсор хранит путь от корня, текущий узел - it->path[it->depth - 1].
+// Глубина дерева не ограничена: если путь не помещается в курсор,
+// it->depth равен -1, текущий узел - it->node, а соседний ключ ищется
+// спуском от корня.
+
+// Что ищет bstree_iter_find: первый ключ, не меньший данного, первый
+// больший или последний меньший. Ключ NULL меньше (BSTREE_ITER_GE)
+// или больше (BSTREE_ITER_LT) любого ключа.
+enum {
+    BSTREE_ITER_GE,
+    BSTREE_ITER_GT,
+    BSTREE_ITER_LT,
+};
+
+static int bstree_iter_load(map_iter_t *it) {
+    const bstree_node_t *node = it->depth > 0 ? it->path[it->depth - 1]
+                              : it->depth < 0 ? it->node : NULL;
+    if (node == NULL) {
+        it->depth = 0;
+        it->key = NULL;
+        it->value = 0;
+        return 0;
+    }
 
+    it->key = node->data.key;
+    it->value = node->data.value;
     return 1;
 }
 
+static int bstree_iter_find(map_iter_t *it, const char *key, const size_t len, const int mode) {
+    const bstree_t *self = it->map;
+
+    const uint64_t prefix = key ? str_prefix(key, len) : 0;
+    const bstree_node_t *found = NULL;
+    int depth = 0;
+    it->depth = 0;
+    for (const bstree_node_t *node = self->root; node != NULL;) {
+        if (it->depth >= 0)
+            it->depth = it->depth < MAP_ITER_DEPTH ? it->depth + 1 : -1;
+        if (it->depth > 0)
+            it->path[it->depth - 1] = node;
+
+        const int cmp = key ? strzp_cmp(prefix, key, len, node->data.prefix, node->data.key)
+                            : mode == BSTREE_ITER_LT ? 1 : -1;
+        const int match = mode == BSTREE_ITER_LT ? cmp > 0
+                        : mode == BSTREE_ITER_GT ? cmp < 0 : cmp <= 0;
+        if (match) {
+            found = node;
+            depth = it->depth;
+            if (cmp == 0)
+                break;
+        }
+        // Подходящий узел ищется среди меньших ключей для GE и GT,
+        // среди больших - для LT.
+        node = match == (mode != BSTREE_ITER_LT) ? node->left : node->right;
+    }
+    it->depth = depth;
+    it->node = found;
+
+    return bstree_iter_load(it);
+}
+
+// Дописывает в путь спуск от node до крайнего левого (right = 0)
+// или крайнего правого (right = 1) узла поддерева.
+// Возвращает 0, если путь не поместился в курсор.
+static int bstree_iter_descend(map_iter_t *it, const bstree_node_t *node, const int right) {
+    for (; node != NULL; node = right ? node->right : node->left) {
+        if (it->depth == MAP_ITER_DEPTH)
+            return 0;
+        it->path[it->depth++] = node;
+    }
+    return 1;
+}
+
+// Поднимается по пути, пока пройденный узел - правый (right = 1)
+// или левый (right = 0) ребёнок следующего узла пути.
+static void bstree_iter_ascend(map_iter_t *it, const int right) {
+    const bstree_node_t *child, *parent;
+    do {
+        child = it->path[--it->depth];
+        parent = it->depth > 0 ? it->path[it->depth - 1] : NULL;
+    } while (parent != NULL && (right ? parent->right : parent->left) == child);
+}
+
+int bstree_iter_seek(map_iter_t *it, const char *key, const size_t len) {
+    return bstree_iter_find(it, key, len, BSTREE_ITER_GE);
+}
+
+int bstree_iter_next(map_iter_t *it) {
+    if (it->key == NULL)
+        return bstree_iter_find(it, NULL, 0, BSTREE_ITER_GE);
+    if (it->depth < 0)
+        return bstree_iter_find(it, it->key, strlen(it->key), BSTREE_ITER_GT);
+
+    const bstree_node_t *node = it->path[it->depth - 1];
+    if (node->right == NULL)
+        bstree_iter_ascend(it, 1);
+    else if (!bstree_iter_descend(it, node->right, 0))
+        return bstree_iter_find(it, it->key, strlen(it->key), BSTREE_ITER_GT);
+
+    return bstree_iter_load(it);
+}
+
+int bstree_iter_prev(map_iter_t *it) {
+    if (it->key == NULL)
+        return bstree_iter_find(it, NULL, 0, BSTREE_ITER_LT);
+    if (it->depth < 0)
+        return bstree_iter_find(it, it->key, strlen(it->key), BSTREE_ITER_LT);
+
+    const bstree_node_t *node = it->path[it->depth - 1];
+    if (node->left == NULL)
+        bstree_iter_ascend(it, 0);
+    else if (!bstree_iter_descend(it, node->left, 1))
+        return bstree_iter_find(it, it->key, strlen(it->key), BSTREE_ITER_LT);
+
+    return bstree_iter_load(it);
+}
+
 const imap_t BinarySearchTreeClass = {
     .size   = sizeof(bstree_t),
     .ctor   = bstree_ctor,
     .dtor   = bstree_destroy,
-    .insert = bstree_insert,
-    .lookup = bstree_lookup,
-    .remove = bstree_remove,
+    .insert_n = bstree_insert_n,
+    .lookup_n = bstree_lookup_n,
+    .remove_n = bstree_remove_n,
+    .insert_sorted = bstree_insert_sorted,
+    .iter_seek = bstree_iter_seek,
+    .iter_next = bstree_iter_next,
+    .iter_prev = bstree_iter_prev,
 };
@@ -0,0 +1,619 @@
+#include "cuckoomap.h"
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "arena.h"
+#include "err.h"
+#include "hash.h"
+
+
+#define CUCKOOMAP_BUCKET_SIZE 4
+#define CUCKOOMAP_INITIAL_BUCKETS 4
+#define CUCKOOMAP_CACHE_LINE 64
+// Максимальная доля занятых мест: 95/100.
+#define CUCKOOMAP_MAX_LOAD_NUM 95
+#define CUCKOOMAP_MAX_LOAD_DEN 100
+// Размер списка переполнения, при заполнении которого таблица
+// перестраивается с новыми зёрнами или растёт. Сверх него в список
+// попадают записи, которым не нашлось места и после перестроения таблицы,
+// например ключи, хэши которых совпадают при любом зерне.
+#define CUCKOOMAP_STASH_SIZE 4
+// Количество попыток перестроить таблицу с новыми зёрнами.
+#define CUCKOOMAP_MAX_RESEEDS 4
+// Максимальное количество бакетов, просматриваемых поиском в ширину.
+#define CUCKOOMAP_BFS_MAX 512
+
+
+// Бакет занимает ровно одну кэш-линию. Пустое место имеет key == NULL.
+typedef struct {
+    // Хэши ключей с первым зерном, позволяют отбросить несовпадающий
+    // ключ без сравнения строк. Запись хранит хэш с первым зерном
+    // в любом из двух своих бакетов.
+    hash_t     hashes[CUCKOOMAP_BUCKET_SIZE];
+    mval_t     vals[CUCKOOMAP_BUCKET_SIZE];
+    mut_mkey_t keys[CUCKOOMAP_BUCKET_SIZE];
+} cuckoomap_bucket_t;
+
+_Static_assert(sizeof(cuckoomap_bucket_t) <= CUCKOOMAP_CACHE_LINE);
+
+// Запись списка переполнения.
+typedef struct {
+    hash_t     hash;
+    mval_t     value;
+    mut_mkey_t key;
+} cuckoomap_entry_t;
+
+typedef struct {
+    // Реализация интерфейса imap_t.
+    const imap_t *class;
+
+    // Массив бакетов количеством nbuckets, выровненный по кэш-линии.
+    cuckoomap_bucket_t *buckets;
+
+    // Количество бакетов, степень двойки.
+    size_t nbuckets;
+
+    // Количество записей, включая список переполнения.
+    size_t count;
+
+    // Список переполнения: массив записей, для которых не нашлось места
+    // ни в одном из двух бакетов, вместимостью stash_cap. Просматривается
+    // при каждом поиске, пока не пуст.
+    cuckoomap_entry_t *stash;
+    size_t nstash;
+    size_t stash_cap;
+
+    // Количество невставленных записей (см. cuckoomap_stats_t).
+    size_t dropped;
+
+    // Хэш-функция.
+    hash_func_t hash;
+
+    // Зёрна хэш-функции для первого и второго бакета.
+    // Генерируются случайно при создании мапы.
+    hash_t seeds[2];
+
+    // Арена для ключей.
+    arena_t arena;
+} cuckoomap_t;
+
+// Необходимо для валидной реализации интерфейса.
+_Static_assert(offsetof(cuckoomap_t, class) == 0);
+
+
+// Хэш ключа с i-ым зерном. Хэш дополнительно перемешивается (hash_mix):
+// у простых хэш-функций, например djb2, хэши с разными зёрнами отличаются
+// на величину, зависящую только от длины ключа, и без перемешивания
+// ключи с общим первым бакетом имели бы и общий второй.
+static inline hash_t cuckoomap_hash(const cuckoomap_t *self, const int i,
+                                    const char *key, const size_t len) {
+    return hash_mix(self->hash(self->seeds[i], key, len));
+}
+
+static inline size_t cuckoomap_index(const cuckoomap_t *self, const hash_t hash) {
+    return hash & (self->nbuckets - 1);
+}
+
+// Номер места бакета с ключом key или -1.
+static inline int cuckoomap_bucket_find(const cuckoomap_bucket_t *bucket, const hash_t hash,
+                                        const char *key, const size_t len) {
+    for (int i = 0; i < CUCKOOMAP_BUCKET_SIZE; i++) {
+        if (bucket->keys[i] != NULL && bucket->hashes[i] == hash && STRZ_EQ(bucket->keys[i], key, len))
+            return i;
+    }
+    return -1;
+}
+
+// Номер свободного места бакета или -1.
+static inline int cuckoomap_bucket_free_slot(const cuckoomap_bucket_t *bucket) {
+    for (int i = 0; i < CUCKOOMAP_BUCKET_SIZE; i++) {
+        if (bucket->keys[i] == NULL)
+            return i;
+    }
+    return -1;
+}
+
+static inline void cuckoomap_bucket_put(cuckoomap_bucket_t *bucket, const int slot,
+                                        const cuckoomap_entry_t *entry) {
+    bucket->hashes[slot] = entry->hash;
+    bucket->vals[slot] = entry->value;
+    bucket->keys[slot] = entry->key;
+}
+
+// Номер второго бакета записи, хранящейся в бакете b.
+// Если запись лежит в первом бакете, второй хэш вычисляется заново.
+static size_t cuckoomap_alt(const cuckoomap_t *self, const size_t b, const int slot) {
+    const cuckoomap_bucket_t *bucket = &self->buckets[b];
+    const size_t first = cuckoomap_index(self, bucket->hashes[slot]);
+    if (first != b)
+        return first;
+
+    const char *key = bucket->keys[slot];
+    return cuckoomap_index(self, cuckoomap_hash(self, 1, key, strlen(key)));
+}
+
+static int cuckoomap_alloc(cuckoomap_t *self, const size_t nbuckets) {
+    const size_t size = nbuckets * sizeof(cuckoomap_bucket_t);
+    cuckoomap_bucket_t *buckets = aligned_alloc(CUCKOOMAP_CACHE_LINE, size);
+    if (buckets == NULL)
+        return ENOMEM;
+    memset(buckets, 0, size);
+
+    self->buckets = buckets;
+    self->nbuckets = nbuckets;
+
+    return 0;
+}
+
+// Добавляет запись в список переполнения, при необходимости удваивая его.
+// Возвращает 0 или ENOMEM.
+static int cuckoomap_stash_push(cuckoomap_t *self, const cuckoomap_entry_t *entry) {
+    if (self->nstash == self->stash_cap) {
+        const size_t cap = self->stash_cap ? self->stash_cap * 2 : CUCKOOMAP_STASH_SIZE;
+        cuckoomap_entry_t *stash = realloc(self->stash, cap * sizeof(cuckoomap_entry_t));
+        if (stash == NULL)
+            return ENOMEM;
+        self->stash = stash;
+        self->stash_cap = cap;
+    }
+
+    self->stash[self->nstash++] = *entry;
+    return 0;
+}
+
+// Выбирает новые случайные зёрна.
+static void cuckoomap_seed(cuckoomap_t *self) {
+    self->seeds[0] = rand();
+    do {
+        self->seeds[1] = rand();
+    } while (self->seeds[1] == self->seeds[0]);
+}
+
+void *cuckoomap_ctor(void *_self, va_list *ap) {
+    cuckoomap_t *self = _self;
+
+    if (cuckoomap_alloc(self, CUCKOOMAP_INITIAL_BUCKETS) != 0)
+        return ERR_PTR(-ENOMEM);
+    self->stash = NULL;
+    self->nstash = 0;
+    self->stash_cap = 0;
+    self->count = 0;
+    self->dropped = 0;
+
+    cuckoomap_seed(self);
+    self->hash = va_arg(*ap, hash_func_t);
+    assert(self->hash != NULL);
+
+    arena_init(&self->arena);
+
+    return self;
+}
+
+void cuckoomap_dtor(void *_self) {
+    cuckoomap_t *self = _self;
+
+    free(self->buckets);
+    self->buckets = NULL;
+    free(self->stash);
+    self->stash = NULL;
+
+    arena_destroy(&self->arena);
+}
+
+// Узел поиска в ширину: бакет и место в бакете родителя, запись из
+// которого переместится в этот бакет.
+typedef struct {
+    size_t bucket;
+    int    parent;
+    int    slot;
+} cuckoomap_bfs_node_t;
+
+// Перемещает записи вдоль пути от узла i поиска в ширину к корню.
+// Каждая запись переходит в свой альтернативный бакет, поэтому таблица
+// остаётся корректной после любого шага, и если путь устарел из-за
+// повторяющихся бакетов, перемещения прекращаются.
+// Возвращает номер корневого бакета, в котором освободилось место, или -1.
+static ptrdiff_t cuckoomap_apply_path(cuckoomap_t *self, const cuckoomap_bfs_node_t *queue, int i) {
+    while (queue[i].parent >= 0) {
+        const cuckoomap_bfs_node_t *node = &queue[i];
+        cuckoomap_bucket_t *src = &self->buckets[queue[node->parent].bucket];
+        cuckoomap_bucket_t *dst = &self->buckets[node->bucket];
+
+        const int free_slot = cuckoomap_bucket_free_slot(dst);
+        if (free_slot < 0
+            || src->keys[node->slot] == NULL
+            || cuckoomap_alt(self, queue[node->parent].bucket, node->slot) != node->bucket)
+            return -1;
+
+        dst->hashes[free_slot] = src->hashes[node->slot];
+        dst->vals[free_slot] = src->vals[node->slot];
+        dst->keys[free_slot] = src->keys[node->slot];
+        src->keys[node->slot] = NULL;
+
+        i = node->parent;
+    }
+
+    return (ptrdiff_t) queue[i].bucket;
+}
+
+// Освобождает место в одном из бакетов b1, b2, перемещая записи
+// по кратчайшей цепочке, найденной поиском в ширину.
+// Возвращает номер бакета со свободным местом или -1.
+static ptrdiff_t cuckoomap_make_room(cuckoomap_t *self, const size_t b1, const size_t b2) {
+    cuckoomap_bfs_node_t queue[CUCKOOMAP_BFS_MAX];
+    int head = 0, tail = 0;
+
+    queue[tail++] = (cuckoomap_bfs_node_t){ .bucket = b1, .parent = -1, .slot = -1 };
+    if (b2 != b1)
+        queue[tail++] = (cuckoomap_bfs_node_t){ .bucket = b2, .parent = -1, .slot = -1 };
+
+    while (head < tail) {
+        const int cur = head++;
+        const size_t b = queue[cur].bucket;
+
+        if (cuckoomap_bucket_free_slot(&self->buckets[b]) >= 0)
+            return cuckoomap_apply_path(self, queue, cur);
+
+        for (int slot = 0; slot < CUCKOOMAP_BUCKET_SIZE && tail < CUCKOOMAP_BFS_MAX; slot++) {
+            queue[tail++] = (cuckoomap_bfs_node_t){
+                .bucket = cuckoomap_alt(self, b, slot),
+                .parent = cur,
+                .slot   = slot,
+            };
+        }
+    }
+
+    return -1;
+}
+
+// Размещает запись, ключа которой нет в таблице, в одном из её бакетов
+// или в списке переполнения.
+// Возвращает 0 или ENOMEM, если места нет и таблица должна вырасти.
+static int cuckoomap_place(cuckoomap_t *self, const cuckoomap_entry_t *entry, const hash_t hash2) {
+    const size_t b1 = cuckoomap_index(self, entry->hash);
+    const size_t b2 = cuckoomap_index(self, hash2);
+
+    int slot = cuckoomap_bucket_free_slot(&self->buckets[b1]);
+    if (slot >= 0) {
+        cuckoomap_bucket_put(&self->buckets[b1], slot, entry);
+        return 0;
+    }
+
+    slot = cuckoomap_bucket_free_slot(&self->buckets[b2]);
+    if (slot >= 0) {
+        cuckoomap_bucket_put(&self->buckets[b2], slot, entry);
+        return 0;
+    }
+
+    const ptrdiff_t b = cuckoomap_make_room(self, b1, b2);
+    if (b >= 0) {
+        cuckoomap_bucket_t *bucket = &self->buckets[b];
+        cuckoomap_bucket_put(bucket, cuckoomap_bucket_free_slot(bucket), entry);
+        return 0;
+    }
+
+    if (self->nstash < CUCKOOMAP_STASH_SIZE)
+        return cuckoomap_stash_push(self, entry);
+
+    return ENOMEM;
+}
+
+// Размещает запись в бакетах или в списке переполнения сверх
+// CUCKOOMAP_STASH_SIZE.
+// Возвращает 0 или ENOMEM, если не хватило памяти на список переполнения.
+static int cuckoomap_place_any(cuckoomap_t *self, const cuckoomap_entry_t *entry, const hash_t hash2) {
+    if (cuckoomap_place(self, entry, hash2) == 0)
+        return 0;
+
+    return cuckoomap_stash_push(self, entry);
+}
+
+// Размещает запись старой таблицы, хэш которой с первым зерном old_seed0.
+// Хэши с первым зерном хранятся в записях и вычисляются заново, только
+// если зерно изменилось, второй хэш вычисляется заново.
+static int cuckoomap_replace(cuckoomap_t *self, cuckoomap_entry_t entry, const hash_t old_seed0) {
+    const size_t len = strlen(entry.key);
+    if (self->seeds[0] != old_seed0)
+        entry.hash = cuckoomap_hash(self, 0, entry.key, len);
+    return cuckoomap_place_any(self, &entry, cuckoomap_hash(self, 1, entry.key, len));
+}
+
+// Размещает в пустой таблице записи старых бакетов и списка переполнения.
+// Возвращает 1, если поместились все записи.
+static int cuckoomap_rehash(cuckoomap_t *self, const cuckoomap_bucket_t *old_buckets,
+                            const size_t old_nbuckets, const cuckoomap_entry_t *old_stash,
+                            const size_t old_nstash, const hash_t old_seed0) {
+    for (size_t b = 0; b < old_nbuckets; b++) {
+        const cuckoomap_bucket_t *bucket = &old_buckets[b];
+        for (int i = 0; i < CUCKOOMAP_BUCKET_SIZE; i++) {
+            if (bucket->keys[i] == NULL)
+                continue;
+            const cuckoomap_entry_t entry = {
+                .hash  = bucket->hashes[i],
+                .value = bucket->vals[i],
+                .key   = bucket->keys[i],
+            };
+            if (cuckoomap_replace(self, entry, old_seed0) != 0)
+                return 0;
+        }
+    }
+    for (size_t i = 0; i < old_nstash; i++) {
+        if (cuckoomap_replace(self, old_stash[i], old_seed0) != 0)
+            return 0;
+    }
+
+    return 1;
+}
+
+// Перестраивает таблицу под nbuckets бакетов. Если в списке переполнения
+// остаётся больше max_stash записей, таблица перестраивается заново
+// с новыми зёрнами, не более CUCKOOMAP_MAX_RESEEDS раз; при reseed новые
+// зёрна выбираются сразу. Если лучшего распределения не нашлось,
+// остаётся последнее, в котором поместились все записи.
+// Возвращает 0 или ENOMEM; тогда таблица не изменяется.
+static int cuckoomap_resize(cuckoomap_t *self, const size_t nbuckets, const int reseed,
+                            const size_t max_stash) {
+    cuckoomap_bucket_t *old_buckets = self->buckets;
+    const size_t old_nbuckets = self->nbuckets;
+    hash_t old_seeds[2] = {self->seeds[0], self->seeds[1]};
+    cuckoomap_entry_t *old_stash = self->stash;
+    const size_t old_nstash = self->nstash;
+    const size_t old_stash_cap = self->stash_cap;
+
+    if (cuckoomap_alloc(self, nbuckets) != 0)
+        return ENOMEM;
+    self->stash = NULL;
+    self->nstash = 0;
+    self->stash_cap = 0;
+
+    int placed = 0;
+    for (int attempt = 0; attempt <= CUCKOOMAP_MAX_RESEEDS; attempt++) {
+        if (attempt > 0) {
+            memset(self->buckets, 0, nbuckets * sizeof(cuckoomap_bucket_t));
+            self->nstash = 0;
+        }
+        if (attempt > 0 || reseed)
+            cuckoomap_seed(self);
+
+        placed = cuckoomap_rehash(self, old_buckets, old_nbuckets, old_stash, old_nstash, old_seeds[0]);
+        if (placed && self->nstash <= max_stash)
+            break;
+    }
+
+    if (!placed) {
+        free(self->buckets);
+        free(self->stash);
+        self->buckets = old_buckets;
+        self->nbuckets = old_nbuckets;
+        self->seeds[0] = old_seeds[0];
+        self->seeds[1] = old_seeds[1];
+        self->stash = old_stash;
+        self->nstash = old_nstash;
+        self->stash_cap = old_stash_cap;
+        return ENOMEM;
+    }
+
+    free(old_buckets);
+    free(old_stash);
+
+    return 0;
+}
+
+// Размер списка переполнения, который не должно превышать перестроение
+// таблицы при росте: не больше, чем до роста.
+static inline size_t cuckoomap_stash_limit(const cuckoomap_t *self) {
+    return self->nstash > CUCKOOMAP_STASH_SIZE ? self->nstash : CUCKOOMAP_STASH_SIZE;
+}
+
+// Размещает новую запись. Если ей нет места, таблица того же размера
+// перестраивается с новыми зёрнами, затем, если заполнена хотя бы
+// наполовину, удваивается. Рост из-за неудачного размещения ограничен:
+// запись, которой не нашлось места и после этого, попадает в список
+// переполнения сверх CUCKOOMAP_STASH_SIZE, который растёт без ограничений.
+// Возвращает 0 или ENOMEM, если не хватило памяти.
+static int cuckoomap_add(cuckoomap_t *self, cuckoomap_entry_t *entry, const size_t len,
+                         const hash_t hash2) {
+    if (cuckoomap_place(self, entry, hash2) == 0)
+        return 0;
+
+    // Пока список переполнения не превышает обычного размера, его записи
+    // могут быть следствием неудачных зёрен.
+    if (self->nstash <= CUCKOOMAP_STASH_SIZE
+        && cuckoomap_resize(self, self->nbuckets, 1, CUCKOOMAP_STASH_SIZE - 1) == 0) {
+        entry->hash = cuckoomap_hash(self, 0, entry->key, len);
+        if (cuckoomap_place(self, entry, cuckoomap_hash(self, 1, entry->key, len)) == 0)
+            return 0;
+    }
+
+    // Перестроение при росте тоже может сменить зёрна.
+    if (self->count * 2 >= self->nbuckets * CUCKOOMAP_BUCKET_SIZE
+        && cuckoomap_resize(self, self->nbuckets * 2, 0, cuckoomap_stash_limit(self)) == 0) {
+        entry->hash = cuckoomap_hash(self, 0, entry->key, len);
+        if (cuckoomap_place(self, entry, cuckoomap_hash(self, 1, entry->key, len)) == 0)
+            return 0;
+    }
+
+    return cuckoomap_place_any(self, entry, cuckoomap_hash(self, 1, entry->key, len));
+}
+
+// Переносит записи списка переполнения в бакеты, если в них появилось место.
+static void cuckoomap_unstash(cuckoomap_t *self) {
+    for (size_t i = 0; i < self->nstash;) {
+        const cuckoomap_entry_t *entry = &self->stash[i];
+        cuckoomap_bucket_t *b1 = &self->buckets[cuckoomap_index(self, entry->hash)];
+        cuckoomap_bucket_t *b2 = &self->buckets[
+            cuckoomap_index(self, cuckoomap_hash(self, 1, entry->key, strlen(entry->key)))];
+
+        cuckoomap_bucket_t *dst = b1;
+        int slot = cuckoomap_bucket_free_slot(b1);
+        if (slot < 0) {
+            dst = b2;
+            slot = cuckoomap_bucket_free_slot(b2);
+        }
+        if (slot < 0) {
+            i++;
+            continue;
+        }
+
+        cuckoomap_bucket_put(dst, slot, entry);
+        self->stash[i] = self->stash[--self->nstash];
+    }
+}
+
+int cuckoomap_reserve(void *_self, const size_t n) {
+    cuckoomap_t *self = _self;
+
+    // Наименьшее количество бакетов, при котором n записей не превышают 95%.
+    size_t nbuckets = self->nbuckets;
+    while (n * CUCKOOMAP_MAX_LOAD_DEN > nbuckets * CUCKOOMAP_BUCKET_SIZE * CUCKOOMAP_MAX_LOAD_NUM)
+        nbuckets *= 2;
+
+    if (nbuckets == self->nbuckets)
+        return 0;
+    return cuckoomap_resize(self, nbuckets, 0, cuckoomap_stash_limit(self));
+}
+
+// Место записи с ключом key: бакет и номер места в нём
+// либо номер записи в списке переполнения.
+typedef struct {
+    cuckoomap_bucket_t *bucket;
+    int                 slot;
+    ptrdiff_t           stash;
+} cuckoomap_pos_t;
+
+// Ищет ключ в двух его бакетах и в списке переполнения.
+// Возвращает 1 и место записи, если ключ найден, иначе 0.
+static int cuckoomap_find(const cuckoomap_t *self, const char *key, const size_t len,
+                          const hash_t hash1, const hash_t hash2, cuckoomap_pos_t *pos) {
+    cuckoomap_bucket_t *b1 = &self->buckets[cuckoomap_index(self, hash1)];
+    cuckoomap_bucket_t *b2 = &self->buckets[cuckoomap_index(self, hash2)];
+
+    // Промахи кэша по двум бакетам перекрываются.
+    __builtin_prefetch(b2, 0, 3);
+
+    int slot = cuckoomap_bucket_find(b1, hash1, key, len);
+    if (slot >= 0) {
+        *pos = (cuckoomap_pos_t){ .bucket = b1, .slot = slot, .stash = -1 };
+        return 1;
+    }
+
+    slot = cuckoomap_bucket_find(b2, hash1, key, len);
+    if (slot >= 0) {
+        *pos = (cuckoomap_pos_t){ .bucket = b2, .slot = slot, .stash = -1 };
+        return 1;
+    }
+
+    for (size_t i = 0; i < self->nstash; i++) {
+        const cuckoomap_entry_t *entry = &self->stash[i];
+        if (entry->hash == hash1 && STRZ_EQ(entry->key, key, len)) {
+            *pos = (cuckoomap_pos_t){ .bucket = NULL, .slot = -1, .stash = (ptrdiff_t) i };
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+void cuckoomap_insert_n(void *_self, const char *key, const size_t len, const mval_t value) {
+    cuckoomap_t *self = _self;
+
+    hash_t hash1 = cuckoomap_hash(self, 0, key, len);
+    hash_t hash2 = cuckoomap_hash(self, 1, key, len);
+
+    cuckoomap_pos_t pos;
+    if (cuckoomap_find(self, key, len, hash1, hash2, &pos)) {
+        // update existing value.
+        if (pos.bucket)
+            pos.bucket->vals[pos.slot] = value;
+        else
+            self->stash[pos.stash].value = value;
+        return;
+    }
+
+    if ((self->count + 1) * CUCKOOMAP_MAX_LOAD_DEN
+        > self->nbuckets * CUCKOOMAP_BUCKET_SIZE * CUCKOOMAP_MAX_LOAD_NUM) {
+        if (cuckoomap_resize(self, self->nbuckets * 2, 0, cuckoomap_stash_limit(self)) != 0) {
+            self->dropped++;
+            return;
+        }
+        // Перестроение могло сменить зёрна.
+        hash1 = cuckoomap_hash(self, 0, key, len);
+        hash2 = cuckoomap_hash(self, 1, key, len);
+    }
+
+    cuckoomap_entry_t entry = {
+        .hash  = hash1,
+        .value = value,
+        .key   = arena_strndup(&self->arena, key, len),
+    };
+    if (entry.key == NULL) {
+        self->dropped++;
+        return;
+    }
+
+    if (cuckoomap_add(self, &entry, len, hash2) != 0) {
+        arena_free(&self->arena, entry.key, len + 1);
+        self->dropped++;
+        return;
+    }
+    self->count++;
+}
+
+map_res_t cuckoomap_lookup_n(const void *_self, const char *key, const size_t len) {
+    const cuckoomap_t *self = _self;
+
+    cuckoomap_pos_t pos;
+    if (!cuckoomap_find(self, key, len, cuckoomap_hash(self, 0, key, len), cuckoomap_hash(self, 1, key, len), &pos))
+        return (map_res_t){0};
+
+    return (map_res_t){
+        .data = pos.bucket ? pos.bucket->vals[pos.slot] : self->stash[pos.stash].value,
+        .ok   = 1,
+    };
+}
+
+int cuckoomap_remove_n(void *_self, const char *key, const size_t len) {
+    cuckoomap_t *self = _self;
+
+    cuckoomap_pos_t pos;
+    if (!cuckoomap_find(self, key, len, cuckoomap_hash(self, 0, key, len), cuckoomap_hash(self, 1, key, len), &pos))
+        return 0;
+
+    if (pos.bucket) {
+        arena_free(&self->arena, pos.bucket->keys[pos.slot], len + 1);
+        pos.bucket->keys[pos.slot] = NULL;
+        // Освободившееся место может принять запись из списка переполнения.
+        cuckoomap_unstash(self);
+    } else {
+        arena_free(&self->arena, self->stash[pos.stash].key, len + 1);
+        self->stash[pos.stash] = self->stash[--self->nstash];
+    }
+    self->count--;
+
+    return 1;
+}
+
+cuckoomap_stats_t cuckoomap_stats(const void *_self) {
+    const cuckoomap_t *self = _self;
+    assert(*(const imap_t *const *) _self == &CuckooMapClass);
+
+    return (cuckoomap_stats_t){
+        .count   = self->count,
+        .cap     = self->nbuckets * CUCKOOMAP_BUCKET_SIZE,
+        .stashed = self->nstash,
+        .dropped = self->dropped,
+    };
+}
+
+const imap_t CuckooMapClass = {
+    .size   = sizeof(cuckoomap_t),
+    .ctor   = cuckoomap_ctor,
+    .dtor   = cuckoomap_dtor,
+    .insert_n = cuckoomap_insert_n,
+    .lookup_n = cuckoomap_lookup_n,
+    .remove_n = cuckoomap_remove_n,
+    .reserve = cuckoomap_reserve,
+};
@@ -1,11 +1,201 @@
 #include "hash.h"
 
-hash_t djb2(const hash_t salt, const char *key) {
+#include <stdint.h>
+#include <string.h>
+
+hash_t djb2(const hash_t salt, const char *key, const size_t len) {
+    const unsigned char *p = (const unsigned char *) key;
     hash_t hash = salt;
 
-    unsigned char c;
-    while ((c = *key++))
-        hash = (hash << 5) + hash + c;  // hash * 33 + c
+    for (size_t i = 0; i < len; i++)
+        hash = (hash << 5) + hash + p[i];  // hash * 33 + c
+
+    return hash;
+}
+
+hash_t fnv1a(const hash_t salt, const char *key, const size_t len) {
+    const unsigned char *p = (const unsigned char *) key;
+    hash_t hash = 2166136261u ^ salt;   // FNV offset basis
+
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 16777619u;              // FNV prime
+    }
 
     return hash;
 }
+
+// Чтение 8 и 4 байтов по невыровненному адресу.
+static inline uint64_t hash_read64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t hash_read32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Чтение 1-3 байтов (wyhash).
+static inline uint64_t hash_read3(const unsigned char *p, const size_t len) {
+    return ((uint64_t) p[0] << 16) | ((uint64_t) p[len >> 1] << 8) | p[len - 1];
+}
+
+// Умножение 64 x 64 -> 128 бит, возвращает старшую и младшую половины.
+static inline void hash_mum(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+    const __uint128_t r = (__uint128_t) *a * *b;
+    *a = (uint64_t) r;
+    *b = (uint64_t) (r >> 64);
+#else
+    const uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t) *a, lb = (uint32_t) *b;
+    const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    const uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+// Перемешивание двух слов: xor половин 128-битного произведения.
+static inline uint64_t hash_mix64(uint64_t a, uint64_t b) {
+    hash_mum(&a, &b);
+    return a ^ b;
+}
+
+// Сворачивает 64-битный хэш в hash_t.
+static inline hash_t hash_fold(const uint64_t h) {
+    return (hash_t) (h ^ (h >> 32));
+}
+
+// Константы wyhash.
+#define WY_P0 0xa0761d6478bd642full
+#define WY_P1 0xe7037ed1a0b428dbull
+#define WY_P2 0x8ebc6af09c88c6e3ull
+#define WY_P3 0x589965cc75374cc3ull
+
+hash_t wyhash(const hash_t salt, const char *key, const size_t len) {
+    const unsigned char *p = (const unsigned char *) key;
+
+    uint64_t seed = salt ^ WY_P0;
+    uint64_t a, b;
+
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (hash_read32(p) << 32) | hash_read32(p + ((len >> 3) << 2));
+            b = (hash_read32(p + len - 4) << 32) | hash_read32(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = hash_read3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = hash_mix64(hash_read64(p) ^ WY_P1, hash_read64(p + 8) ^ seed);
+                see1 = hash_mix64(hash_read64(p + 16) ^ WY_P2, hash_read64(p + 24) ^ see1);
+                see2 = hash_mix64(hash_read64(p + 32) ^ WY_P3, hash_read64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = hash_mix64(hash_read64(p) ^ WY_P1, hash_read64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = hash_read64(p + i - 16);
+        b = hash_read64(p + i - 8);
+    }
+
+    a ^= WY_P1;
+    b ^= seed;
+    hash_mum(&a, &b);
+
+    return hash_fold(hash_mix64(a ^ WY_P0 ^ len, b ^ WY_P1));
+}
+
+// Константы xxHash.
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ull
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4Full
+#define XXH_PRIME64_3 0x165667B19E3779F9ull
+
+// Секрет по умолчанию XXH3 (первые 64 байта).
+static const uint64_t xxh3_secret[8] = {
+    0xbe4ba423396cfeb8ull, 0x1cad21f72c81017cull,
+    0xdb979083e96dd4deull, 0x1f67b3b7a4a44072ull,
+    0x78e5c0cc4ee679cbull, 0x2172ffcc7dd05a82ull,
+    0x8e2443f7744608b8ull, 0x4c263a81e69035e0ull,
+};
+
+// Финальное перемешивание XXH3.
+static inline uint64_t xxh3_avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9ull;
+    h ^= h >> 32;
+    return h;
+}
+
+// Перемешивание 16 байтов входа с 16 байтами секрета.
+static inline uint64_t xxh3_mix16(const unsigned char *p, const uint64_t *secret, const uint64_t seed) {
+    return hash_mix64(hash_read64(p) ^ (secret[0] + seed), hash_read64(p + 8) ^ (secret[1] - seed));
+}
+
+hash_t xxh3(const hash_t salt, const char *key, const size_t len) {
+    const unsigned char *p = (const unsigned char *) key;
+    const uint64_t seed = salt;
+
+    uint64_t acc;
+    if (len == 0) {
+        acc = xxh3_avalanche(seed ^ xxh3_secret[0] ^ xxh3_secret[1]);
+    } else if (len <= 3) {
+        const uint64_t combined = ((uint64_t) p[0] << 16) | ((uint64_t) p[len >> 1] << 24)
+                                | p[len - 1] | ((uint64_t) len << 8);
+        acc = xxh3_avalanche(combined ^ ((xxh3_secret[0] >> 32) + seed));
+    } else if (len <= 8) {
+        const uint64_t input = hash_read32(p + len - 4) + (hash_read32(p) << 32);
+        uint64_t h = input ^ (xxh3_secret[1] - seed);
+        h ^= (h << 49 | h >> 15) ^ (h << 24 | h >> 40);
+        h *= 0x9FB21C651E98DF25ull;
+        h ^= (h >> 35) + len;
+        h *= 0x9FB21C651E98DF25ull;
+        acc = h ^ (h >> 28);
+    } else if (len <= 16) {
+        const uint64_t lo = hash_read64(p) ^ (xxh3_secret[2] + seed);
+        const uint64_t hi = hash_read64(p + len - 8) ^ (xxh3_secret[3] - seed);
+        acc = xxh3_avalanche(len + __builtin_bswap64(lo) + hi + hash_mix64(lo, hi));
+    } else {
+        // Длинные входы обрабатываются полосами по 32 байта: два блока
+        // по 16 байт с разными частями секрета, хвост - с конца входа.
+        acc = len * XXH_PRIME64_1;
+        size_t i = 0;
+        for (; i + 32 <= len; i += 32) {
+            acc += xxh3_mix16(p + i, xxh3_secret + ((i >> 5) & 1) * 4, seed);
+            acc += xxh3_mix16(p + i + 16, xxh3_secret + ((i >> 5) & 1) * 4 + 2, seed);
+            acc = (acc << 31 | acc >> 33) * XXH_PRIME64_2;
+        }
+        acc += xxh3_mix16(p + len - 16, xxh3_secret + 6, seed);
+        if (len - i > 16)
+            acc += xxh3_mix16(p + i, xxh3_secret + 4, seed);
+        acc = xxh3_avalanche(acc ^ XXH_PRIME64_3);
+    }
+
+    return hash_fold(acc);
+}
+
+hash_t hash_mix(hash_t h) {
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
@@ -2,8 +2,10 @@
 
 #include <assert.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdlib.h>
 
+#include "arena.h"
 #include "err.h"
 #include "hash.h"
 
@@ -11,24 +13,68 @@
 #define HMAP_BUCKET_SIZE 8
 #define HMAP_INITIAL_B 4    // 2^4 = 16
 #define HMAP_MAX_LOAD_FACTOR 0.75
+// Таблица уменьшается вдвое, когда записи занимают меньше
+// 1/HMAP_MIN_LOAD_DEN мест основного массива бакетов.
+#define HMAP_MIN_LOAD_DEN 8
+
+// Количество бакетов старого массива, переносимых в новый массив
+// за одну операцию вставки или удаления во время роста таблицы.
+#ifndef HMAP_EVACUATE_STEP
+#define HMAP_EVACUATE_STEP 2
+#endif
+
+// Количество ключей, обрабатываемых hmap_lookup_batch за один проход:
+// сначала для всех ключей группы вычисляются хэши и запрашивается
+// предвыборка бакетов, затем ключи сравниваются.
+#ifndef HMAP_LOOKUP_BATCH
+#define HMAP_LOOKUP_BATCH 16
+#endif
+
+#define HMAP_CACHE_LINE 64
+
+// Размер места под ключ в бакете. Ключи короче HMAP_INLINE_KEY символов
+// (вместе с '\0') хранятся прямо в бакете, более длинные - в арене мапы.
+#define HMAP_INLINE_KEY 16
+// Значение последнего байта места под ключ, если ключ хранится в арене.
+// У ключа, хранящегося в бакете, последний байт всегда равен '\0'.
+#define HMAP_KEY_EXTERNAL 1
 
 #define TOP_HASH_MASK(B) ((1 << (B)) - 1)
-#define LOW_HASH_MASK(B) (~((1 << (B)) - 1))
-#define HMAP_BUCKETS(B) (1 << (B))
+#define HMAP_BUCKETS(B) ((size_t) 1 << (B))
 
 
+// Место под ключ в бакете.
+typedef union {
+    // Короткий ключ вместе с '\0', остаток дополнен нулями.
+    char buf[HMAP_INLINE_KEY];
+
+    // Длинный ключ, скопированный в арену мапы, и его длина.
+    // В этом случае buf[HMAP_INLINE_KEY - 1] == HMAP_KEY_EXTERNAL.
+    struct {
+        mut_mkey_t ptr;
+        uint32_t   len;
+    } ext;
+} hmap_key_t;
+
+_Static_assert(sizeof(hmap_key_t) == HMAP_INLINE_KEY);
+
 struct hmap_bucket;
 typedef struct hmap_bucket hmap_bucket_t;
 
 struct hmap_bucket {
-    // HOB - High Order Bytes, старшие байты хэша.
-    hash_t hob[HMAP_BUCKET_SIZE];
+    // Полные хэши ключей. Младшие B бит совпадают у всех записей цепочки,
+    // а старшие байты (HOB, high order bytes) позволяют отбросить
+    // несовпадающий ключ без сравнения строк.
+    // Хранение полного хэша позволяет переносить записи при росте таблицы
+    // без повторного вычисления хэш-функции.
+    hash_t hashes[HMAP_BUCKET_SIZE];
 
     // Количество элементов в бакете.
     unsigned char len;
 
     // Ключи, причём i-ый ключ имеет i-ое значение из vals.
-    mut_mkey_t keys[HMAP_BUCKET_SIZE];
+    // Сравнение с коротким ключом не обращается к памяти вне бакета.
+    hmap_key_t keys[HMAP_BUCKET_SIZE];
 
     // Значения, причём i-ое значение имеет i-ый ключ из keys.
     mval_t vals[HMAP_BUCKET_SIZE];
@@ -49,22 +95,89 @@ typedef struct {
     // Массив бакетов количеством 2^B,
     hmap_bucket_t *buckets;
 
+    // Массив бакетов количеством 2^old_B до начала роста таблицы.
+    // Во время роста оба массива существуют одновременно, и каждая вставка
+    // и удаление переносят (эвакуируют) несколько бакетов из old_buckets
+    // в buckets, поэтому задержка одной операции остаётся ограниченной.
+    // Поиск не переносит бакеты и не изменяет таблицу.
+    // NULL, если таблица не растёт.
+    hmap_bucket_t *old_buckets;
+    unsigned char old_B;
+
+    // Номер следующего бакета old_buckets для эвакуации.
+    // Бакеты old_buckets с номерами меньше nevacuate уже перенесены.
+    size_t nevacuate;
+
+    // Количество записей в таблице.
+    size_t count;
+
+    // Количество бакетов переполнения (аллоцированных отдельно
+    // бакетов цепочек) в обоих массивах.
+    size_t noverflow;
+
     // Хэш-функция.
     hash_func_t hash;
 
     // Зерно для криптографической устойчивости хэш-функции.
     // Генерируется случайно при создании мапы.
     hash_t seed;
+
+    // Арена для ключей, не поместившихся в бакет.
+    arena_t arena;
 } hmap_t;
 
 // Необходимо для валидной реализации интерфейса.
 _Static_assert(offsetof(hmap_t, class) == 0);
 
 
+static inline int hmap_key_is_external(const hmap_key_t *k) {
+    return k->buf[HMAP_INLINE_KEY - 1] == HMAP_KEY_EXTERNAL;
+}
+
+// Сравнивает место под ключ с ключом длины len.
+// Короткий ключ совпадает, если его байты равны и за ними в бакете следует
+// '\0', длинный - если совпадают длины и байты.
+static inline int hmap_key_eq(const hmap_key_t *k, const char *key, const size_t len) {
+    if (len < HMAP_INLINE_KEY)
+        return !hmap_key_is_external(k) && k->buf[len] == '\0' && memcmp(k->buf, key, len) == 0;
+    return hmap_key_is_external(k) && STRN_EQ(k->ext.ptr, (size_t) k->ext.len, key, len);
+}
+
+// Копирует ключ в место под ключ: короткий - в бакет, длинный - в арену.
+// Возвращает 0 или ENOMEM (err.h).
+static int hmap_key_init(hmap_t *self, hmap_key_t *k, const char *key, const size_t len) {
+    if (len < HMAP_INLINE_KEY) {
+        memset(k->buf, 0, HMAP_INLINE_KEY);
+        memcpy(k->buf, key, len);
+        return 0;
+    }
+
+    assert(len <= UINT32_MAX);
+    k->ext.ptr = arena_strndup(&self->arena, key, len);
+    if (k->ext.ptr == NULL)
+        return ENOMEM;
+    k->ext.len = (uint32_t) len;
+    k->buf[HMAP_INLINE_KEY - 1] = HMAP_KEY_EXTERNAL;
+    return 0;
+}
+
+// Возвращает место, занятое ключом в арене, если ключ хранится в ней.
+static inline void hmap_key_free(hmap_t *self, hmap_key_t *k) {
+    if (hmap_key_is_external(k))
+        arena_free(&self->arena, k->ext.ptr, k->ext.len + 1);
+}
+
+
 void *hmap_ctor(void *_class, va_list *ap) {
     hmap_t *self = _class;
 
     self->B = HMAP_INITIAL_B;
+    self->old_buckets = NULL;
+    self->old_B = 0;
+    self->nevacuate = 0;
+    self->count = 0;
+    self->noverflow = 0;
+    arena_init(&self->arena);
     self->buckets = calloc(HMAP_BUCKETS(self->B), sizeof(hmap_bucket_t));
     if (self->buckets == NULL)
         return ERR_PTR(-ENOMEM);
@@ -76,147 +189,280 @@ void *hmap_ctor(void *_class, va_list *ap) {
     return self;
 }
 
-void hmap_dtor(void *_self) {
-    hmap_t *self = _self;
-
+// Освобождает бакеты переполнения массива из n бакетов, но не сам массив.
+// Ключи хранятся в арене и освобождаются вместе с ней.
+static void hmap_buckets_clear(hmap_bucket_t *buckets, const size_t n) {
     // Бакеты 0-го уровня вложенности хранятся единым участком памяти,
-    // поэтому они освобождаются free(old_buckets).
+    // поэтому они освобождаются free(buckets).
     // Бакеты, которые соединены в цепочку, аллоцированы отдельно,
     // поэтому необходимо отдельно их освободить.
-    for (size_t i = 0; i < HMAP_BUCKETS(self->B); i++) {
-        hmap_bucket_t *bucket = self->buckets[i].next;
+    for (size_t i = 0; i < n; i++) {
+        hmap_bucket_t *bucket = buckets[i].next;
         while (bucket) {
-            for (unsigned char j = 0; j < bucket->len; j++) {
-                free(bucket->keys[j]);
-                bucket->keys[j] = NULL;
-            }
             hmap_bucket_t *next = bucket->next;
             free(bucket);
             bucket = next;
         }
-        bucket = &self->buckets[i];
-        for (unsigned char j = 0; j < bucket->len; j++) {
-            free(bucket->keys[j]);
-            bucket->keys[j] = NULL;
-        }
     }
+}
 
+void hmap_dtor(void *_self) {
+    hmap_t *self = _self;
+
+    if (self->old_buckets) {
+        // Бакеты с номерами меньше nevacuate уже пусты.
+        const size_t old_capacity = HMAP_BUCKETS(self->old_B);
+        hmap_buckets_clear(self->old_buckets + self->nevacuate, old_capacity - self->nevacuate);
+        free(self->old_buckets);
+        self->old_buckets = NULL;
+    }
+
+    hmap_buckets_clear(self->buckets, HMAP_BUCKETS(self->B));
     free(self->buckets);
     self->buckets = NULL;
-}
 
-static inline hash_t hmap_lob_hash(const hmap_t *self, mkey_t key) {
-    return self->hash(self->seed, key) & TOP_HASH_MASK(self->B);
-}
-
-static inline hash_t hmap_hob_hash(const hmap_t *self, mkey_t key) {
-    return self->hash(self->seed, key) & LOW_HASH_MASK(self->B);
+    arena_destroy(&self->arena);
 }
 
+// Коэффициент заполненности таблицы: отношение количества записей
+// к количеству мест во всех бакетах, включая бакеты переполнения.
+// Вычисляется за O(1) по счётчикам count и noverflow.
+// Имеет смысл только вне роста таблицы.
 static double hmap_load_factor(const hmap_t *self) {
-    unsigned elems = 0;
-    unsigned buckets = 0;
+    // guaranteed at least one bucket (B = 0, 2^0 = 1).
+    const size_t buckets = HMAP_BUCKETS(self->B) + self->noverflow;
+    return (double) self->count / ((double) buckets * HMAP_BUCKET_SIZE);
+}
 
-    for (unsigned char i = 0; i < HMAP_BUCKETS(self->B); i++) {
-        const hmap_bucket_t *bucket = &self->buckets[i];
-        while (bucket) {
-            elems += bucket->len;
-            buckets++;
-            bucket = bucket->next;
+// Добавляет в цепочку бакетов новую запись без проверки на существование ключа.
+// Возвращает 0 или ENOMEM (err.h).
+static int hmap_bucket_put(hmap_t *self, hmap_bucket_t *bucket,
+                           const hash_t hash, const hmap_key_t *key, const mval_t value) {
+    while (bucket->len == HMAP_BUCKET_SIZE) {
+        if (bucket->next == NULL) {
+            bucket->next = calloc(1, sizeof(hmap_bucket_t));
+            if (bucket->next == NULL)
+                return ENOMEM;
+            self->noverflow++;
         }
+        bucket = bucket->next;
     }
 
-    // guaranteed at least one bucket (B = 0, 2^0 = 1).
-    return (double) elems / ((double) buckets * HMAP_BUCKET_SIZE);
+    bucket->hashes[bucket->len] = hash;
+    bucket->keys[bucket->len] = *key;
+    bucket->vals[bucket->len] = value;
+    bucket->len++;
+
+    return 0;
 }
 
-void hmap_insert(void *_self, mkey_t key, mval_t value);
+// Удаляет последнюю запись цепочки head. Опустевший последний бакет
+// переполнения освобождается.
+static void hmap_chain_pop(hmap_t *self, hmap_bucket_t *head) {
+    hmap_bucket_t *prev = NULL;
+    hmap_bucket_t *last = head;
+    while (last->next) {
+        prev = last;
+        last = last->next;
+    }
 
-int hmap_grow(hmap_t *self) {
-    hmap_bucket_t *old_buckets = self->buckets;
-    const size_t old_capacity = HMAP_BUCKETS(self->B);
+    last->len--;
+    if (last->len == 0 && prev != NULL) {
+        prev->next = NULL;
+        free(last);
+        self->noverflow--;
+    }
+}
 
-    self->B++;
-    void *tmp = calloc(HMAP_BUCKETS(self->B), sizeof(hmap_bucket_t));
-    if (tmp == NULL)
-        return ENOMEM;
-    self->buckets = tmp;
+// Удаляет из нового массива первые moved записей i-го бакета старого
+// массива. Записи, перенесённые в одну цепочку, - последние записи этой
+// цепочки, поэтому удаляются с её конца.
+static void hmap_evacuate_undo(hmap_t *self, const size_t i, size_t moved) {
+    for (const hmap_bucket_t *bucket = &self->old_buckets[i]; moved > 0; bucket = bucket->next) {
+        for (unsigned char j = 0; j < bucket->len && moved > 0; j++, moved--)
+            hmap_chain_pop(self, &self->buckets[bucket->hashes[j] & TOP_HASH_MASK(self->B)]);
+    }
+}
 
-    for (size_t i = 0; i < old_capacity; i++) {
-        hmap_bucket_t *bucket = &old_buckets[i];
-        while (bucket) {
-            for (unsigned char j = 0; j < bucket->len; j++) {
-                hmap_insert(self, bucket->keys[j], bucket->vals[j]);
-                free(bucket->keys[j]); // hmap_insert вызывает strdup для ключа
-                bucket->keys[j] = NULL;
+// Переносит i-ый бакет старого массива (вместе с цепочкой переполнения)
+// в новый массив. Хэш-функция не вызывается, а длинные ключи не копируются:
+// переносятся только сохранённые хэши и места под ключи.
+// Если бакет переполнения не удалось выделить, перенесённые записи
+// удаляются из нового массива, а старая цепочка остаётся нетронутой.
+// Возвращает 0 или ENOMEM (err.h).
+static int hmap_evacuate_bucket(hmap_t *self, const size_t i) {
+    size_t moved = 0;
+    for (hmap_bucket_t *bucket = &self->old_buckets[i]; bucket; bucket = bucket->next) {
+        for (unsigned char j = 0; j < bucket->len; j++) {
+            const hash_t hash = bucket->hashes[j];
+            hmap_bucket_t *dst = &self->buckets[hash & TOP_HASH_MASK(self->B)];
+            if (hmap_bucket_put(self, dst, hash, &bucket->keys[j], bucket->vals[j]) != 0) {
+                hmap_evacuate_undo(self, i, moved);
+                return ENOMEM;
             }
-            bucket = bucket->next;
+            moved++;
         }
     }
 
-    // Бакеты 0-го уровня вложенности хранятся единым участком памяти,
-    // поэтому они освобождаются free(old_buckets).
+    hmap_bucket_t *bucket = &self->old_buckets[i];
+    bucket->len = 0;
+
     // Бакеты, которые соединены в цепочку, аллоцированы отдельно,
     // поэтому необходимо отдельно их освободить.
-    for (size_t i = 0; i < old_capacity; i++) {
-        hmap_bucket_t *bucket = old_buckets[i].next;
-        while (bucket) {
-            hmap_bucket_t *next = bucket->next;
-            free(bucket); // вызываем только для бакета, так как ключи уже освобождены.
-            bucket = next;
-        }
+    bucket = self->old_buckets[i].next;
+    while (bucket) {
+        hmap_bucket_t *next = bucket->next;
+        free(bucket);
+        self->noverflow--;
+        bucket = next;
+    }
+    self->old_buckets[i].next = NULL;
+
+    return 0;
+}
+
+// Эвакуирует не более HMAP_EVACUATE_STEP бакетов старого массива.
+// Когда перенесены все бакеты, освобождает старый массив и завершает рост.
+// При ENOMEM бакет остаётся в старом массиве, и его перенос повторит
+// следующая операция, поэтому вставка и удаление ошибку не проверяют.
+// Возвращает 0 или ENOMEM (err.h).
+static int hmap_evacuate(hmap_t *self) {
+    if (self->old_buckets == NULL)
+        return 0;
+
+    const size_t old_capacity = HMAP_BUCKETS(self->old_B);
+    for (int step = 0; step < HMAP_EVACUATE_STEP && self->nevacuate < old_capacity; step++) {
+        if (hmap_evacuate_bucket(self, self->nevacuate) != 0)
+            return ENOMEM;
+        self->nevacuate++;
     }
 
-    free(old_buckets);
+    if (self->nevacuate == old_capacity) {
+        free(self->old_buckets);
+        self->old_buckets = NULL;
+        self->nevacuate = 0;
+    }
+
+    return 0;
+}
+
+// Начинает изменение размера таблицы: выделяет массив из 2^B бакетов.
+// Записи переносятся в него постепенно функцией hmap_evacuate.
+// Возвращает 0 или ENOMEM (err.h).
+static int hmap_begin_resize(hmap_t *self, const unsigned char B) {
+    assert(self->old_buckets == NULL);
+
+    void *tmp = calloc(HMAP_BUCKETS(B), sizeof(hmap_bucket_t));
+    if (tmp == NULL)
+        return ENOMEM;
+
+    self->old_buckets = self->buckets;
+    self->old_B = self->B;
+    self->nevacuate = 0;
+    self->buckets = tmp;
+    self->B = B;
 
     return 0;
 }
 
-void hmap_insert(void *_self, mkey_t key, const mval_t value) {
+// Начинает рост таблицы: выделяет массив бакетов вдвое большего размера.
+// Возвращает 0 или ENOMEM (err.h).
+int hmap_grow(hmap_t *self) {
+    return hmap_begin_resize(self, self->B + 1);
+}
+
+// Завершает текущий рост, перенося все оставшиеся бакеты.
+// Возвращает 0 или ENOMEM (err.h).
+static int hmap_evacuate_all(hmap_t *self) {
+    while (self->old_buckets) {
+        if (hmap_evacuate(self) != 0)
+            return ENOMEM;
+    }
+    return 0;
+}
+
+// Перестраивает таблицу сразу в 2^B бакетов: завершает текущий рост
+// и переносит все записи в новый массив за один вызов.
+// При ENOMEM таблица остаётся в состоянии роста, который продолжат
+// следующие операции.
+// Возвращает 0 или ENOMEM (err.h).
+static int hmap_resize(hmap_t *self, const unsigned char B) {
+    if (hmap_evacuate_all(self) != 0 || hmap_begin_resize(self, B) != 0)
+        return ENOMEM;
+
+    // Номер целевого бакета вычисляется по полному хэшу, поэтому
+    // hmap_evacuate_bucket переносит записи при любом изменении B.
+    return hmap_evacuate_all(self);
+}
+
+int hmap_reserve(void *_self, const size_t n) {
+    hmap_t *self = _self;
+
+    // Наименьшее B, при котором n записей не превышают HMAP_MAX_LOAD_FACTOR.
+    unsigned char B = self->B;
+    while ((double) n > HMAP_BUCKETS(B) * HMAP_BUCKET_SIZE * HMAP_MAX_LOAD_FACTOR)
+        B++;
+
+    if (B == self->B)
+        return 0;
+    return hmap_resize(self, B);
+}
+
+// Возвращает первый бакет цепочки, в которой хранится (или должен храниться)
+// ключ с хэшем hash.
+// Во время роста ключ может находиться в ещё не эвакуированном бакете
+// старого массива.
+static hmap_bucket_t *hmap_bucket_of(const hmap_t *self, const hash_t hash) {
+    if (self->old_buckets) {
+        const hash_t old_lob = hash & TOP_HASH_MASK(self->old_B);
+        if (old_lob >= self->nevacuate)
+            return &self->old_buckets[old_lob];
+    }
+
+    return &self->buckets[hash & TOP_HASH_MASK(self->B)];
+}
+
+void hmap_insert_n(void *_self, const char *key, const size_t len, const mval_t value) {
     hmap_t *self = _self;
 
-    const hash_t lob = hmap_lob_hash(self, key);
-    hmap_bucket_t *bucket = &self->buckets[lob];
+    hmap_evacuate(self);
 
-    const hash_t hob = hmap_hob_hash(self, key);
-    unsigned char i;
+    const hash_t hash = self->hash(self->seed, key, len);
+    hmap_bucket_t *head = hmap_bucket_of(self, hash);
+    hmap_bucket_t *bucket = head;
 again:
-    for (i = 0; i < bucket->len; i++) {
-        if (bucket->hob[i] == hob && STR_EQ(bucket->keys[i], key)) {
+    for (unsigned char i = 0; i < bucket->len; i++) {
+        if (bucket->hashes[i] == hash && hmap_key_eq(&bucket->keys[i], key, len)) {
             bucket->vals[i] = value;    // update existing value.
-            goto done;
+            return;
         }
     }
 
-    if (i == HMAP_BUCKET_SIZE) {
-        if (bucket->next == NULL) {
-            bucket->next = calloc(1, sizeof(hmap_bucket_t));
-        }
+    if (bucket->next) {
         bucket = bucket->next;
         goto again;
     }
 
-    bucket->hob[i] = hob;
-    bucket->len++;
-    bucket->keys[i] = strdup(key);
-    bucket->vals[i] = value;
+    hmap_key_t k;
+    if (hmap_key_init(self, &k, key, len) != 0)
+        return;
+    if (hmap_bucket_put(self, head, hash, &k, value) != 0) {
+        hmap_key_free(self, &k);
+        return;
+    }
+    self->count++;
 
-done:
-    while (hmap_load_factor(self) > HMAP_MAX_LOAD_FACTOR) {
+    // Новый рост начинается только после завершения предыдущего.
+    if (self->old_buckets == NULL && hmap_load_factor(self) > HMAP_MAX_LOAD_FACTOR)
         hmap_grow(self);
-    }
 }
 
-map_res_t hmap_lookup(const void *_self, mkey_t key) {
-    const hmap_t *self = _self;
-
-    const hash_t lob = hmap_lob_hash(self, key);
-    const hmap_bucket_t *bucket = &self->buckets[lob];
-
-    const hash_t hob = hmap_hob_hash(self, key);
+// Ищет ключ в цепочке, начинающейся с бакета bucket.
+static map_res_t hmap_chain_lookup(const hmap_bucket_t *bucket, const hash_t hash,
+                                   const char *key, const size_t len) {
 again:
     for (unsigned char i = 0; i < bucket->len; i++) {
-        if (hob == bucket->hob[i] && STR_EQ(bucket->keys[i], key)) {
+        if (hash == bucket->hashes[i] && hmap_key_eq(&bucket->keys[i], key, len)) {
             return (map_res_t){
                 .data = bucket->vals[i],
                 .ok   = 1,
@@ -231,21 +477,138 @@ again:
     goto again;
 }
 
-int hmap_remove(void *_self, mkey_t key) {
+map_res_t hmap_lookup_n(const void *_self, const char *key, const size_t len) {
+    const hmap_t *self = _self;
+
+    const hash_t hash = self->hash(self->seed, key, len);
+    return hmap_chain_lookup(hmap_bucket_of(self, hash), hash, key, len);
+}
+
+// Запрашивает предвыборку всех кэш-линий бакета.
+static inline void hmap_bucket_prefetch(const hmap_bucket_t *bucket) {
+    for (size_t off = 0; off < sizeof(hmap_bucket_t); off += HMAP_CACHE_LINE)
+        __builtin_prefetch((const char *) bucket + off, 0, 3);
+}
+
+void hmap_lookup_batch(const void *_self, const mkey_t *keys, const size_t n, map_res_t *results) {
+    const hmap_t *self = _self;
+
+    const hmap_bucket_t *buckets[HMAP_LOOKUP_BATCH];
+    hash_t hashes[HMAP_LOOKUP_BATCH];
+    size_t lens[HMAP_LOOKUP_BATCH];
+
+    for (size_t base = 0; base < n; base += HMAP_LOOKUP_BATCH) {
+        const size_t group = n - base < HMAP_LOOKUP_BATCH ? n - base : HMAP_LOOKUP_BATCH;
+
+        for (size_t i = 0; i < group; i++) {
+            lens[i] = strlen(keys[base + i]);
+            hashes[i] = self->hash(self->seed, keys[base + i], lens[i]);
+            buckets[i] = hmap_bucket_of(self, hashes[i]);
+            hmap_bucket_prefetch(buckets[i]);
+        }
+
+        for (size_t i = 0; i < group; i++)
+            results[base + i] = hmap_chain_lookup(buckets[i], hashes[i], keys[base + i], lens[i]);
+    }
+}
+
+// Заполняет освободившееся место i бакета bucket последней записью цепочки
+// head. Все бакеты цепочки, кроме последнего, остаются заполненными,
+// а опустевший последний бакет переполнения освобождается, поэтому после
+// массового удаления цепочки не состоят из пустых бакетов.
+static void hmap_chain_fill_hole(hmap_t *self, hmap_bucket_t *head,
+                                 hmap_bucket_t *bucket, const unsigned char i) {
+    hmap_bucket_t *prev = NULL;
+    hmap_bucket_t *last = head;
+    while (last->next) {
+        prev = last;
+        last = last->next;
+    }
+
+    const unsigned char j = last->len - 1;
+    bucket->hashes[i] = last->hashes[j];
+    bucket->keys[i] = last->keys[j];
+    bucket->vals[i] = last->vals[j];
+    last->len--;
+
+    if (last->len == 0 && prev != NULL) {
+        prev->next = NULL;
+        free(last);
+        self->noverflow--;
+    }
+}
+
+// Копирует длинные ключи в новую арену и освобождает старую целиком.
+// После массового удаления старая арена состоит в основном из свободных
+// блоков, которые иначе оставались бы выделенными до уничтожения мапы.
+// Возвращает 0 или ENOMEM (err.h).
+static int hmap_arena_compact(hmap_t *self) {
+    assert(self->old_buckets == NULL);
+
+    arena_t fresh;
+    arena_init(&fresh);
+
+    for (size_t i = 0; i < HMAP_BUCKETS(self->B); i++) {
+        for (hmap_bucket_t *bucket = &self->buckets[i]; bucket; bucket = bucket->next) {
+            for (unsigned char j = 0; j < bucket->len; j++) {
+                hmap_key_t *k = &bucket->keys[j];
+                if (!hmap_key_is_external(k))
+                    continue;
+
+                mut_mkey_t copy = arena_strndup(&fresh, k->ext.ptr, k->ext.len);
+                if (copy == NULL) {
+                    // Часть ключей уже в новой арене: обе арены остаются мапе.
+                    arena_merge(&self->arena, &fresh);
+                    return ENOMEM;
+                }
+                k->ext.ptr = copy;
+            }
+        }
+    }
+
+    arena_destroy(&self->arena);
+    self->arena = fresh;
+    return 0;
+}
+
+int hmap_compact(void *_self) {
     hmap_t *self = _self;
+    assert(*(const imap_t *const *) _self == &HashMapClass);
 
-    const hash_t lob = hmap_lob_hash(self, key);
-    hmap_bucket_t *bucket = &self->buckets[lob];
+    if (hmap_evacuate_all(self) != 0)
+        return ENOMEM;
+    return hmap_arena_compact(self);
+}
+
+// Начинает уменьшение таблицы вдвое, если записи занимают меньше
+// 1/HMAP_MIN_LOAD_DEN мест основного массива. Записи переносятся
+// постепенно, как при росте.
+// Новое уменьшение, как и рост, начинается только вне роста таблицы.
+static void hmap_shrink(hmap_t *self) {
+    if (self->old_buckets != NULL || self->B <= HMAP_INITIAL_B)
+        return;
+
+    if (self->count * HMAP_MIN_LOAD_DEN >= HMAP_BUCKETS(self->B) * HMAP_BUCKET_SIZE)
+        return;
+
+    hmap_begin_resize(self, self->B - 1);
+}
+
+int hmap_remove_n(void *_self, const char *key, const size_t len) {
+    hmap_t *self = _self;
 
-    const hash_t hob = hmap_hob_hash(self, key);
+    hmap_evacuate(self);
+
+    const hash_t hash = self->hash(self->seed, key, len);
+    hmap_bucket_t *head = hmap_bucket_of(self, hash);
+    hmap_bucket_t *bucket = head;
 again:
     for (unsigned char i = 0; i < bucket->len; i++) {
-        if (bucket->hob[i] == hob && STR_EQ(bucket->keys[i], key)) {
-            free(bucket->keys[i]);
-            memmove(bucket->hob  + i, bucket->hob  + i + 1, sizeof(hash_t) * (bucket->len - i - 1));
-            memmove(bucket->keys + i, bucket->keys + i + 1, sizeof(mkey_t) * (bucket->len - i - 1));
-            memmove(bucket->vals + i, bucket->vals + i + 1, sizeof(mval_t) * (bucket->len - i - 1));
-            bucket->len--;
+        if (bucket->hashes[i] == hash && hmap_key_eq(&bucket->keys[i], key, len)) {
+            hmap_key_free(self, &bucket->keys[i]);
+            hmap_chain_fill_hole(self, head, bucket, i);
+            self->count--;
+            hmap_shrink(self);
             return 1;
         }
     }
@@ -257,11 +620,46 @@ again:
     goto again;
 }
 
+// Добавляет в статистику цепочку, начинающуюся с бакета bucket.
+static void hmap_stats_add_chain(hmap_stats_t *stats, const hmap_bucket_t *bucket) {
+    size_t len = 0;
+    for (const hmap_bucket_t *b = bucket; b; b = b->next)
+        len += b->len;
+
+    stats->chains++;
+    if (len > stats->max_chain)
+        stats->max_chain = len;
+    stats->hist[len < HMAP_STATS_HIST ? len : HMAP_STATS_HIST - 1]++;
+}
+
+hmap_stats_t hmap_stats(const void *_self) {
+    const hmap_t *self = _self;
+    assert(*(const imap_t *const *) _self == &HashMapClass);
+
+    hmap_stats_t stats = {
+        .count    = self->count,
+        .overflow = self->noverflow,
+    };
+
+    for (size_t i = 0; i < HMAP_BUCKETS(self->B); i++)
+        hmap_stats_add_chain(&stats, &self->buckets[i]);
+
+    // Во время роста учитываются ещё не эвакуированные цепочки.
+    if (self->old_buckets) {
+        for (size_t i = self->nevacuate; i < HMAP_BUCKETS(self->old_B); i++)
+            hmap_stats_add_chain(&stats, &self->old_buckets[i]);
+    }
+
+    return stats;
+}
+
 const imap_t HashMapClass = {
     .size   = sizeof(hmap_t),
     .ctor   = hmap_ctor,
     .dtor   = hmap_dtor,
-    .insert = hmap_insert,
-    .lookup = hmap_lookup,
-    .remove = hmap_remove,
+    .insert_n = hmap_insert_n,
+    .lookup_n = hmap_lookup_n,
+    .remove_n = hmap_remove_n,
+    .lookup_batch = hmap_lookup_batch,
+    .reserve = hmap_reserve,
 };
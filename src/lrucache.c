@@ -0,0 +1,256 @@
+#include "lrucache.h"
+
+#include <assert.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "arena.h"
+#include "err.h"
+#include "hash.h"
+
+typedef struct {
+    mut_mkey_t key;     // Копия ключа в арене кэша.
+    size_t     len;
+    mval_t     value;
+    hash_t     hash;    // Хэш ключа, по которому узел размещён в индексе.
+} lru_entry;
+
+#define T lru_entry
+#include "dlist.h"
+#undef T
+
+typedef dnode_lru_entry_t lru_node_t;
+
+// Пустое место индекса.
+#define LRUCACHE_EMPTY 0
+
+typedef struct {
+    const imap_t *class;
+    size_t        capacity;
+    size_t        count;
+    lru_node_t   *nodes;    // capacity узлов, выделенных в конструкторе.
+
+    // Голова списка записей: head.next - последняя использованная
+    // запись, head.prev - давно не использовавшаяся.
+    lru_node_t    head;
+    // Голова списка свободных узлов.
+    lru_node_t    free;
+
+    // Индекс ключей: хэш-таблица с открытой адресацией и линейным
+    // пробированием из nslots мест (степень двойки, не меньше удвоенной
+    // ёмкости). Место хранит номер узла в nodes, увеличенный на 1, или
+    // LRUCACHE_EMPTY. Ключи сравниваются с ключами узлов.
+    uint32_t     *slots;
+    size_t        nslots;
+    hash_func_t   hash;
+    hash_t        seed;
+
+    // Счётчики изменяются поиском, поэтому не являются константными
+    // даже для константного кэша.
+    size_t        hits;
+    size_t        misses;
+    size_t        evictions;
+
+    arena_t       arena;    // Арена для копий ключей.
+} lrucache_t;
+
+_Static_assert(offsetof(lrucache_t, class) == 0);
+
+
+void *lrucache_ctor(void *_self, va_list *ap) {
+    lrucache_t *self = _self;
+
+    self->capacity = va_arg(*ap, size_t);
+    self->hash = va_arg(*ap, hash_func_t);
+    assert(self->hash != NULL);
+
+    // Номер узла, увеличенный на 1, хранится в месте индекса.
+    if (self->capacity == 0 || self->capacity > INT_MAX)
+        return ERR_PTR(-EINVAL);
+
+    self->nodes = malloc(self->capacity * sizeof(lru_node_t));
+    if (self->nodes == NULL)
+        return ERR_PTR(-ENOMEM);
+
+    // Заполненность индекса не превышает 1/2, поэтому цепочки
+    // пробирования короткие, а индекс никогда не перестраивается.
+    self->nslots = 1;
+    while (self->nslots < 2 * self->capacity)
+        self->nslots *= 2;
+    self->slots = calloc(self->nslots, sizeof(uint32_t));
+    if (self->slots == NULL) {
+        free(self->nodes);
+        return ERR_PTR(-ENOMEM);
+    }
+    self->seed = rand();
+
+    self->head.next = self->head.prev = &self->head;
+    self->free.next = self->free.prev = &self->free;
+    for (size_t i = 0; i < self->capacity; i++)
+        dlist_lru_entry_add(self->free.prev, &self->nodes[i], &self->free);
+
+    self->count = 0;
+    self->hits = 0;
+    self->misses = 0;
+    self->evictions = 0;
+    arena_init(&self->arena);
+
+    return self;
+}
+
+void lrucache_dtor(void *_self) {
+    lrucache_t *self = _self;
+
+    free(self->slots);
+    free(self->nodes);
+    arena_destroy(&self->arena);
+}
+
+static inline hash_t lrucache_hash(const lrucache_t *self, const char *key, const size_t len) {
+    // djb2 и подобные хэши плохо перемешивают младшие биты, по которым
+    // выбирается место индекса.
+    return hash_mix(self->hash(self->seed, key, len));
+}
+
+// Номер места индекса с узлом ключа или первого пустого места
+// цепочки пробирования, если ключа нет.
+static size_t lrucache_slot(const lrucache_t *self, const char *key, const size_t len,
+                            const hash_t hash) {
+    const size_t mask = self->nslots - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const uint32_t slot = self->slots[i];
+        if (slot == LRUCACHE_EMPTY)
+            return i;
+
+        const lru_entry *entry = &self->nodes[slot - 1].data;
+        if (entry->hash == hash && STRN_EQ(entry->key, entry->len, key, len))
+            return i;
+    }
+}
+
+// Освобождает место i индекса. Следующие записи цепочки пробирования
+// сдвигаются назад, поэтому удалённых мест (tombstones) не бывает,
+// и индекс не требует перестроения.
+static void lrucache_slot_del(lrucache_t *self, size_t i) {
+    const size_t mask = self->nslots - 1;
+    for (size_t j = (i + 1) & mask; self->slots[j] != LRUCACHE_EMPTY; j = (j + 1) & mask) {
+        // Запись из места j можно перенести в i, если её начальное место
+        // не лежит циклически в (i, j].
+        const size_t home = self->nodes[self->slots[j] - 1].data.hash & mask;
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            self->slots[i] = self->slots[j];
+            i = j;
+        }
+    }
+    self->slots[i] = LRUCACHE_EMPTY;
+}
+
+// Переносит узел в начало списка записей.
+static inline void lrucache_touch(lrucache_t *self, lru_node_t *node) {
+    if (dlist_lru_entry_is_first(&self->head, node))
+        return;
+    dlist_lru_entry_del(node);
+    dlist_lru_entry_add(&self->head, node, self->head.next);
+}
+
+// Удаляет запись узла из индекса и возвращает узел в список свободных.
+static void lrucache_release(lrucache_t *self, lru_node_t *node) {
+    const lru_entry *entry = &node->data;
+    lrucache_slot_del(self, lrucache_slot(self, entry->key, entry->len, entry->hash));
+    arena_free(&self->arena, node->data.key, node->data.len + 1);
+
+    dlist_lru_entry_del(node);
+    dlist_lru_entry_add(&self->free, node, self->free.next);
+    self->count--;
+}
+
+static inline lru_node_t *lrucache_find(const lrucache_t *self, const char *key, const size_t len) {
+    const uint32_t slot = self->slots[lrucache_slot(self, key, len, lrucache_hash(self, key, len))];
+    return slot != LRUCACHE_EMPTY ? &self->nodes[slot - 1] : NULL;
+}
+
+void lrucache_insert_n(void *_self, const char *key, const size_t len, const mval_t value) {
+    lrucache_t *self = _self;
+
+    const hash_t hash = lrucache_hash(self, key, len);
+    size_t i = lrucache_slot(self, key, len, hash);
+    if (self->slots[i] != LRUCACHE_EMPTY) {
+        lru_node_t *node = &self->nodes[self->slots[i] - 1];
+        node->data.value = value;    // update existing value.
+        lrucache_touch(self, node);
+        return;
+    }
+
+    const mut_mkey_t dup = arena_strndup(&self->arena, key, len);
+    if (dup == NULL)
+        return;
+
+    // Вытеснение сдвигает записи индекса, поэтому место ключа ищется заново.
+    if (self->count == self->capacity) {
+        lrucache_release(self, self->head.prev);
+        self->evictions++;
+        i = lrucache_slot(self, key, len, hash);
+    }
+
+    lru_node_t *node = self->free.next;
+    node->data = (lru_entry){ .key = dup, .len = len, .value = value, .hash = hash };
+    self->slots[i] = (uint32_t) (node - self->nodes) + 1;
+
+    dlist_lru_entry_del(node);
+    dlist_lru_entry_add(&self->head, node, self->head.next);
+    self->count++;
+}
+
+map_res_t lrucache_lookup_n(const void *_self, const char *key, const size_t len) {
+    // Поиск изменяет порядок использования и счётчики. Объект создан
+    // map_new без спецификатора const, поэтому его можно изменять.
+    lrucache_t *self = (lrucache_t *) _self;
+
+    lru_node_t *node = lrucache_find(self, key, len);
+    if (node == NULL) {
+        self->misses++;
+        return (map_res_t){0};
+    }
+
+    self->hits++;
+    lrucache_touch(self, node);
+    return (map_res_t){
+        .data = node->data.value,
+        .ok   = 1,
+    };
+}
+
+int lrucache_remove_n(void *_self, const char *key, const size_t len) {
+    lrucache_t *self = _self;
+
+    lru_node_t *node = lrucache_find(self, key, len);
+    if (node == NULL)
+        return 0;
+
+    lrucache_release(self, node);
+    return 1;
+}
+
+lrucache_stats_t lrucache_stats(const void *_self) {
+    const lrucache_t *self = _self;
+    assert(*(const imap_t *const *) _self == &LRUCacheClass);
+
+    return (lrucache_stats_t){
+        .count     = self->count,
+        .capacity  = self->capacity,
+        .hits      = self->hits,
+        .misses    = self->misses,
+        .evictions = self->evictions,
+    };
+}
+
+const imap_t LRUCacheClass = {
+    .size     = sizeof(lrucache_t),
+    .ctor     = lrucache_ctor,
+    .dtor     = lrucache_dtor,
+    .insert_n = lrucache_insert_n,
+    .lookup_n = lrucache_lookup_n,
+    .remove_n = lrucache_remove_n,
+};
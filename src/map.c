@@ -7,16 +7,26 @@
 #include "err.h"
 
 void *map_new(const imap_t *class, ...) {
+    va_list ap;
+    va_start(ap, class);
+    void *p = map_vnew(class, &ap);
+    va_end(ap);
+
+    return p;
+}
+
+void *map_vnew(const imap_t *class, va_list *ap) {
     void *p = malloc(class->size);
     if (p == NULL)
         return ERR_PTR(-ENOMEM);
 
     *(const imap_t **)p = class;
     if (class->ctor) {
-        va_list ap;
-        va_start(ap, class);
-        p = class->ctor(p, &ap);
-        va_end(ap);
+        void *self = class->ctor(p, ap);
+        // Конструктор, вернувший ошибку, освобождает только свои ресурсы.
+        if (IS_ERR(self))
+            free(p);
+        return self;
     }
 
     return p;
@@ -35,23 +45,266 @@ void map_destroy(void *self) {
 void map_insert(void *self, const mkey_t key, const mval_t value) {
     const imap_t *const *cp = self;
     assert(self && *cp);
-    assert((*cp)->insert);
+    assert((*cp)->insert || (*cp)->insert_n);
 
-    (*cp)->insert(self, key, value);
+    if ((*cp)->insert)
+        (*cp)->insert(self, key, value);
+    else
+        (*cp)->insert_n(self, key, strlen(key), value);
 }
 
 map_res_t map_lookup(const void *self, const mkey_t key) {
     const imap_t *const *cp = self;
     assert(self && *cp);
-    assert((*cp)->lookup);
+    assert((*cp)->lookup || (*cp)->lookup_n);
 
-    return (*cp)->lookup(self, key);
+    if ((*cp)->lookup)
+        return (*cp)->lookup(self, key);
+    return (*cp)->lookup_n(self, key, strlen(key));
 }
 
 int map_remove(void *self, const mkey_t key) {
     const imap_t *const *cp = self;
     assert(self && *cp);
-    assert((*cp)->remove);
+    assert((*cp)->remove || (*cp)->remove_n);
+
+    if ((*cp)->remove)
+        return (*cp)->remove(self, key);
+    return (*cp)->remove_n(self, key, strlen(key));
+}
+
+void map_lookup_batch(const void *self, const mkey_t *keys, const size_t n, map_res_t *results) {
+    const imap_t *const *cp = self;
+    assert(self && *cp);
+    assert(keys || n == 0);
+    assert(results || n == 0);
+
+    // Если класс реализует поиск массива ключей, используем его.
+    if ((*cp)->lookup_batch) {
+        (*cp)->lookup_batch(self, keys, n, results);
+        return;
+    }
+
+    // Иначе ищем ключи по одному.
+    for (size_t i = 0; i < n; i++)
+        results[i] = map_lookup(self, keys[i]);
+}
+
+int map_reserve(void *self, const size_t n) {
+    const imap_t *const *cp = self;
+    assert(self && *cp);
+
+    // Резервирование - лишь оптимизация, поэтому может быть не реализовано.
+    if ((*cp)->reserve == NULL)
+        return 0;
+    return (*cp)->reserve(self, n);
+}
+
+int map_insert_sorted(void *self, const mkey_t *keys, const mval_t *values, const size_t n) {
+    const imap_t *const *cp = self;
+    assert(self && *cp);
+    assert((keys && values) || n == 0);
+
+    // Классы полагаются на порядок ключей, поэтому он проверяется до вставки.
+    for (size_t i = 1; i < n; i++)
+        if (strcmp(keys[i - 1], keys[i]) >= 0)
+            return EINVAL;
+
+    if ((*cp)->insert_sorted)
+        return (*cp)->insert_sorted(self, keys, values, n);
+
+    for (size_t i = 0; i < n; i++)
+        map_insert(self, keys[i], values[i]);
+    return 0;
+}
+
+void *map_build_sorted(const imap_t *class, const mkey_t *keys, const mval_t *values,
+                       const size_t n, ...) {
+    va_list ap;
+    va_start(ap, n);
+    void *self = map_vnew(class, &ap);
+    va_end(ap);
+    if (IS_ERR(self))
+        return self;
+
+    const int err = map_insert_sorted(self, keys, values, n);
+    if (err != 0) {
+        map_destroy(self);
+        return ERR_PTR(-(long) err);
+    }
+    return self;
+}
+
+// Размер буфера на стеке для копирования ключа, если класс не реализует
+// методы для ключей, заданных указателем и длиной.
+#define MAP_KEY_BUF_SIZE 128
+
+// Копирует ключ в buf, если он помещается, иначе в кучу, и дописывает '\0'.
+// Возвращает копию ключа или NULL, если не удалось выделить память.
+static string_t *map_key_copy(string_t *buf, const string_t *key, const size_t len) {
+    string_t *copy = len < MAP_KEY_BUF_SIZE ? buf : malloc(len + 1);
+    if (copy == NULL)
+        return NULL;
+
+    memcpy(copy, key, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+static void map_key_free(string_t *buf, string_t *copy) {
+    if (copy != buf)
+        free(copy);
+}
+
+void map_insert_n(void *self, const string_t *key, const size_t len, const mval_t value) {
+    const imap_t *const *cp = self;
+    assert(self && *cp);
+    assert((*cp)->insert || (*cp)->insert_n);
+
+    if ((*cp)->insert_n) {
+        (*cp)->insert_n(self, key, len, value);
+        return;
+    }
+
+    string_t buf[MAP_KEY_BUF_SIZE];
+    string_t *copy = map_key_copy(buf, key, len);
+    if (copy == NULL)
+        return;
+    (*cp)->insert(self, copy, value);
+    map_key_free(buf, copy);
+}
+
+map_res_t map_lookup_n(const void *self, const string_t *key, const size_t len) {
+    const imap_t *const *cp = self;
+    assert(self && *cp);
+    assert((*cp)->lookup || (*cp)->lookup_n);
+
+    if ((*cp)->lookup_n)
+        return (*cp)->lookup_n(self, key, len);
+
+    string_t buf[MAP_KEY_BUF_SIZE];
+    string_t *copy = map_key_copy(buf, key, len);
+    if (copy == NULL)
+        return (map_res_t){0};
+    const map_res_t res = (*cp)->lookup(self, copy);
+    map_key_free(buf, copy);
+    return res;
+}
+
+int map_remove_n(void *self, const string_t *key, const size_t len) {
+    const imap_t *const *cp = self;
+    assert(self && *cp);
+    assert((*cp)->remove || (*cp)->remove_n);
+
+    if ((*cp)->remove_n)
+        return (*cp)->remove_n(self, key, len);
+
+    string_t buf[MAP_KEY_BUF_SIZE];
+    string_t *copy = map_key_copy(buf, key, len);
+    if (copy == NULL)
+        return 0;
+    const int res = (*cp)->remove(self, copy);
+    map_key_free(buf, copy);
+    return res;
+}
+
+int map_iter_init(const void *self, map_iter_t *it) {
+    const imap_t *const *cp = self;
+    assert(self && *cp);
+    assert(it);
+
+    if ((*cp)->iter_seek == NULL)
+        return ENOTSUP;
+    assert((*cp)->iter_next && (*cp)->iter_prev);
+
+    it->map = self;
+    it->key = NULL;
+    it->value = 0;
+    it->node = NULL;
+    it->pos = 0;
+    it->depth = 0;
+    return 0;
+}
+
+int map_iter_seek(map_iter_t *it, const mkey_t key) {
+    return map_iter_seek_n(it, key, strlen(key));
+}
+
+int map_iter_seek_n(map_iter_t *it, const string_t *key, const size_t len) {
+    const imap_t *const *cp = it->map;
+    assert(it->map && (*cp)->iter_seek);
+
+    return (*cp)->iter_seek(it, key, len);
+}
+
+int map_iter_next(map_iter_t *it) {
+    const imap_t *const *cp = it->map;
+    assert(it->map && (*cp)->iter_next);
+
+    return (*cp)->iter_next(it);
+}
+
+int map_iter_prev(map_iter_t *it) {
+    const imap_t *const *cp = it->map;
+    assert(it->map && (*cp)->iter_prev);
+
+    return (*cp)->iter_prev(it);
+}
+
+int map_range(const void *self, const mkey_t lo, const mkey_t hi, const map_range_cb_t callback, void *arg) {
+    assert(callback);
+
+    map_iter_t it;
+    const int err = map_iter_init(self, &it);
+    if (err)
+        return err;
+
+    int ok = lo ? map_iter_seek(&it, lo) : map_iter_next(&it);
+    for (; ok; ok = map_iter_next(&it)) {
+        if (hi && strcmp(it.key, hi) >= 0)
+            break;
+        if (callback(it.key, it.value, arg))
+            break;
+    }
+    return 0;
+}
+
+int map_rank(const void *self, const mkey_t key, size_t *rank) {
+    const imap_t *const *cp = self;
+    assert(self && *cp);
+    assert(key && rank);
+
+    if ((*cp)->rank == NULL)
+        return ENOTSUP;
+    *rank = (*cp)->rank(self, key, strlen(key));
+    return 0;
+}
+
+int map_select(const void *self, const size_t k, map_iter_t *it) {
+    const imap_t *const *cp = self;
+    assert(self && *cp);
+
+    if ((*cp)->iter_select == NULL)
+        return ENOTSUP;
+
+    const int err = map_iter_init(self, it);
+    if (err)
+        return err;
+    (*cp)->iter_select(it, k);
+    return 0;
+}
+
+int map_count_range(const void *self, const mkey_t lo, const mkey_t hi, size_t *count) {
+    const imap_t *const *cp = self;
+    assert(self && *cp);
+    assert(count);
+
+    if ((*cp)->rank == NULL)
+        return ENOTSUP;
 
-    return (*cp)->remove(self, key);
+    // Количество ключей из [lo, hi) - разность рангов границ.
+    const size_t from = lo ? (*cp)->rank(self, lo, strlen(lo)) : 0;
+    const size_t to = (*cp)->rank(self, hi, hi ? strlen(hi) : 0);
+    *count = to > from ? to - from : 0;
+    return 0;
 }
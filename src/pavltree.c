@@ -0,0 +1,564 @@
+#include "pavltree.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "arena.h"
+#include "err.h"
+#include "pool.h"
+
+// Наибольшая высота пути от корня (см. avltree.c).
+#define PAVLTREE_MAX_HEIGHT 96
+
+// Наибольшее количество узлов, которые создаёт одна запись: копия каждого
+// узла пути, до двух копий на уровень при поворотах и новый лист.
+#define PAVLTREE_MAX_WRITE_NODES (3 * PAVLTREE_MAX_HEIGHT + 1)
+
+#define PAVLTREE_CACHE_LINE 64
+
+// Количество счётчиков читателей версии. Потоки получают счётчики
+// по очереди, поэтому до PAVLTREE_READER_SLOTS читателей не делят
+// кэш-линию счётчика, а большее количество делит их поровну.
+#ifndef PAVLTREE_READER_SLOTS
+#define PAVLTREE_READER_SLOTS 16
+#endif
+
+struct pavltree_node;
+typedef struct pavltree_node pavltree_node_t;
+
+// Поле stamp - номер записи, создавшей узел. Узлы текущей записи ещё
+// не опубликованы, поэтому их можно изменять на месте, остальные узлы
+// перед изменением копируются.
+struct pavltree_node {
+    uint64_t         prefix;
+    mut_mkey_t       key;
+    pavltree_node_t *left;
+    pavltree_node_t *right;
+    uint64_t         stamp;
+    mval_t           value;
+    int              height;
+};
+
+// Признак в младшем бите указателя на вытесненный узел: вместе с узлом
+// освобождается его ключ (узел удалён, а не заменён копией с тем же ключом).
+#define PAVLTREE_RETIRED_KEY ((uintptr_t) 1)
+
+typedef struct pavltree_version pavltree_version_t;
+
+// Счётчик читателей версии из потоков, получивших этот номер счётчика.
+// Занимает отдельную кэш-линию: закрепление версии изменяет только
+// линию своего потока. Снимок - указатель на счётчик, которым он закреплён.
+typedef struct {
+    _Alignas(PAVLTREE_CACHE_LINE) atomic_size_t count;
+    pavltree_version_t *version;
+} pavltree_reader_t;
+
+// Версия дерева. Структуры версий не освобождаются до уничтожения дерева,
+// а переиспользуются: читатель, прочитавший указатель на уже вытесненную
+// версию, изменяет счётчик читателей в памяти, которая ещё принадлежит
+// дереву, и после проверки отказывается от версии (см. pavltree_pin).
+struct pavltree_version {
+    pavltree_reader_t   readers[PAVLTREE_READER_SLOTS];
+
+    // Следующая версия в очереди вытесненных версий или в списке свободных.
+    pavltree_version_t *next;
+    pavltree_node_t    *root;
+
+    // Узлы версии, которых нет в следующей версии (с PAVLTREE_RETIRED_KEY).
+    uintptr_t          *retired;
+    size_t              nretired;
+    size_t              cap;
+};
+
+typedef struct {
+    const imap_t *class;
+
+    // Текущая версия. Единственное поле, которое читают читатели.
+    _Atomic(pavltree_version_t *) current;
+
+    // Остальные поля принадлежат писателю.
+
+    // Очередь вытесненных версий от самой старой к самой новой.
+    pavltree_version_t *oldest;
+    pavltree_version_t *newest;
+    size_t              nversions;
+    size_t              nretired;
+
+    // Свободные структуры версий.
+    pavltree_version_t *free_versions;
+
+    // Номер текущей записи.
+    uint64_t            stamp;
+
+    // Узлы, выделенные до начала записи: запись, начавшая изменять
+    // дерево, не прерывается из-за нехватки памяти.
+    pavltree_node_t    *stash[PAVLTREE_MAX_WRITE_NODES];
+    size_t              nstash;
+
+    // Пул узлов и арена для ключей узлов.
+    pool_t              pool;
+    arena_t             arena;
+} pavltree_t;
+
+_Static_assert(offsetof(pavltree_t, class) == 0);
+
+// Путь от корня до узла: узлы пути и направление спуска из каждого.
+typedef struct {
+    pavltree_node_t *nodes[PAVLTREE_MAX_HEIGHT];
+    unsigned char    right[PAVLTREE_MAX_HEIGHT];
+    int              len;
+} pavltree_path_t;
+
+static pavltree_version_t *pavltree_version_get(pavltree_t *self) {
+    pavltree_version_t *version = self->free_versions;
+    if (version != NULL) {
+        self->free_versions = version->next;
+        return version;
+    }
+
+    version = aligned_alloc(PAVLTREE_CACHE_LINE, sizeof(pavltree_version_t));
+    if (version == NULL)
+        return NULL;
+    // Счётчики читателей обнуляются только здесь: у переиспользуемой версии
+    // их могут временно увеличить читатели, прочитавшие устаревший указатель.
+    for (int i = 0; i < PAVLTREE_READER_SLOTS; i++) {
+        atomic_init(&version->readers[i].count, 0);
+        version->readers[i].version = version;
+    }
+    version->retired = NULL;
+    version->nretired = 0;
+    version->cap = 0;
+    return version;
+}
+
+void *pavltree_ctor(void *_self, va_list *ap) {
+    pavltree_t *self = _self;
+    self->oldest = NULL;
+    self->newest = NULL;
+    self->nversions = 0;
+    self->nretired = 0;
+    self->free_versions = NULL;
+    self->stamp = 0;
+    self->nstash = 0;
+
+    pavltree_version_t *version = pavltree_version_get(self);
+    if (version == NULL)
+        return ERR_PTR(-ENOMEM);
+    version->root = NULL;
+    atomic_init(&self->current, version);
+
+    pool_init(&self->pool, sizeof(pavltree_node_t));
+    arena_init(&self->arena);
+    return self;
+}
+
+static void pavltree_version_list_free(pavltree_version_t *version) {
+    while (version != NULL) {
+        pavltree_version_t *next = version->next;
+        free(version->retired);
+        free(version);
+        version = next;
+    }
+}
+
+void pavltree_destroy(void *_self) {
+    pavltree_t *self = _self;
+
+    // Читателей уже нет: узлы и ключи всех версий освобождаются разом.
+    pavltree_version_t *current = atomic_load_explicit(&self->current, memory_order_relaxed);
+    current->next = NULL;
+    pavltree_version_list_free(current);
+    pavltree_version_list_free(self->oldest);
+    pavltree_version_list_free(self->free_versions);
+    self->oldest = NULL;
+    self->newest = NULL;
+    self->free_versions = NULL;
+
+    pool_destroy(&self->pool);
+    arena_destroy(&self->arena);
+}
+
+// Номер счётчика читателей потока, общий для всех деревьев.
+static size_t pavltree_reader_slot(void) {
+    static atomic_size_t next;
+    static _Thread_local size_t slot; // номер счётчика + 1 или 0
+
+    if (slot == 0)
+        slot = atomic_fetch_add_explicit(&next, 1, memory_order_relaxed) % PAVLTREE_READER_SLOTS + 1;
+    return slot - 1;
+}
+
+// Закрепляет текущую версию счётчиком потока. Между чтением указателя
+// и увеличением счётчика версия может быть вытеснена и освобождена,
+// поэтому после увеличения указатель читается повторно. Писатель сначала
+// публикует новую версию, затем читает счётчики старой (обе операции
+// seq_cst): либо писатель увидит читателя, либо читатель увидит новую версию.
+static pavltree_reader_t *pavltree_pin(const pavltree_t *self) {
+    const size_t slot = pavltree_reader_slot();
+    for (;;) {
+        pavltree_version_t *version = atomic_load(&self->current);
+        pavltree_reader_t *reader = &version->readers[slot];
+        atomic_fetch_add(&reader->count, 1);
+        if (atomic_load(&self->current) == version)
+            return reader;
+        atomic_fetch_sub(&reader->count, 1);
+    }
+}
+
+static void pavltree_unpin(pavltree_reader_t *reader) {
+    atomic_fetch_sub(&reader->count, 1);
+}
+
+// Возвращает 1, если версию не читает ни один читатель.
+static int pavltree_version_unused(pavltree_version_t *version) {
+    for (int i = 0; i < PAVLTREE_READER_SLOTS; i++) {
+        if (atomic_load(&version->readers[i].count) != 0)
+            return 0;
+    }
+    return 1;
+}
+
+static map_res_t pavltree_node_lookup(const pavltree_node_t *node, const char *key, const size_t len) {
+    assert(key);
+
+    const uint64_t prefix = str_prefix(key, len);
+    while (node != NULL) {
+        const int cmp = strzp_cmp(prefix, key, len, node->prefix, node->key);
+        if (cmp == 0) {
+            return (map_res_t){
+                .data = node->value,
+                .ok   = 1,
+            };
+        }
+        node = cmp < 0 ? node->left : node->right;
+    }
+
+    return (map_res_t){0};
+}
+
+map_res_t pavltree_lookup_n(const void *_self, const char *key, const size_t len) {
+    pavltree_reader_t *reader = pavltree_pin(_self);
+    const map_res_t res = pavltree_node_lookup(reader->version->root, key, len);
+    pavltree_unpin(reader);
+    return res;
+}
+
+const void *pavltree_snapshot(const void *self) {
+    return pavltree_pin(self);
+}
+
+map_res_t pavltree_snapshot_lookup(const void *snapshot, const char *key, const size_t len) {
+    const pavltree_reader_t *reader = snapshot;
+    return pavltree_node_lookup(reader->version->root, key, len);
+}
+
+void pavltree_snapshot_release(const void *snapshot) {
+    pavltree_unpin((pavltree_reader_t *) snapshot);
+}
+
+pavltree_stats_t pavltree_stats(const void *_self) {
+    const pavltree_t *self = _self;
+    return (pavltree_stats_t){
+        .versions = self->nversions,
+        .retired  = self->nretired,
+    };
+}
+
+// Версия, которую вытеснит текущая запись. Её изменяет только писатель.
+static inline pavltree_version_t *pavltree_current(pavltree_t *self) {
+    return atomic_load_explicit(&self->current, memory_order_relaxed);
+}
+
+// Освобождает вытесненные версии от самой старой, пока их никто не читает.
+// Узлы вытесненной версии есть только в ней и в более старых версиях,
+// поэтому версию нельзя освободить раньше более старой.
+static void pavltree_collect(pavltree_t *self) {
+    while (self->oldest != NULL && pavltree_version_unused(self->oldest)) {
+        pavltree_version_t *version = self->oldest;
+        self->oldest = version->next;
+        if (self->oldest == NULL)
+            self->newest = NULL;
+
+        for (size_t i = 0; i < version->nretired; i++) {
+            pavltree_node_t *node = (pavltree_node_t *) (version->retired[i] & ~PAVLTREE_RETIRED_KEY);
+            if (version->retired[i] & PAVLTREE_RETIRED_KEY)
+                arena_free_str(&self->arena, node->key);
+            pool_free(&self->pool, node);
+        }
+        self->nretired -= version->nretired;
+        self->nversions--;
+        version->nretired = 0;
+
+        version->next = self->free_versions;
+        self->free_versions = version;
+    }
+}
+
+// Готовит запись, создающую до n узлов: выделяет узлы в запас, место
+// для вытесненных узлов текущей версии и структуру следующей версии.
+// Возвращает следующую версию или NULL, если не удалось выделить память;
+// тогда дерево не изменяется.
+static pavltree_version_t *pavltree_begin(pavltree_t *self, const size_t n) {
+    assert(n <= PAVLTREE_MAX_WRITE_NODES);
+
+    while (self->nstash < n) {
+        pavltree_node_t *node = pool_alloc(&self->pool);
+        if (node == NULL)
+            return NULL;
+        self->stash[self->nstash++] = node;
+    }
+
+    // Каждая копия вытесняет узел, кроме того вытесняются удаляемые узлы.
+    pavltree_version_t *current = pavltree_current(self);
+    if (current->nretired + n + 2 > current->cap) {
+        const size_t cap = current->nretired + n + 2 + current->cap;
+        uintptr_t *retired = realloc(current->retired, cap * sizeof(uintptr_t));
+        if (retired == NULL)
+            return NULL;
+        current->retired = retired;
+        current->cap = cap;
+    }
+
+    pavltree_version_t *next = pavltree_version_get(self);
+    if (next == NULL)
+        return NULL;
+
+    self->stamp++;
+    return next;
+}
+
+static pavltree_node_t *pavltree_node_new(pavltree_t *self) {
+    assert(self->nstash > 0);
+    return self->stash[--self->nstash];
+}
+
+static void pavltree_retire(pavltree_t *self, pavltree_node_t *node, const uintptr_t flags) {
+    pavltree_version_t *current = pavltree_current(self);
+    assert(current->nretired < current->cap);
+    current->retired[current->nretired++] = (uintptr_t) node | flags;
+}
+
+// Возвращает узел, который текущая запись может изменять: сам узел, если
+// он создан этой записью, иначе его копию. Исходный узел вытесняется.
+static pavltree_node_t *pavltree_own(pavltree_t *self, pavltree_node_t *node) {
+    if (node->stamp == self->stamp)
+        return node;
+
+    pavltree_node_t *copy = pavltree_node_new(self);
+    *copy = *node;
+    copy->stamp = self->stamp;
+    pavltree_retire(self, node, 0);
+    return copy;
+}
+
+static inline int pavltree_node_height(const pavltree_node_t *node) {
+    return node != NULL ? node->height : 0;
+}
+
+static inline int pavltree_node_balance(const pavltree_node_t *node) {
+    return pavltree_node_height(node->left) - pavltree_node_height(node->right);
+}
+
+static inline int max(const int x, const int y) {
+    return x > y ? x : y;
+}
+
+static inline void pavltree_node_update(pavltree_node_t *node) {
+    node->height = 1 + max(pavltree_node_height(node->left), pavltree_node_height(node->right));
+}
+
+// Повороты и балансировка изменяют только узлы текущей записи: узел y
+// (x) уже скопирован, дети, которые меняют ветви, копируются pavltree_own.
+static pavltree_node_t *pavltree_right_rotate(pavltree_t *self, pavltree_node_t *y) {
+    pavltree_node_t *x = pavltree_own(self, y->left);
+    y->left = x->right;
+    x->right = y;
+    pavltree_node_update(y);
+    pavltree_node_update(x);
+    return x;
+}
+
+static pavltree_node_t *pavltree_left_rotate(pavltree_t *self, pavltree_node_t *x) {
+    pavltree_node_t *y = pavltree_own(self, x->right);
+    x->right = y->left;
+    y->left = x;
+    pavltree_node_update(x);
+    pavltree_node_update(y);
+    return y;
+}
+
+// Случаи LL, LR, RR и RL, как в avltree_balance.
+static pavltree_node_t *pavltree_balance(pavltree_t *self, pavltree_node_t *node) {
+    const int balance = pavltree_node_balance(node);
+
+    if (balance > 1) {
+        if (pavltree_node_balance(node->left) < 0)
+            node->left = pavltree_left_rotate(self, pavltree_own(self, node->left));
+        return pavltree_right_rotate(self, node);
+    }
+
+    if (balance < -1) {
+        if (pavltree_node_balance(node->right) > 0)
+            node->right = pavltree_right_rotate(self, pavltree_own(self, node->right));
+        return pavltree_left_rotate(self, node);
+    }
+
+    return node;
+}
+
+static inline void pavltree_path_push(pavltree_path_t *path, pavltree_node_t *node, const int right) {
+    assert(path->len < PAVLTREE_MAX_HEIGHT);
+    path->nodes[path->len] = node;
+    path->right[path->len] = (unsigned char) right;
+    path->len++;
+}
+
+// Спускается от корня текущей версии к ключу, записывая в path пройденные
+// узлы. Возвращает узел с ключом или NULL.
+static pavltree_node_t *pavltree_descend(pavltree_t *self, pavltree_path_t *path,
+                                         const char *key, const size_t len) {
+    assert(key);
+
+    const uint64_t prefix = str_prefix(key, len);
+    pavltree_node_t *node = pavltree_current(self)->root;
+    path->len = 0;
+    while (node != NULL) {
+        const int cmp = strzp_cmp(prefix, key, len, node->prefix, node->key);
+        if (cmp == 0)
+            break;
+        pavltree_path_push(path, node, cmp > 0);
+        node = cmp < 0 ? node->left : node->right;
+    }
+    return node;
+}
+
+// Копирует узлы пути снизу вверх, подставляя child в ветвь последнего
+// узла пути, балансирует копии и публикует версию next с новым корнем.
+static void pavltree_commit(pavltree_t *self, pavltree_version_t *next, const pavltree_path_t *path,
+                            pavltree_node_t *child) {
+    for (int i = path->len - 1; i >= 0; i--) {
+        pavltree_node_t *node = pavltree_own(self, path->nodes[i]);
+        if (path->right[i])
+            node->right = child;
+        else
+            node->left = child;
+        pavltree_node_update(node);
+        child = pavltree_balance(self, node);
+    }
+
+    // Узлы новой версии записаны до публикации корня: читатель, увидевший
+    // новую версию, видит и её узлы.
+    pavltree_version_t *prev = pavltree_current(self);
+    next->root = child;
+    next->nretired = 0;
+    next->next = NULL;
+    atomic_store(&self->current, next);
+
+    prev->next = NULL;
+    if (self->newest != NULL)
+        self->newest->next = prev;
+    else
+        self->oldest = prev;
+    self->newest = prev;
+    self->nversions++;
+    self->nretired += prev->nretired;
+
+    pavltree_collect(self);
+}
+
+void pavltree_insert_n(void *_self, const char *key, const size_t len, const mval_t value) {
+    pavltree_t *self = _self;
+
+    pavltree_path_t path;
+    pavltree_node_t *node = pavltree_descend(self, &path, key, len);
+
+    mut_mkey_t dup = NULL;
+    if (node == NULL) {
+        dup = arena_strndup(&self->arena, key, len);
+        if (dup == NULL)
+            return;
+    }
+
+    // Если памяти не хватило, дерево остаётся прежним.
+    pavltree_version_t *next = pavltree_begin(self, 3 * (size_t) path.len + 1);
+    if (next == NULL) {
+        if (dup != NULL)
+            arena_free_str(&self->arena, dup);
+        return;
+    }
+
+    pavltree_node_t *child;
+    if (node != NULL) {
+        child = pavltree_own(self, node);
+        child->value = value; // обновляем существующее значение
+    } else {
+        child = pavltree_node_new(self);
+        *child = (pavltree_node_t){
+            .prefix = str_prefix(dup, len),
+            .key    = dup,
+            .stamp  = self->stamp,
+            .value  = value,
+            .height = 1,
+        };
+    }
+
+    pavltree_commit(self, next, &path, child);
+}
+
+int pavltree_remove_n(void *_self, const char *key, const size_t len) {
+    pavltree_t *self = _self;
+
+    pavltree_path_t path;
+    pavltree_node_t *node = pavltree_descend(self, &path, key, len);
+    if (node == NULL)
+        return 0;
+
+    // У узла обе ветви: его место займёт копия узла с данными минимального
+    // узла правой ветви, а минимальный узел - своя правая ветвь (см.
+    // avltree_remove_n). Путь продолжается до родителя минимального узла.
+    const int both = node->left != NULL && node->right != NULL;
+    const int at = path.len;
+    pavltree_node_t *min = NULL;
+    if (both) {
+        pavltree_path_push(&path, node, 1);
+        for (min = node->right; min->left != NULL; min = min->left)
+            pavltree_path_push(&path, min, 0);
+    }
+
+    // Без памяти на копии пути ключ не удаляется.
+    pavltree_version_t *next = pavltree_begin(self, 3 * (size_t) path.len + 1);
+    if (next == NULL)
+        return 0;
+
+    pavltree_node_t *child;
+    if (both) {
+        pavltree_node_t *copy = pavltree_node_new(self);
+        *copy = *node;
+        copy->stamp = self->stamp;
+        copy->prefix = min->prefix;
+        copy->key = min->key;
+        copy->value = min->value;
+        path.nodes[at] = copy;
+
+        pavltree_retire(self, node, PAVLTREE_RETIRED_KEY);
+        pavltree_retire(self, min, 0);
+        child = min->right;
+    } else {
+        pavltree_retire(self, node, PAVLTREE_RETIRED_KEY);
+        child = node->left != NULL ? node->left : node->right;
+    }
+
+    pavltree_commit(self, next, &path, child);
+    return 1;
+}
+
+const imap_t PersistentAVLTreeClass = {
+    .size   = sizeof(pavltree_t),
+    .ctor   = pavltree_ctor,
+    .dtor   = pavltree_destroy,
+    .insert_n = pavltree_insert_n,
+    .lookup_n = pavltree_lookup_n,
+    .remove_n = pavltree_remove_n,
+};
@@ -0,0 +1,75 @@
+#include "pool.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+
+struct pool_slab {
+    struct pool_slab *next;
+    _Alignas(void *) char data[];
+};
+
+// Свободный объект хранит указатель на следующий свободный объект.
+typedef struct pool_free_obj {
+    struct pool_free_obj *next;
+} pool_free_obj_t;
+
+void pool_init(pool_t *self, const size_t size) {
+    assert(size > 0);
+    assert(size <= POOL_SLAB_SIZE);
+
+    // Объект должен вмещать указатель списка свободных объектов
+    // и сохранять выравнивание следующего объекта слэба.
+    const size_t align = sizeof(void *);
+    self->size = (size + align - 1) / align * align;
+
+    self->slabs = NULL;
+    self->next = NULL;
+    self->end = NULL;
+    self->free_list = NULL;
+}
+
+void pool_destroy(pool_t *self) {
+    struct pool_slab *slab = self->slabs;
+    while (slab) {
+        struct pool_slab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+
+    pool_init(self, self->size);
+}
+
+void *pool_alloc(pool_t *self) {
+    // Сначала переиспользуем освобождённый объект.
+    pool_free_obj_t *obj = self->free_list;
+    if (obj) {
+        self->free_list = obj->next;
+        return obj;
+    }
+
+    if (self->next == NULL || (size_t) (self->end - self->next) < self->size) {
+        // Остаток текущего слэба меньше объекта и не используется.
+        struct pool_slab *slab = malloc(sizeof(struct pool_slab) + POOL_SLAB_SIZE);
+        if (slab == NULL)
+            return NULL;
+        slab->next = self->slabs;
+        self->slabs = slab;
+        self->next = slab->data;
+        self->end = slab->data + POOL_SLAB_SIZE;
+    }
+
+    void *p = self->next;
+    self->next += self->size;
+
+    return p;
+}
+
+void pool_free(pool_t *self, void *p) {
+    if (p == NULL)
+        return;
+
+    pool_free_obj_t *obj = p;
+    obj->next = self->free_list;
+    self->free_list = obj;
+}
@@ -0,0 +1,716 @@
+#include "radix.h"
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "arena.h"
+#include "err.h"
+#include "pool.h"
+
+// Количество байтов префикса, хранимых в узле.
+#define RADIX_MAX_PREFIX 8
+
+// Ключ дополняется завершающим '\0', поэтому ни один ключ не является
+// префиксом другого, и каждый ключ заканчивается в своём листе.
+// Байт ключа с номером len - '\0'.
+#define RADIX_BYTE(key, len, i) ((i) < (len) ? (uint8_t) (key)[i] : 0)
+
+enum {
+    RADIX_NODE4,
+    RADIX_NODE16,
+    RADIX_NODE48,
+    RADIX_NODE256,
+    RADIX_NODE_TYPES,
+};
+
+typedef struct {
+    uint8_t  type;
+    uint8_t  reserved;
+    uint16_t n;                          // Количество детей.
+    uint32_t prefix_len;                 // Длина сжатого префикса.
+    uint8_t  prefix[RADIX_MAX_PREFIX];   // Первые байты префикса.
+} radix_node_t;
+
+// Дети узлов - указатели на узлы или на листы. Листы выделяются
+// из арены с выравниванием 16, поэтому младший бит указателя на лист
+// занят под признак листа.
+typedef struct {
+    mval_t   value;
+    uint32_t len;
+    char     key[];  // Ключ с завершающим '\0'.
+} radix_leaf_t;
+
+#define RADIX_IS_LEAF(p) ((uintptr_t) (p) & 1)
+#define RADIX_LEAF(p) ((radix_leaf_t *) ((uintptr_t) (p) & ~(uintptr_t) 1))
+#define RADIX_TAG_LEAF(leaf) ((radix_node_t *) ((uintptr_t) (leaf) | 1))
+
+// Ключи детей Node4 и Node16 упорядочены по возрастанию.
+typedef struct {
+    radix_node_t  node;
+    uint8_t       keys[4];
+    radix_node_t *children[4];
+} radix_node4_t;
+
+typedef struct {
+    radix_node_t  node;
+    uint8_t       keys[16];
+    radix_node_t *children[16];
+} radix_node16_t;
+
+// index[c] - номер места ребёнка с байтом c, увеличенный на 1, или 0.
+typedef struct {
+    radix_node_t  node;
+    uint8_t       index[256];
+    radix_node_t *children[48];
+} radix_node48_t;
+
+typedef struct {
+    radix_node_t  node;
+    radix_node_t *children[256];
+} radix_node256_t;
+
+typedef struct {
+    const imap_t *class;
+    radix_node_t *root;
+    size_t        count;
+    size_t        nodes[RADIX_NODE_TYPES];  // Количество узлов каждого вида.
+
+    pool_t        pools[RADIX_NODE_TYPES];  // Пулы узлов каждого вида.
+    arena_t       arena;                    // Арена для листов.
+} radix_t;
+
+_Static_assert(offsetof(radix_t, class) == 0);
+
+static const size_t radix_node_size[RADIX_NODE_TYPES] = {
+    sizeof(radix_node4_t),
+    sizeof(radix_node16_t),
+    sizeof(radix_node48_t),
+    sizeof(radix_node256_t),
+};
+
+// Наибольшее количество детей узла каждого вида.
+static const uint16_t radix_node_cap[RADIX_NODE_TYPES] = {4, 16, 48, 256};
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+
+static radix_node_t *radix_node_new(radix_t *self, const int type) {
+    radix_node_t *node = pool_alloc(&self->pools[type]);
+    if (node == NULL)
+        return NULL;
+
+    memset(node, 0, radix_node_size[type]);
+    node->type = type;
+    self->nodes[type]++;
+    return node;
+}
+
+static void radix_node_free(radix_t *self, radix_node_t *node) {
+    self->nodes[node->type]--;
+    pool_free(&self->pools[node->type], node);
+}
+
+static size_t radix_leaf_size(const size_t len) {
+    return sizeof(radix_leaf_t) + len + 1;
+}
+
+static radix_leaf_t *radix_leaf_new(radix_t *self, const char *key, const size_t len,
+                                    const mval_t value) {
+    radix_leaf_t *leaf = arena_alloc(&self->arena, radix_leaf_size(len));
+    if (leaf == NULL)
+        return NULL;
+
+    assert(((uintptr_t) leaf & 1) == 0);
+    leaf->value = value;
+    leaf->len = len;
+    memcpy(leaf->key, key, len);
+    leaf->key[len] = '\0';
+    return leaf;
+}
+
+static void radix_leaf_free(radix_t *self, radix_leaf_t *leaf) {
+    arena_free(&self->arena, leaf, radix_leaf_size(leaf->len));
+}
+
+static inline int radix_leaf_match(const radix_leaf_t *leaf, const char *key, const size_t len) {
+    return leaf->len == len && memcmp(leaf->key, key, len) == 0;
+}
+
+// Место ребёнка с байтом c или NULL.
+static radix_node_t **radix_find_child(radix_node_t *node, const uint8_t c) {
+    switch (node->type) {
+    case RADIX_NODE4: {
+        radix_node4_t *n4 = (radix_node4_t *) node;
+        for (int i = 0; i < node->n; i++)
+            if (n4->keys[i] == c)
+                return &n4->children[i];
+        return NULL;
+    }
+    case RADIX_NODE16: {
+        radix_node16_t *n16 = (radix_node16_t *) node;
+#if defined(__SSE2__)
+        const __m128i keys = _mm_loadu_si128((const __m128i *) n16->keys);
+        const unsigned mask = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(keys, _mm_set1_epi8((char) c)))
+                            & ((1u << node->n) - 1);
+        return mask ? &n16->children[__builtin_ctz(mask)] : NULL;
+#else
+        for (int i = 0; i < node->n; i++)
+            if (n16->keys[i] == c)
+                return &n16->children[i];
+        return NULL;
+#endif
+    }
+    case RADIX_NODE48: {
+        radix_node48_t *n48 = (radix_node48_t *) node;
+        return n48->index[c] ? &n48->children[n48->index[c] - 1] : NULL;
+    }
+    default: {
+        radix_node256_t *n256 = (radix_node256_t *) node;
+        return n256->children[c] ? &n256->children[c] : NULL;
+    }
+    }
+}
+
+// Находит ребёнка с наименьшим байтом, не меньшим from.
+// Возвращает байт ребёнка или -1, если такого нет.
+static int radix_next_child(const radix_node_t *node, const int from, radix_node_t **child) {
+    switch (node->type) {
+    case RADIX_NODE4:
+    case RADIX_NODE16: {
+        // У Node4 и Node16 ключи и дети лежат по одинаковым смещениям.
+        const uint8_t *keys = node->type == RADIX_NODE4 ? ((const radix_node4_t *) node)->keys
+                                                        : ((const radix_node16_t *) node)->keys;
+        radix_node_t *const *children = node->type == RADIX_NODE4
+            ? ((const radix_node4_t *) node)->children
+            : ((const radix_node16_t *) node)->children;
+        for (int i = 0; i < node->n; i++) {
+            if (keys[i] >= from) {
+                *child = children[i];
+                return keys[i];
+            }
+        }
+        return -1;
+    }
+    case RADIX_NODE48: {
+        const radix_node48_t *n48 = (const radix_node48_t *) node;
+        for (int c = from; c < 256; c++) {
+            if (n48->index[c]) {
+                *child = n48->children[n48->index[c] - 1];
+                return c;
+            }
+        }
+        return -1;
+    }
+    default: {
+        const radix_node256_t *n256 = (const radix_node256_t *) node;
+        for (int c = from; c < 256; c++) {
+            if (n256->children[c]) {
+                *child = n256->children[c];
+                return c;
+            }
+        }
+        return -1;
+    }
+    }
+}
+
+// Любой лист поддерева. Все ключи поддерева имеют общий префикс узла,
+// поэтому байты префикса, не хранимые в узле, берутся из ключа листа.
+static const radix_leaf_t *radix_any_leaf(const radix_node_t *node) {
+    while (!RADIX_IS_LEAF(node)) {
+        radix_node_t *child;
+        radix_next_child(node, 0, &child);
+        node = child;
+    }
+    return RADIX_LEAF(node);
+}
+
+// Возвращает длину совпадающей части префикса узла и ключа, начиная
+// с байта depth ключа. Префикс проверяется целиком.
+static size_t radix_prefix_mismatch(const radix_node_t *node, const char *key, const size_t len,
+                                    const size_t depth) {
+    const size_t stored = MIN(node->prefix_len, RADIX_MAX_PREFIX);
+    for (size_t i = 0; i < stored; i++)
+        if (node->prefix[i] != RADIX_BYTE(key, len, depth + i))
+            return i;
+
+    if (node->prefix_len > RADIX_MAX_PREFIX) {
+        const radix_leaf_t *leaf = radix_any_leaf(node);
+        for (size_t i = stored; i < node->prefix_len; i++)
+            if ((uint8_t) leaf->key[depth + i] != RADIX_BYTE(key, len, depth + i))
+                return i;
+    }
+    return node->prefix_len;
+}
+
+// Добавляет ребёнка в узел, в котором есть свободное место.
+static void radix_add_child(radix_node_t *node, const uint8_t c, radix_node_t *child) {
+    assert(node->n < radix_node_cap[node->type]);
+
+    switch (node->type) {
+    case RADIX_NODE4:
+    case RADIX_NODE16: {
+        uint8_t *keys = node->type == RADIX_NODE4 ? ((radix_node4_t *) node)->keys
+                                                  : ((radix_node16_t *) node)->keys;
+        radix_node_t **children = node->type == RADIX_NODE4 ? ((radix_node4_t *) node)->children
+                                                            : ((radix_node16_t *) node)->children;
+        int i = 0;
+        while (i < node->n && keys[i] < c)
+            i++;
+        memmove(&keys[i + 1], &keys[i], node->n - i);
+        memmove(&children[i + 1], &children[i], (node->n - i) * sizeof(radix_node_t *));
+        keys[i] = c;
+        children[i] = child;
+        break;
+    }
+    case RADIX_NODE48: {
+        radix_node48_t *n48 = (radix_node48_t *) node;
+        int slot = 0;
+        while (n48->children[slot] != NULL)
+            slot++;
+        n48->children[slot] = child;
+        n48->index[c] = slot + 1;
+        break;
+    }
+    default:
+        ((radix_node256_t *) node)->children[c] = child;
+        break;
+    }
+    node->n++;
+}
+
+// Переносит заголовок и детей узла в пустой узел другого вида.
+static void radix_node_move(radix_node_t *dst, const radix_node_t *src) {
+    dst->prefix_len = src->prefix_len;
+    memcpy(dst->prefix, src->prefix, RADIX_MAX_PREFIX);
+
+    radix_node_t *child;
+    for (int c = radix_next_child(src, 0, &child); c >= 0; c = radix_next_child(src, c + 1, &child))
+        radix_add_child(dst, c, child);
+}
+
+// Заменяет узел *ref узлом вида type с теми же детьми.
+// Возвращает 0 или ENOMEM.
+static int radix_node_resize(radix_t *self, radix_node_t **ref, const int type) {
+    radix_node_t *node = radix_node_new(self, type);
+    if (node == NULL)
+        return ENOMEM;
+
+    radix_node_move(node, *ref);
+    radix_node_free(self, *ref);
+    *ref = node;
+    return 0;
+}
+
+// Удаляет ребёнка с байтом c из узла *ref. Узел, в котором осталось мало
+// детей, заменяется меньшим, а Node4 с единственным ребёнком - самим
+// ребёнком, префикс которого удлиняется префиксом узла и байтом c.
+static void radix_remove_child(radix_t *self, radix_node_t **ref, const uint8_t c) {
+    radix_node_t *node = *ref;
+
+    switch (node->type) {
+    case RADIX_NODE4:
+    case RADIX_NODE16: {
+        uint8_t *keys = node->type == RADIX_NODE4 ? ((radix_node4_t *) node)->keys
+                                                  : ((radix_node16_t *) node)->keys;
+        radix_node_t **children = node->type == RADIX_NODE4 ? ((radix_node4_t *) node)->children
+                                                            : ((radix_node16_t *) node)->children;
+        int i = 0;
+        while (keys[i] != c)
+            i++;
+        memmove(&keys[i], &keys[i + 1], node->n - i - 1);
+        memmove(&children[i], &children[i + 1], (node->n - i - 1) * sizeof(radix_node_t *));
+        break;
+    }
+    case RADIX_NODE48: {
+        radix_node48_t *n48 = (radix_node48_t *) node;
+        n48->children[n48->index[c] - 1] = NULL;
+        n48->index[c] = 0;
+        break;
+    }
+    default:
+        ((radix_node256_t *) node)->children[c] = NULL;
+        break;
+    }
+    node->n--;
+
+    // Меньший узел выбирается с запасом, чтобы чередование вставок
+    // и удалений на границе не меняло вид узла каждый раз.
+    // Если память не выделилась, узел остаётся прежним.
+    if (node->type == RADIX_NODE256 && node->n <= 36)
+        radix_node_resize(self, ref, RADIX_NODE48);
+    else if (node->type == RADIX_NODE48 && node->n <= 12)
+        radix_node_resize(self, ref, RADIX_NODE16);
+    else if (node->type == RADIX_NODE16 && node->n <= 3)
+        radix_node_resize(self, ref, RADIX_NODE4);
+    else if (node->type == RADIX_NODE4 && node->n == 1) {
+        radix_node4_t *n4 = (radix_node4_t *) node;
+        radix_node_t *child = n4->children[0];
+
+        if (!RADIX_IS_LEAF(child)) {
+            uint8_t prefix[RADIX_MAX_PREFIX];
+            size_t k = MIN(node->prefix_len, RADIX_MAX_PREFIX);
+            memcpy(prefix, node->prefix, k);
+            if (k < RADIX_MAX_PREFIX)
+                prefix[k++] = n4->keys[0];
+            if (k < RADIX_MAX_PREFIX)
+                memcpy(&prefix[k], child->prefix, MIN(child->prefix_len, RADIX_MAX_PREFIX - k));
+
+            child->prefix_len += node->prefix_len + 1;
+            memcpy(child->prefix, prefix, RADIX_MAX_PREFIX);
+        }
+        radix_node_free(self, node);
+        *ref = child;
+    }
+}
+
+void *radix_ctor(void *_self, va_list *ap) {
+    radix_t *self = _self;
+
+    self->root = NULL;
+    self->count = 0;
+    for (int type = 0; type < RADIX_NODE_TYPES; type++) {
+        pool_init(&self->pools[type], radix_node_size[type]);
+        self->nodes[type] = 0;
+    }
+    arena_init(&self->arena);
+
+    return self;
+}
+
+void radix_dtor(void *_self) {
+    radix_t *self = _self;
+
+    // Узлы и листы освобождаются разом, без обхода дерева.
+    for (int type = 0; type < RADIX_NODE_TYPES; type++)
+        pool_destroy(&self->pools[type]);
+    arena_destroy(&self->arena);
+    self->root = NULL;
+}
+
+map_res_t radix_lookup_n(const void *_self, const char *key, const size_t len) {
+    const radix_t *self = _self;
+
+    radix_node_t *node = self->root;
+    size_t depth = 0;
+    while (node != NULL) {
+        if (RADIX_IS_LEAF(node)) {
+            const radix_leaf_t *leaf = RADIX_LEAF(node);
+            if (!radix_leaf_match(leaf, key, len))
+                return (map_res_t){0};
+            return (map_res_t){
+                .data = leaf->value,
+                .ok   = 1,
+            };
+        }
+
+        // Проверяются только хранимые байты префикса, остальные
+        // проверит сравнение с ключом листа.
+        const size_t stored = MIN(node->prefix_len, RADIX_MAX_PREFIX);
+        for (size_t i = 0; i < stored; i++)
+            if (node->prefix[i] != RADIX_BYTE(key, len, depth + i))
+                return (map_res_t){0};
+        depth += node->prefix_len;
+        if (depth > len)
+            return (map_res_t){0};
+
+        radix_node_t **child = radix_find_child(node, RADIX_BYTE(key, len, depth));
+        if (child == NULL)
+            return (map_res_t){0};
+        node = *child;
+        depth++;
+    }
+
+    return (map_res_t){0};
+}
+
+void radix_insert_n(void *_self, const char *key, const size_t len, const mval_t value) {
+    radix_t *self = _self;
+    assert(len < UINT32_MAX);
+
+    radix_node_t **ref = &self->root;
+    size_t depth = 0;
+    for (;;) {
+        radix_node_t *node = *ref;
+
+        if (node == NULL) {
+            radix_leaf_t *leaf = radix_leaf_new(self, key, len, value);
+            if (leaf == NULL)
+                return;
+            *ref = RADIX_TAG_LEAF(leaf);
+            self->count++;
+            return;
+        }
+
+        if (RADIX_IS_LEAF(node)) {
+            radix_leaf_t *old = RADIX_LEAF(node);
+            if (radix_leaf_match(old, key, len)) {
+                old->value = value;  // update existing value.
+                return;
+            }
+
+            // Ключи расходятся на байте depth + lcp: на месте листа
+            // появляется Node4 с общим префиксом и двумя листами.
+            size_t lcp = 0;
+            while ((uint8_t) old->key[depth + lcp] == RADIX_BYTE(key, len, depth + lcp))
+                lcp++;
+
+            radix_leaf_t *leaf = radix_leaf_new(self, key, len, value);
+            radix_node_t *n4 = radix_node_new(self, RADIX_NODE4);
+            if (leaf == NULL || n4 == NULL) {
+                if (leaf)
+                    radix_leaf_free(self, leaf);
+                if (n4)
+                    radix_node_free(self, n4);
+                return;
+            }
+
+            n4->prefix_len = lcp;
+            memcpy(n4->prefix, key + depth, MIN(lcp, RADIX_MAX_PREFIX));
+            radix_add_child(n4, old->key[depth + lcp], node);
+            radix_add_child(n4, RADIX_BYTE(key, len, depth + lcp), RADIX_TAG_LEAF(leaf));
+            *ref = n4;
+            self->count++;
+            return;
+        }
+
+        if (node->prefix_len > 0) {
+            const size_t p = radix_prefix_mismatch(node, key, len, depth);
+            if (p < node->prefix_len) {
+                // Ключ расходится с префиксом узла: над узлом появляется
+                // Node4 с совпавшей частью префикса.
+                radix_leaf_t *leaf = radix_leaf_new(self, key, len, value);
+                radix_node_t *n4 = radix_node_new(self, RADIX_NODE4);
+                if (leaf == NULL || n4 == NULL) {
+                    if (leaf)
+                        radix_leaf_free(self, leaf);
+                    if (n4)
+                        radix_node_free(self, n4);
+                    return;
+                }
+
+                n4->prefix_len = p;
+                memcpy(n4->prefix, node->prefix, MIN(p, RADIX_MAX_PREFIX));
+
+                // Оставшаяся после байта p часть префикса остаётся в узле.
+                uint8_t c;
+                node->prefix_len -= p + 1;
+                if (node->prefix_len + p + 1 <= RADIX_MAX_PREFIX) {
+                    c = node->prefix[p];
+                    memmove(node->prefix, &node->prefix[p + 1], node->prefix_len);
+                } else {
+                    const radix_leaf_t *any = radix_any_leaf(node);
+                    c = any->key[depth + p];
+                    memcpy(node->prefix, &any->key[depth + p + 1],
+                           MIN(node->prefix_len, RADIX_MAX_PREFIX));
+                }
+
+                radix_add_child(n4, c, node);
+                radix_add_child(n4, RADIX_BYTE(key, len, depth + p), RADIX_TAG_LEAF(leaf));
+                *ref = n4;
+                self->count++;
+                return;
+            }
+            depth += node->prefix_len;
+        }
+
+        const uint8_t c = RADIX_BYTE(key, len, depth);
+        radix_node_t **child = radix_find_child(node, c);
+        if (child != NULL) {
+            ref = child;
+            depth++;
+            continue;
+        }
+
+        radix_leaf_t *leaf = radix_leaf_new(self, key, len, value);
+        if (leaf == NULL)
+            return;
+        if (node->n == radix_node_cap[node->type]
+            && radix_node_resize(self, ref, node->type + 1) != 0) {
+            radix_leaf_free(self, leaf);
+            return;
+        }
+        radix_add_child(*ref, c, RADIX_TAG_LEAF(leaf));
+        self->count++;
+        return;
+    }
+}
+
+int radix_remove_n(void *_self, const char *key, const size_t len) {
+    radix_t *self = _self;
+
+    radix_node_t **ref = &self->root;
+    size_t depth = 0;
+    if (*ref == NULL)
+        return 0;
+
+    if (RADIX_IS_LEAF(*ref)) {
+        radix_leaf_t *leaf = RADIX_LEAF(*ref);
+        if (!radix_leaf_match(leaf, key, len))
+            return 0;
+        radix_leaf_free(self, leaf);
+        *ref = NULL;
+        self->count--;
+        return 1;
+    }
+
+    for (;;) {
+        radix_node_t *node = *ref;
+
+        if (radix_prefix_mismatch(node, key, len, depth) != node->prefix_len)
+            return 0;
+        depth += node->prefix_len;
+
+        const uint8_t c = RADIX_BYTE(key, len, depth);
+        radix_node_t **child = radix_find_child(node, c);
+        if (child == NULL)
+            return 0;
+
+        if (RADIX_IS_LEAF(*child)) {
+            radix_leaf_t *leaf = RADIX_LEAF(*child);
+            if (!radix_leaf_match(leaf, key, len))
+                return 0;
+            radix_leaf_free(self, leaf);
+            radix_remove_child(self, ref, c);
+            self->count--;
+            return 1;
+        }
+
+        ref = child;
+        depth++;
+    }
+}
+
+// Элемент стека обхода: узел и наименьший байт ещё не пройденных детей.
+typedef struct {
+    const radix_node_t *node;
+    int                 next;
+} radix_scan_frame_t;
+
+// Обходит поддерево в порядке возрастания ключей. Глубина дерева
+// ограничена только длиной ключей, поэтому стек растёт в куче.
+static int radix_scan(const radix_node_t *root, const map_range_cb_t callback, void *arg) {
+    if (RADIX_IS_LEAF(root)) {
+        const radix_leaf_t *leaf = RADIX_LEAF(root);
+        callback(leaf->key, leaf->value, arg);
+        return 0;
+    }
+
+    size_t cap = 16, top = 0;
+    radix_scan_frame_t *stack = malloc(cap * sizeof(radix_scan_frame_t));
+    if (stack == NULL)
+        return ENOMEM;
+    stack[top++] = (radix_scan_frame_t){root, 0};
+
+    int err = 0;
+    while (top > 0) {
+        radix_scan_frame_t *frame = &stack[top - 1];
+        radix_node_t *child;
+        const int c = frame->next < 256 ? radix_next_child(frame->node, frame->next, &child) : -1;
+        if (c < 0) {
+            top--;
+            continue;
+        }
+        frame->next = c + 1;
+
+        if (RADIX_IS_LEAF(child)) {
+            const radix_leaf_t *leaf = RADIX_LEAF(child);
+            if (callback(leaf->key, leaf->value, arg))
+                break;
+            continue;
+        }
+
+        if (top == cap) {
+            radix_scan_frame_t *grown = realloc(stack, 2 * cap * sizeof(radix_scan_frame_t));
+            if (grown == NULL) {
+                err = ENOMEM;
+                break;
+            }
+            stack = grown;
+            cap *= 2;
+        }
+        stack[top++] = (radix_scan_frame_t){child, 0};
+    }
+
+    free(stack);
+    return err;
+}
+
+int radix_prefix_scan(const void *_self, const char *prefix, const size_t len,
+                      const map_range_cb_t callback, void *arg) {
+    const radix_t *self = _self;
+    assert(*(const imap_t *const *) _self == &RadixTreeClass);
+    assert(callback);
+
+    const radix_node_t *node = self->root;
+    size_t depth = 0;
+    while (node != NULL) {
+        if (RADIX_IS_LEAF(node)) {
+            const radix_leaf_t *leaf = RADIX_LEAF(node);
+            if (leaf->len >= len && memcmp(leaf->key, prefix, len) == 0)
+                callback(leaf->key, leaf->value, arg);
+            return 0;
+        }
+
+        // Сравнивается часть префикса узла, приходящаяся на искомый префикс.
+        // Завершающий '\0' искомого префикса не сравнивается.
+        const size_t rest = len - depth;
+        const size_t n = MIN(node->prefix_len, rest);
+        const size_t stored = MIN(n, RADIX_MAX_PREFIX);
+        if (memcmp(node->prefix, prefix + depth, stored) != 0)
+            return 0;
+        if (n > stored && memcmp(radix_any_leaf(node)->key + depth + stored,
+                                 prefix + depth + stored, n - stored) != 0)
+            return 0;
+
+        // Все ключи поддерева начинаются с искомого префикса.
+        if (node->prefix_len >= rest)
+            return radix_scan(node, callback, arg);
+
+        depth += node->prefix_len;
+        radix_node_t **child = radix_find_child((radix_node_t *) node, (uint8_t) prefix[depth]);
+        if (child == NULL)
+            return 0;
+        node = *child;
+        depth++;
+
+        if (depth == len && node != NULL)
+            return radix_scan(node, callback, arg);
+    }
+
+    return 0;
+}
+
+radix_stats_t radix_stats(const void *_self) {
+    const radix_t *self = _self;
+    assert(*(const imap_t *const *) _self == &RadixTreeClass);
+
+    size_t bytes = 0;
+    for (int type = 0; type < RADIX_NODE_TYPES; type++)
+        bytes += self->nodes[type] * radix_node_size[type];
+
+    return (radix_stats_t){
+        .count      = self->count,
+        .node4      = self->nodes[RADIX_NODE4],
+        .node16     = self->nodes[RADIX_NODE16],
+        .node48     = self->nodes[RADIX_NODE48],
+        .node256    = self->nodes[RADIX_NODE256],
+        .node_bytes = bytes,
+    };
+}
+
+const imap_t RadixTreeClass = {
+    .size     = sizeof(radix_t),
+    .ctor     = radix_ctor,
+    .dtor     = radix_dtor,
+    .insert_n = radix_insert_n,
+    .lookup_n = radix_lookup_n,
+    .remove_n = radix_remove_n,
+};
@@ -0,0 +1,277 @@
+#include "rhmap.h"
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdlib.h>
+
+#include "arena.h"
+#include "err.h"
+#include "hash.h"
+
+
+#define RHMAP_INITIAL_CAPACITY 16
+// Максимальная доля занятых ячеек: 9/10.
+#define RHMAP_MAX_LOAD_NUM 9
+#define RHMAP_MAX_LOAD_DEN 10
+
+
+// Ячейка таблицы. Пустая ячейка имеет key == NULL.
+typedef struct {
+    hash_t     hash;
+    mval_t     value;
+    mut_mkey_t key;
+} rhmap_entry_t;
+
+typedef struct {
+    // Реализация интерфейса imap_t.
+    const imap_t *class;
+
+    // Массив ячеек количеством cap.
+    rhmap_entry_t *entries;
+
+    // Количество ячеек, степень двойки.
+    size_t cap;
+
+    // Количество занятых ячеек.
+    size_t count;
+
+    // Хэш-функция.
+    hash_func_t hash;
+
+    // Зерно хэш-функции, генерируется случайно при создании мапы.
+    hash_t seed;
+
+    // Арена для ключей.
+    arena_t arena;
+} rhmap_t;
+
+// Необходимо для валидной реализации интерфейса.
+_Static_assert(offsetof(rhmap_t, class) == 0);
+
+
+static inline hash_t rhmap_hash(const rhmap_t *self, const char *key, const size_t len) {
+    return hash_mix(self->hash(self->seed, key, len));
+}
+
+// Начальная ячейка записи с хэшем hash.
+static inline size_t rhmap_home(const rhmap_t *self, const hash_t hash) {
+    return hash & (self->cap - 1);
+}
+
+// Длина пробы записи с хэшем hash, хранящейся в ячейке pos.
+static inline size_t rhmap_probe_len(const rhmap_t *self, const hash_t hash, const size_t pos) {
+    return (pos - rhmap_home(self, hash)) & (self->cap - 1);
+}
+
+void *rhmap_ctor(void *_self, va_list *ap) {
+    rhmap_t *self = _self;
+
+    self->cap = RHMAP_INITIAL_CAPACITY;
+    self->count = 0;
+    self->entries = calloc(self->cap, sizeof(rhmap_entry_t));
+    if (self->entries == NULL)
+        return ERR_PTR(-ENOMEM);
+
+    self->seed = rand();
+    self->hash = va_arg(*ap, hash_func_t);
+    assert(self->hash != NULL);
+
+    arena_init(&self->arena);
+
+    return self;
+}
+
+void rhmap_dtor(void *_self) {
+    rhmap_t *self = _self;
+
+    free(self->entries);
+    self->entries = NULL;
+
+    arena_destroy(&self->arena);
+}
+
+// Размещает запись в таблице, вытесняя записи с меньшей длиной пробы.
+// Ключ должен отсутствовать в таблице, а в таблице должна быть
+// свободная ячейка.
+static void rhmap_place(rhmap_t *self, rhmap_entry_t entry) {
+    size_t pos = rhmap_home(self, entry.hash);
+    size_t dist = 0;
+
+    while (self->entries[pos].key != NULL) {
+        const size_t other = rhmap_probe_len(self, self->entries[pos].hash, pos);
+        if (other < dist) {
+            // "Богатая" запись уступает ячейку "бедной" и продолжает поиск.
+            const rhmap_entry_t tmp = self->entries[pos];
+            self->entries[pos] = entry;
+            entry = tmp;
+            dist = other;
+        }
+        pos = (pos + 1) & (self->cap - 1);
+        dist++;
+    }
+
+    self->entries[pos] = entry;
+}
+
+// Возвращает номер ячейки с ключом key или -1, если ключа нет в таблице.
+static ptrdiff_t rhmap_find(const rhmap_t *self, const char *key, const size_t len, const hash_t hash) {
+    size_t pos = rhmap_home(self, hash);
+
+    for (size_t dist = 0;; dist++) {
+        const rhmap_entry_t *entry = &self->entries[pos];
+        // Если встречена пустая ячейка или запись, которая ближе к своей
+        // начальной ячейке, чем искомая, то при вставке искомая запись
+        // вытеснила бы её, значит ключа в таблице нет.
+        if (entry->key == NULL || rhmap_probe_len(self, entry->hash, pos) < dist)
+            return -1;
+        if (entry->hash == hash && STRZ_EQ(entry->key, key, len))
+            return (ptrdiff_t) pos;
+        pos = (pos + 1) & (self->cap - 1);
+    }
+}
+
+// Перестраивает таблицу под cap ячеек, cap - степень двойки. Хэши
+// хранятся в ячейках, поэтому хэш-функция не вызывается, а ключи
+// не копируются.
+static int rhmap_resize(rhmap_t *self, const size_t cap) {
+    rhmap_entry_t *old_entries = self->entries;
+    const size_t old_cap = self->cap;
+
+    rhmap_entry_t *tmp = calloc(cap, sizeof(rhmap_entry_t));
+    if (tmp == NULL)
+        return ENOMEM;
+    self->entries = tmp;
+    self->cap = cap;
+
+    for (size_t i = 0; i < old_cap; i++) {
+        if (old_entries[i].key != NULL)
+            rhmap_place(self, old_entries[i]);
+    }
+
+    free(old_entries);
+
+    return 0;
+}
+
+static int rhmap_grow(rhmap_t *self) {
+    return rhmap_resize(self, self->cap * 2);
+}
+
+int rhmap_reserve(void *_self, const size_t n) {
+    rhmap_t *self = _self;
+
+    // Наименьшая ёмкость, при которой n записей не превышают 9/10.
+    size_t cap = self->cap;
+    while (n * RHMAP_MAX_LOAD_DEN > cap * RHMAP_MAX_LOAD_NUM)
+        cap *= 2;
+
+    if (cap == self->cap)
+        return 0;
+    return rhmap_resize(self, cap);
+}
+
+void rhmap_insert_n(void *_self, const char *key, const size_t len, const mval_t value) {
+    rhmap_t *self = _self;
+
+    const hash_t hash = rhmap_hash(self, key, len);
+
+    const ptrdiff_t found = rhmap_find(self, key, len, hash);
+    if (found >= 0) {
+        self->entries[found].value = value;    // update existing value.
+        return;
+    }
+
+    if ((self->count + 1) * RHMAP_MAX_LOAD_DEN > self->cap * RHMAP_MAX_LOAD_NUM) {
+        if (rhmap_grow(self) != 0)
+            return;
+    }
+
+    mut_mkey_t dup = arena_strndup(&self->arena, key, len);
+    if (dup == NULL)
+        return;
+
+    rhmap_place(self, (rhmap_entry_t){
+        .hash  = hash,
+        .value = value,
+        .key   = dup,
+    });
+    self->count++;
+}
+
+map_res_t rhmap_lookup_n(const void *_self, const char *key, const size_t len) {
+    const rhmap_t *self = _self;
+
+    const ptrdiff_t found = rhmap_find(self, key, len, rhmap_hash(self, key, len));
+    if (found < 0)
+        return (map_res_t){0};
+
+    return (map_res_t){
+        .data = self->entries[found].value,
+        .ok   = 1,
+    };
+}
+
+int rhmap_remove_n(void *_self, const char *key, const size_t len) {
+    rhmap_t *self = _self;
+
+    const ptrdiff_t found = rhmap_find(self, key, len, rhmap_hash(self, key, len));
+    if (found < 0)
+        return 0;
+
+    arena_free_str(&self->arena, self->entries[found].key);
+    self->count--;
+
+    // Обратный сдвиг: следующие записи с ненулевой длиной пробы
+    // сдвигаются на одну ячейку назад, пока не встретится пустая ячейка
+    // или запись, находящаяся в своей начальной ячейке.
+    size_t pos = (size_t) found;
+    size_t next = (pos + 1) & (self->cap - 1);
+    while (self->entries[next].key != NULL
+           && rhmap_probe_len(self, self->entries[next].hash, next) > 0) {
+        self->entries[pos] = self->entries[next];
+        pos = next;
+        next = (next + 1) & (self->cap - 1);
+    }
+    self->entries[pos] = (rhmap_entry_t){0};
+
+    return 1;
+}
+
+rhmap_stats_t rhmap_stats(const void *_self) {
+    const rhmap_t *self = _self;
+    assert(*(const imap_t *const *) _self == &RobinHoodMapClass);
+
+    rhmap_stats_t stats = {
+        .count = self->count,
+        .cap   = self->cap,
+    };
+    if (self->count == 0)
+        return stats;
+
+    double sum = 0, sum_sq = 0;
+    for (size_t i = 0; i < self->cap; i++) {
+        if (self->entries[i].key == NULL)
+            continue;
+
+        const size_t len = rhmap_probe_len(self, self->entries[i].hash, i);
+        if (len > stats.max_probe)
+            stats.max_probe = len;
+        sum += (double) len;
+        sum_sq += (double) len * (double) len;
+    }
+
+    stats.mean_probe = sum / (double) self->count;
+    stats.var_probe = sum_sq / (double) self->count - stats.mean_probe * stats.mean_probe;
+
+    return stats;
+}
+
+const imap_t RobinHoodMapClass = {
+    .size   = sizeof(rhmap_t),
+    .ctor   = rhmap_ctor,
+    .dtor   = rhmap_dtor,
+    .insert_n = rhmap_insert_n,
+    .lookup_n = rhmap_lookup_n,
+    .remove_n = rhmap_remove_n,
+    .reserve = rhmap_reserve,
+};
@@ -4,12 +4,15 @@
 #include <stdarg.h>
 #include <stdlib.h>
 
+#include "arena.h"
 #include "err.h"
 #include "hash.h"
+#include "pool.h"
 
 #define SHMAP_DEFAULT_INITIAL_CAPACITY 16
 #define SHMAP_GROW_FACTOR 2
-#define SHMAP_HEIGHT_THRESHOLD_TO_GROW 3
+// Таблица растёт, когда средняя длина цепочки превышает SHMAP_MAX_LOAD_FACTOR.
+#define SHMAP_MAX_LOAD_FACTOR 1
 
 
 struct hlist;
@@ -17,6 +20,7 @@ typedef struct hlist hlist_t;
 
 struct hlist {
     mut_mkey_t key;
+    hash_t     hash;    // Полный хэш ключа, до взятия остатка от cap.
     mval_t     value;
     hlist_t   *next;
 };
@@ -24,9 +28,12 @@ struct hlist {
 typedef struct {
     const imap_t *class;
     size_t        cap;
+    size_t        count;  // Количество записей.
     hlist_t     **heads;
     hash_t        seed;
     hash_func_t   hash;
+    pool_t        nodes;  // Пул узлов цепочек.
+    arena_t       arena;  // Арена для ключей.
 } shmap_t;
 
 _Static_assert(offsetof(shmap_t, class) == 0);
@@ -38,31 +45,26 @@ _Static_assert(offsetof(shmap_t, class) == 0);
 #define hlist_for_each(head, node) \
     for (node = (head); node; node = node->next)
 
-#define hlist_for_each_safe(head, node, n) \
-    for (node = (head), n = (head)->next;  \
-         node;                             \
-         node = n, n = n ? n->next : NULL)
+hlist_t *hlist_new(pool_t *pool, arena_t *arena, const char *key, const size_t len,
+                   const hash_t hash, const mval_t value) {
+    mut_mkey_t dup = arena_strndup(arena, key, len);
+    if (dup == NULL)
+        return ERR_PTR(-ENOMEM);
 
-hlist_t *hlist_new(mkey_t key, const mval_t value) {
-    hlist_t *self = malloc(sizeof(hlist_t));
-    if (self == NULL)
+    hlist_t *self = pool_alloc(pool);
+    if (self == NULL) {
+        arena_free(arena, dup, len + 1);
         return ERR_PTR(-ENOMEM);
+    }
 
-    self->key = strdup(key);
+    self->key = dup;
+    self->hash = hash;
     self->value = value;
     self->next = NULL;
 
     return self;
 }
 
-hlist_t *hlist_insert_head(hlist_t *head, mkey_t key, mval_t value) {
-    hlist_t *node = hlist_new(key, value);
-    if (IS_ERR(node))
-        return ERR_CAST(node);
-    node->next = head;
-    return node;
-}
-
 size_t hlist_count(const hlist_t *head) {
     size_t count = 0;
     for (const hlist_t *node = head; node; node = node->next)
@@ -70,40 +72,29 @@ size_t hlist_count(const hlist_t *head) {
     return count;
 }
 
-hlist_t *hlist_lookup(hlist_t *head, mkey_t key) {
+hlist_t *hlist_lookup(hlist_t *head, const char *key, const size_t len, const hash_t hash) {
     hlist_t *node;
     hlist_for_each(head, node) {
-        if (STR_EQ(node->key, key))
+        if (node->hash == hash && STRZ_EQ(node->key, key, len))
             return node;
     }
     return NULL;
 }
 
-hlist_t *hlist_delete(hlist_t *head, mkey_t key) {
-    if (head == NULL)
-        return NULL;
-
-    if (STR_EQ(head->key, key)) {
-        hlist_t *next = head->next;
-        free(head->key);
-        free(head);
-        return next;
-    }
-
-    hlist_t *prev = head;
-    hlist_t *node;
-    hlist_for_each(head->next, node) {
-        if (STR_EQ(node->key, key)) {
-            prev->next = node->next;
-            free(node->key);
-            free(node);
-            return head;
+// Удаляет узел с ключом key из цепочки, на начало которой указывает head.
+// Возвращает 1, если узел был удалён, иначе 0.
+int hlist_delete(pool_t *pool, arena_t *arena, hlist_t **head,
+                 const char *key, const size_t len, const hash_t hash) {
+    for (hlist_t **link = head; *link; link = &(*link)->next) {
+        hlist_t *node = *link;
+        if (node->hash == hash && STRZ_EQ(node->key, key, len)) {
+            *link = node->next;
+            arena_free(arena, node->key, len + 1);
+            pool_free(pool, node);
+            return 1;
         }
-        prev = node;
-        node = node->next;
     }
-
-    return head;
+    return 0;
 }
 
 void *shmap_ctor(void *_class, va_list *ap) {
@@ -112,11 +103,15 @@ void *shmap_ctor(void *_class, va_list *ap) {
     self->cap = va_arg(*ap, size_t);
     if (self->cap == 0)
         self->cap = SHMAP_DEFAULT_INITIAL_CAPACITY;
+    self->count = 0;
 
     self->heads = calloc(self->cap, sizeof(hlist_t *));
     if (self->heads == NULL)
         return ERR_PTR(-ENOMEM);
 
+    pool_init(&self->nodes, sizeof(hlist_t));
+    arena_init(&self->arena);
+
     self->seed = rand();
     self->hash = va_arg(*ap, hash_func_t);
     assert(self->hash != NULL);
@@ -127,91 +122,128 @@ void *shmap_ctor(void *_class, va_list *ap) {
 void shmap_dtor(void *_class) {
     shmap_t *self = _class;
 
-    hlist_t **head;
-    shmap_heads_for_each(self, head) {
-        if (*head == NULL)
-            continue;
-
-        hlist_t *node, *n;
-        hlist_for_each_safe(*head, node, n) {
-            free(node);
-        }
-    }
-
     free(self->heads);
-}
 
-hash_t shmap_top_hash(const shmap_t *self, const mkey_t key) {
-    return self->hash(self->seed, key) % self->cap;
+    // Узлы и ключи освобождаются разом, без обхода цепочек.
+    pool_destroy(&self->nodes);
+    arena_destroy(&self->arena);
 }
 
-int shmap_grow(shmap_t *self) {
+// Перестраивает таблицу под cap цепочек. Узлы списков не копируются,
+// а хэш-функция не вызывается: позиция вычисляется по хэшу в узле.
+static int shmap_resize(shmap_t *self, const size_t cap) {
     hlist_t **old_heads = self->heads;
     const size_t old_cap = self->cap;
-    memcpy(old_heads, self->heads, self->cap * sizeof(hlist_t *));
 
-    self->cap *= SHMAP_GROW_FACTOR;
-    void *tmp = malloc(self->cap * sizeof(hlist_t *));
+    void *tmp = calloc(cap, sizeof(hlist_t *));
     if (tmp == NULL)
         return ENOMEM;
-    free(self->heads);
     self->heads = tmp;
+    self->cap = cap;
 
     for (size_t i = 0; i < old_cap; i++) {
-        hlist_t *node, *n;
-        hlist_for_each_safe(old_heads[i], node, n) {
-            const hash_t top_hash = shmap_top_hash(self, node->key);
-            node->next = self->heads[top_hash];
-            self->heads[top_hash] = node;
+        hlist_t *node = old_heads[i];
+        while (node) {
+            hlist_t *next = node->next;
+            const size_t pos = node->hash % self->cap;
+            node->next = self->heads[pos];
+            self->heads[pos] = node;
+            node = next;
         }
     }
     free(old_heads);
+
+    return 0;
+}
+
+int shmap_grow(shmap_t *self) {
+    return shmap_resize(self, self->cap * SHMAP_GROW_FACTOR);
 }
 
-void shmap_insert(void *_self, const mkey_t key, const mval_t value) {
+// Резервирует цепочки так, чтобы n записей не превышали SHMAP_MAX_LOAD_FACTOR.
+int shmap_reserve(void *_self, const size_t n) {
     shmap_t *self = _self;
 
-    const hash_t top_hash = shmap_top_hash(self, key);
-    self->heads[top_hash] = hlist_insert_head(self->heads[top_hash], key, value);
+    const size_t cap = (n + SHMAP_MAX_LOAD_FACTOR - 1) / SHMAP_MAX_LOAD_FACTOR;
+    if (cap <= self->cap)
+        return 0;
+    return shmap_resize(self, cap);
+}
+
+void shmap_insert_n(void *_self, const char *key, const size_t len, const mval_t value) {
+    shmap_t *self = _self;
+
+    const hash_t hash = self->hash(self->seed, key, len);
+    hlist_t **head = &self->heads[hash % self->cap];
+
+    hlist_t *found = hlist_lookup(*head, key, len, hash);
+    if (found) {
+        found->value = value;    // update existing value.
+        return;
+    }
 
-    while (hlist_count(self->heads[top_hash]) > SHMAP_HEIGHT_THRESHOLD_TO_GROW)
+    hlist_t *node = hlist_new(&self->nodes, &self->arena, key, len, hash, value);
+    if (IS_ERR(node))
+        return;
+    node->next = *head;
+    *head = node;
+    self->count++;
+
+    if (self->count > self->cap * SHMAP_MAX_LOAD_FACTOR)
         shmap_grow(self);
 }
 
-map_res_t shmap_lookup(const void *_self, const mkey_t key) {
+map_res_t shmap_lookup_n(const void *_self, const char *key, const size_t len) {
     const shmap_t *self = _self;
 
-    hlist_t **head;
-    shmap_heads_for_each(self, head) {
-        const hlist_t *found = hlist_lookup(*head, key);
-        if (found) {
-            return (map_res_t){
-                .data = found->value,
-                .ok   = 1,
-            };
-        }
-    };
+    const hash_t hash = self->hash(self->seed, key, len);
+    const hlist_t *found = hlist_lookup(self->heads[hash % self->cap], key, len, hash);
+    if (found == NULL)
+        return (map_res_t){0};
 
-    return (map_res_t){0};
+    return (map_res_t){
+        .data = found->value,
+        .ok   = 1,
+    };
 }
 
-int shmap_remove(void *_self, const mkey_t key) {
+int shmap_remove_n(void *_self, const char *key, const size_t len) {
     shmap_t *self = _self;
 
-    if (!shmap_lookup(self, key).ok)
+    const hash_t hash = self->hash(self->seed, key, len);
+    if (!hlist_delete(&self->nodes, &self->arena, &self->heads[hash % self->cap], key, len, hash))
         return 0;
 
-    const hash_t top_hash = shmap_top_hash(self, key);
-    self->heads[top_hash] = hlist_delete(self->heads[top_hash], key);
-
+    self->count--;
     return 1;
 }
 
+shmap_stats_t shmap_stats(const void *_self) {
+    const shmap_t *self = _self;
+    assert(*(const imap_t *const *) _self == &SimpleHashMapClass);
+
+    shmap_stats_t stats = {
+        .count  = self->count,
+        .chains = self->cap,
+    };
+
+    hlist_t **head;
+    shmap_heads_for_each(self, head) {
+        const size_t len = hlist_count(*head);
+        if (len > stats.max_chain)
+            stats.max_chain = len;
+        stats.hist[len < SHMAP_STATS_HIST ? len : SHMAP_STATS_HIST - 1]++;
+    }
+
+    return stats;
+}
+
 const imap_t SimpleHashMapClass = {
     .size   = sizeof(shmap_t),
     .ctor   = shmap_ctor,
     .dtor   = shmap_dtor,
-    .insert = shmap_insert,
-    .lookup = shmap_lookup,
-    .remove = shmap_remove,
+    .insert_n = shmap_insert_n,
+    .lookup_n = shmap_lookup_n,
+    .remove_n = shmap_remove_n,
+    .reserve = shmap_reserve,
 };
@@ -0,0 +1,340 @@
+#include "swissmap.h"
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "arena.h"
+#include "err.h"
+#include "hash.h"
+
+
+#define SWISSMAP_GROUP_SIZE 16
+#define SWISSMAP_INITIAL_GROUPS 1
+// Максимальная доля занятых и удалённых ячеек: 7/8.
+#define SWISSMAP_MAX_LOAD_NUM 7
+#define SWISSMAP_MAX_LOAD_DEN 8
+
+// Управляющие байты. Старший бит установлен только у свободных ячеек,
+// у занятых ячеек в байте хранятся 7 бит хэша (H2).
+#define CTRL_EMPTY   ((int8_t) -128) // 0b10000000
+#define CTRL_DELETED ((int8_t) -2)   // 0b11111110
+
+
+typedef struct {
+    hash_t     hash;
+    mval_t     value;
+    mut_mkey_t key;
+} swissmap_slot_t;
+
+typedef struct {
+    // Реализация интерфейса imap_t.
+    const imap_t *class;
+
+    // Управляющие байты, по одному на ячейку, количеством cap.
+    int8_t *ctrl;
+
+    // Ячейки таблицы количеством cap.
+    swissmap_slot_t *slots;
+
+    // Количество групп, степень двойки.
+    size_t groups;
+
+    // Количество ячеек, groups * SWISSMAP_GROUP_SIZE.
+    size_t cap;
+
+    // Количество занятых ячеек.
+    size_t count;
+
+    // Количество удалённых ячеек (CTRL_DELETED).
+    size_t deleted;
+
+    // Хэш-функция.
+    hash_func_t hash;
+
+    // Зерно хэш-функции, генерируется случайно при создании мапы.
+    hash_t seed;
+
+    // Арена для ключей.
+    arena_t arena;
+} swissmap_t;
+
+// Необходимо для валидной реализации интерфейса.
+_Static_assert(offsetof(swissmap_t, class) == 0);
+
+
+// Битовая маска ячеек группы: i-ый бит установлен, если
+// i-ый управляющий байт группы удовлетворяет условию.
+typedef unsigned swissmap_mask_t;
+
+#define swissmap_mask_for_each(mask, i) \
+    for (; (mask) && ((i) = __builtin_ctz(mask), 1); (mask) &= (mask) - 1)
+
+// Маска ячеек группы с управляющим байтом, равным tag.
+static inline swissmap_mask_t swissmap_group_match(const int8_t *group, const int8_t tag) {
+#if defined(__SSE2__)
+    const __m128i ctrl = _mm_loadu_si128((const __m128i *) group);
+    return (swissmap_mask_t) _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag)));
+#else
+    swissmap_mask_t mask = 0;
+    for (int i = 0; i < SWISSMAP_GROUP_SIZE; i++)
+        mask |= (swissmap_mask_t) (group[i] == tag) << i;
+    return mask;
+#endif
+}
+
+// Маска свободных (пустых или удалённых) ячеек группы.
+static inline swissmap_mask_t swissmap_group_match_free(const int8_t *group) {
+#if defined(__SSE2__)
+    // У свободных ячеек установлен старший бит.
+    return (swissmap_mask_t) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) group));
+#else
+    swissmap_mask_t mask = 0;
+    for (int i = 0; i < SWISSMAP_GROUP_SIZE; i++)
+        mask |= (swissmap_mask_t) (group[i] < 0) << i;
+    return mask;
+#endif
+}
+
+// Хэш ключа дополнительно перемешивается (hash_mix), чтобы и номер группы
+// (младшие биты), и тег (старшие 7 бит) зависели от всех байтов ключа.
+// Простые хэш-функции, например djb2, плохо перемешивают старшие биты
+// для коротких ключей.
+static inline hash_t swissmap_hash(const swissmap_t *self, const char *key, const size_t len) {
+    return hash_mix(self->hash(self->seed, key, len));
+}
+
+// Тег ячейки: старшие 7 бит хэша.
+static inline int8_t swissmap_h2(const hash_t hash) {
+    return (int8_t) (hash >> 25);
+}
+
+static int swissmap_alloc(swissmap_t *self, const size_t groups) {
+    const size_t cap = groups * SWISSMAP_GROUP_SIZE;
+
+    int8_t *ctrl = malloc(cap);
+    swissmap_slot_t *slots = malloc(cap * sizeof(swissmap_slot_t));
+    if (ctrl == NULL || slots == NULL) {
+        free(ctrl);
+        free(slots);
+        return ENOMEM;
+    }
+    memset(ctrl, CTRL_EMPTY, cap);
+
+    self->ctrl = ctrl;
+    self->slots = slots;
+    self->groups = groups;
+    self->cap = cap;
+    self->count = 0;
+    self->deleted = 0;
+
+    return 0;
+}
+
+void *swissmap_ctor(void *_self, va_list *ap) {
+    swissmap_t *self = _self;
+
+    if (swissmap_alloc(self, SWISSMAP_INITIAL_GROUPS) != 0)
+        return ERR_PTR(-ENOMEM);
+
+    self->seed = rand();
+    self->hash = va_arg(*ap, hash_func_t);
+    assert(self->hash != NULL);
+
+    arena_init(&self->arena);
+
+    return self;
+}
+
+void swissmap_dtor(void *_self) {
+    swissmap_t *self = _self;
+
+    free(self->ctrl);
+    free(self->slots);
+    self->ctrl = NULL;
+    self->slots = NULL;
+
+    arena_destroy(&self->arena);
+}
+
+// Последовательность проб по группам: g, g + 1, g + 3, g + 6, ...
+// При количестве групп, равном степени двойки, обходит все группы.
+#define swissmap_probe_for_each(self, hash, g, step)                    \
+    for ((g) = (hash) & ((self)->groups - 1), (step) = 0;              \
+         (step) < (self)->groups;                                       \
+         (step)++, (g) = ((g) + (step)) & ((self)->groups - 1))
+
+// Возвращает номер ячейки с ключом key или -1, если ключа нет в таблице.
+static ptrdiff_t swissmap_find(const swissmap_t *self, const char *key, const size_t len, const hash_t hash) {
+    const int8_t h2 = swissmap_h2(hash);
+
+    size_t g, step;
+    swissmap_probe_for_each(self, hash, g, step) {
+        const int8_t *group = self->ctrl + g * SWISSMAP_GROUP_SIZE;
+
+        swissmap_mask_t mask = swissmap_group_match(group, h2);
+        int i;
+        swissmap_mask_for_each(mask, i) {
+            const size_t pos = g * SWISSMAP_GROUP_SIZE + i;
+            const swissmap_slot_t *slot = &self->slots[pos];
+            if (slot->hash == hash && STRZ_EQ(slot->key, key, len))
+                return (ptrdiff_t) pos;
+        }
+
+        // Пустая ячейка в группе означает, что ключ в неё не попал
+        // бы дальше по последовательности проб.
+        if (swissmap_group_match(group, CTRL_EMPTY))
+            return -1;
+    }
+
+    return -1;
+}
+
+// Возвращает номер первой свободной ячейки на последовательности проб.
+// Таблица гарантированно содержит свободные ячейки.
+static size_t swissmap_find_free(const swissmap_t *self, const hash_t hash) {
+    size_t g, step;
+    swissmap_probe_for_each(self, hash, g, step) {
+        const swissmap_mask_t mask = swissmap_group_match_free(self->ctrl + g * SWISSMAP_GROUP_SIZE);
+        if (mask)
+            return g * SWISSMAP_GROUP_SIZE + __builtin_ctz(mask);
+    }
+
+    assert(0 && "swissmap: no free slots");
+    return 0;
+}
+
+// Перестраивает таблицу под заданное количество групп.
+// Хэши хранятся в ячейках, поэтому хэш-функция не вызывается,
+// а ключи не копируются.
+static int swissmap_rehash(swissmap_t *self, const size_t groups) {
+    int8_t *old_ctrl = self->ctrl;
+    swissmap_slot_t *old_slots = self->slots;
+    const size_t old_cap = self->cap;
+    const size_t count = self->count;
+
+    if (swissmap_alloc(self, groups) != 0)
+        return ENOMEM;
+
+    for (size_t i = 0; i < old_cap; i++) {
+        if (old_ctrl[i] < 0)
+            continue;
+
+        const size_t pos = swissmap_find_free(self, old_slots[i].hash);
+        self->ctrl[pos] = old_ctrl[i];
+        self->slots[pos] = old_slots[i];
+    }
+    self->count = count;
+
+    free(old_ctrl);
+    free(old_slots);
+
+    return 0;
+}
+
+int swissmap_reserve(void *_self, const size_t n) {
+    swissmap_t *self = _self;
+
+    // Наименьшее количество групп, при котором n записей не превышают 7/8.
+    size_t groups = self->groups;
+    while (n * SWISSMAP_MAX_LOAD_DEN > groups * SWISSMAP_GROUP_SIZE * SWISSMAP_MAX_LOAD_NUM)
+        groups *= 2;
+
+    if (groups == self->groups)
+        return 0;
+    return swissmap_rehash(self, groups);
+}
+
+void swissmap_insert_n(void *_self, const char *key, const size_t len, const mval_t value) {
+    swissmap_t *self = _self;
+
+    const hash_t hash = swissmap_hash(self, key, len);
+
+    const ptrdiff_t found = swissmap_find(self, key, len, hash);
+    if (found >= 0) {
+        self->slots[found].value = value;    // update existing value.
+        return;
+    }
+
+    // Удалённые ячейки тоже удлиняют последовательности проб,
+    // поэтому учитываются при проверке заполненности.
+    if ((self->count + self->deleted + 1) * SWISSMAP_MAX_LOAD_DEN > self->cap * SWISSMAP_MAX_LOAD_NUM) {
+        // Если таблица заполнена в основном удалёнными ячейками,
+        // достаточно перестроить её без увеличения.
+        const size_t groups = self->count * 2 * SWISSMAP_MAX_LOAD_DEN < self->cap * SWISSMAP_MAX_LOAD_NUM
+            ? self->groups
+            : self->groups * 2;
+        if (swissmap_rehash(self, groups) != 0)
+            return;
+    }
+
+    mut_mkey_t dup = arena_strndup(&self->arena, key, len);
+    if (dup == NULL)
+        return;
+
+    const size_t pos = swissmap_find_free(self, hash);
+    if (self->ctrl[pos] == CTRL_DELETED)
+        self->deleted--;
+    self->ctrl[pos] = swissmap_h2(hash);
+    self->slots[pos] = (swissmap_slot_t){
+        .hash  = hash,
+        .value = value,
+        .key   = dup,
+    };
+    self->count++;
+}
+
+map_res_t swissmap_lookup_n(const void *_self, const char *key, const size_t len) {
+    const swissmap_t *self = _self;
+
+    const hash_t hash = swissmap_hash(self, key, len);
+    const ptrdiff_t found = swissmap_find(self, key, len, hash);
+    if (found < 0)
+        return (map_res_t){0};
+
+    return (map_res_t){
+        .data = self->slots[found].value,
+        .ok   = 1,
+    };
+}
+
+int swissmap_remove_n(void *_self, const char *key, const size_t len) {
+    swissmap_t *self = _self;
+
+    const hash_t hash = swissmap_hash(self, key, len);
+    const ptrdiff_t found = swissmap_find(self, key, len, hash);
+    if (found < 0)
+        return 0;
+
+    arena_free_str(&self->arena, self->slots[found].key);
+    self->slots[found].key = NULL;
+    self->count--;
+
+    // Если в группе есть пустая ячейка, то поиск остановится на этой группе
+    // в любом случае, и ячейку можно сделать пустой. Иначе нужна метка
+    // удалённой ячейки, чтобы не прервать последовательности проб других ключей.
+    const int8_t *group = self->ctrl + (found / SWISSMAP_GROUP_SIZE) * SWISSMAP_GROUP_SIZE;
+    if (swissmap_group_match(group, CTRL_EMPTY)) {
+        self->ctrl[found] = CTRL_EMPTY;
+    } else {
+        self->ctrl[found] = CTRL_DELETED;
+        self->deleted++;
+    }
+
+    return 1;
+}
+
+const imap_t SwissMapClass = {
+    .size   = sizeof(swissmap_t),
+    .ctor   = swissmap_ctor,
+    .dtor   = swissmap_dtor,
+    .insert_n = swissmap_insert_n,
+    .lookup_n = swissmap_lookup_n,
+    .remove_n = swissmap_remove_n,
+    .reserve = swissmap_reserve,
+};
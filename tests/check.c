@@ -14,10 +14,20 @@ int main(void) {
     srunner_add_suite(runner, check_vec_suite());
     srunner_add_suite(runner, check_slist_suite());
     srunner_add_suite(runner, check_dlist_suite());
+    srunner_add_suite(runner, check_hash_suite());
     srunner_add_suite(runner, check_bstree_suite());
     srunner_add_suite(runner, check_avltree_suite());
+    srunner_add_suite(runner, check_pavltree_suite());
+    srunner_add_suite(runner, check_bptree_suite());
+    srunner_add_suite(runner, check_radix_suite());
     srunner_add_suite(runner, check_shmap_suite());
     srunner_add_suite(runner, check_hmap_suite());
+    srunner_add_suite(runner, check_swissmap_suite());
+    srunner_add_suite(runner, check_rhmap_suite());
+    srunner_add_suite(runner, check_cuckoomap_suite());
+    srunner_add_suite(runner, check_bloom_suite());
+    srunner_add_suite(runner, check_bloommap_suite());
+    srunner_add_suite(runner, check_lrucache_suite());
     srunner_add_suite(runner, check_astack_suite());
     srunner_add_suite(runner, check_lstack_suite());
     srunner_add_suite(runner, check_flat_matrix_suite());
@@ -146,6 +146,25 @@ TCase *check_dlist_add_head_in_loop(void) {
     return tc;
 }
 
+START_TEST (test_dlist_del) {
+    dlist_pstring_del(b);
+
+    ck_assert_ptr_eq(b->next, b);
+    ck_assert_ptr_eq(b->prev, b);
+
+    ck_assert_true(dlist_pstring_is_first(head, c));
+    ck_assert_true(dlist_pstring_is_last(head, c));
+    ck_assert_ptr_eq(c->next, head);
+    ck_assert_ptr_eq(c->prev, head);
+} END_TEST
+
+TCase *check_dlist_del(void) {
+    TCase *tc = tcase_create("check_dlist_del");
+    tcase_add_checked_fixture(tc, setup_dlist, teardown_nodes);
+    tcase_add_test(tc, test_dlist_del);
+    return tc;
+}
+
 START_TEST (test_dlist_for_each) {
     const string_t *ordered[] = { "b", "c" };
     int i = 0;
@@ -243,6 +262,7 @@ Suite *check_dlist_suite(void) {
     suite_add_tcase(suite, check_dlist_add_tail_in_loop());
     suite_add_tcase(suite, check_dlist_add_head());
     suite_add_tcase(suite, check_dlist_add_head_in_loop());
+    suite_add_tcase(suite, check_dlist_del());
     suite_add_tcase(suite, check_dlist_for_each());
     suite_add_tcase(suite, check_dlist_for_each_safe());
     suite_add_tcase(suite, check_dlist_for_each_prev());
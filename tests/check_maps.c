@@ -1,11 +1,24 @@
 #include "check_maps.h"
 
+#include <pthread.h>
+#include <stdatomic.h>
+
 #include "avltree.h"
+#include "bloom.h"
+#include "bloommap.h"
+#include "bptree.h"
 #include "bstree.h"
+#include "cuckoomap.h"
+#include "err.h"
 #include "hash.h"
 #include "hmap.h"
+#include "lrucache.h"
 #include "map.h"
+#include "pavltree.h"
+#include "radix.h"
+#include "rhmap.h"
 #include "shmap.h"
+#include "swissmap.h"
 
 
 #define ck_assert_true(x) ck_assert_int_eq(!!(x), 1)
@@ -25,6 +38,18 @@ static void setup_avltree(void) {
     map = map_new(AVLTree);
 }
 
+static void setup_bptree(void) {
+    map = map_new(BPlusTree);
+}
+
+static void setup_pavltree(void) {
+    map = map_new(PersistentAVLTree);
+}
+
+static void setup_radix(void) {
+    map = map_new(RadixTree);
+}
+
 static void setup_shmap(void) {
     map = map_new(SimpleHashMap, 0, djb2);
 }
@@ -33,6 +58,26 @@ static void setup_hmap(void) {
     map = map_new(HashMap, djb2);
 }
 
+static void setup_swissmap(void) {
+    map = map_new(SwissMap, djb2);
+}
+
+static void setup_rhmap(void) {
+    map = map_new(RobinHoodMap, djb2);
+}
+
+static void setup_cuckoomap(void) {
+    map = map_new(CuckooMap, djb2);
+}
+
+static void setup_bloommap(void) {
+    map = map_new(BloomMap, (size_t) 1000, 0.01, djb2, AVLTree);
+}
+
+static void setup_lrucache(void) {
+    map = map_new(LRUCache, (size_t) 1024, djb2);
+}
+
 static void teardown_map(void) {
     map_destroy(map);
     map = NULL;
@@ -96,6 +141,984 @@ START_TEST (test_map_insert_update) {
     ck_assert_int_eq(res.data, 3);
 } END_TEST
 
+START_TEST (test_map_slices) {
+    // Ключи - подстроки одного буфера без '\0' между ними.
+    const string_t buf[] = "foofoobarfoobarbaz_long_enough_key";
+    const size_t   lens[] = { 3, 6, 9, sizeof(buf) - 1 };
+
+    for (size_t i = 0; i < LEN(lens); i++)
+        map_insert_n(map, buf, lens[i], (int) i);
+
+    for (size_t i = 0; i < LEN(lens); i++) {
+        const map_res_t res = map_lookup_n(map, buf, lens[i]);
+        ck_assert_true(res.ok);
+        ck_assert_int_eq(res.data, (int) i);
+    }
+
+    // Префиксы и продолжения сохранённых ключей не совпадают с ними.
+    ck_assert_false(map_lookup_n(map, buf, 2).ok);
+    ck_assert_false(map_lookup_n(map, buf, 4).ok);
+    ck_assert_false(map_lookup_n(map, buf, sizeof(buf) - 2).ok);
+
+    // Ключи, оканчивающиеся '\0', и ключи с длиной взаимозаменяемы.
+    ck_assert_int_eq(map_lookup(map, "foofoo").data, 1);
+    map_insert(map, "foofoobar", 7);
+    ck_assert_int_eq(map_lookup_n(map, buf, 9).data, 7);
+
+    ck_assert_true(map_remove_n(map, buf, 6));
+    ck_assert_false(map_remove_n(map, buf, 6));
+    ck_assert_false(map_lookup(map, "foofoo").ok);
+    ck_assert_true(map_lookup(map, "foo").ok);
+    ck_assert_true(map_remove(map, buf));
+    ck_assert_false(map_lookup_n(map, buf, sizeof(buf) - 1).ok);
+} END_TEST
+
+START_TEST (test_map_lookup_batch) {
+    // Количество ключей достаточно для роста хэш-таблиц во время поиска.
+    enum { N = 300 };
+    char       buf[2 * N][16];
+    mut_mkey_t keys[2 * N];
+    map_res_t  results[2 * N];
+
+    // Первая половина ключей вставляется, вторая - нет.
+    for (int i = 0; i < 2 * N; i++) {
+        snprintf(buf[i], sizeof(buf[i]), "k%d", i);
+        keys[i] = buf[i];
+        if (i < N)
+            map_insert(map, keys[i], i);
+    }
+
+    map_lookup_batch(map, keys, 2 * N, results);
+    for (int i = 0; i < 2 * N; i++) {
+        ck_assert_int_eq(results[i].ok, i < N);
+        ck_assert_int_eq(results[i].data, i < N ? i : 0);
+    }
+
+    map_lookup_batch(map, keys, 0, results);
+} END_TEST
+
+START_TEST (test_map_reserve) {
+    enum { N = 1000 };
+    char buf[N][16];
+
+    for (int i = 0; i < N; i++)
+        snprintf(buf[i], sizeof(buf[i]), "k%d", i);
+
+    // Резервирование сохраняет уже вставленные записи, в том числе
+    // во время роста таблицы.
+    for (int i = 0; i < N / 10; i++)
+        map_insert(map, buf[i], -i);
+    ck_assert_int_eq(map_reserve(map, N), 0);
+    ck_assert_int_eq(map_reserve(map, 1), 0);
+    for (int i = 0; i < N / 10; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).data, -i);
+
+    for (int i = 0; i < N; i++)
+        map_insert(map, buf[i], i);
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).data, i);
+} END_TEST
+
+START_TEST (test_map_remove_interleaved) {
+    enum { N = 1000 };
+    char buf[N][16];
+
+    // Ключи вставляются не по порядку, поэтому удаляемые узлы деревьев
+    // бывают и листьями, и узлами с одной или двумя ветвями.
+    for (int i = 0; i < N; i++) {
+        const int k = i * 7 % N;
+        snprintf(buf[k], sizeof(buf[k]), "k%d", k);
+        map_insert(map, buf[k], k);
+    }
+
+    for (int i = 0; i < N; i += 3)
+        ck_assert_true(map_remove(map, buf[i]));
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).ok, i % 3 != 0);
+    for (int i = 1; i < N; i += 3)
+        ck_assert_int_eq(map_lookup(map, buf[i]).data, i);
+
+    for (int i = 0; i < N; i += 3)
+        map_insert(map, buf[i], -i);
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).data, i % 3 ? i : -i);
+} END_TEST
+
+typedef struct {
+    char keys[16][16];
+    int  n;
+    int  limit;
+} range_acc_t;
+
+static int range_collect(const string_t *key, const mval_t value, void *arg) {
+    range_acc_t *acc = arg;
+    ck_assert_int_eq(atoi(key + 1), value);
+    snprintf(acc->keys[acc->n % 16], sizeof(acc->keys[0]), "%s", key);
+    acc->n++;
+    return acc->n == acc->limit;
+}
+
+START_TEST (test_map_iter) {
+    enum { N = 300 };
+    static char buf[N][16];
+
+    // Ключи вставляются по возрастанию, поэтому путь в BinarySearchTree
+    // длиннее, чем помещается в курсор.
+    for (int i = 0; i < N; i++) {
+        snprintf(buf[i], sizeof(buf[i]), "k%04d", i);
+        map_insert(map, buf[i], i);
+    }
+
+    map_iter_t it;
+    ck_assert_int_eq(map_iter_init(map, &it), 0);
+    ck_assert_ptr_null(it.key);
+
+    int i = 0;
+    for (int ok = map_iter_next(&it); ok; ok = map_iter_next(&it), i++) {
+        ck_assert_str_eq(it.key, buf[i]);
+        ck_assert_int_eq(it.value, i);
+    }
+    ck_assert_int_eq(i, N);
+
+    // Из конца map_iter_prev переходит к последнему ключу.
+    for (int ok = map_iter_prev(&it); ok; ok = map_iter_prev(&it))
+        ck_assert_str_eq(it.key, buf[--i]);
+    ck_assert_int_eq(i, 0);
+
+    ck_assert_true(map_iter_seek(&it, "k0150"));
+    ck_assert_str_eq(it.key, "k0150");
+    ck_assert_true(map_iter_seek(&it, "k0150~"));
+    ck_assert_str_eq(it.key, "k0151");
+    ck_assert_true(map_iter_prev(&it));
+    ck_assert_str_eq(it.key, "k0150");
+    ck_assert_true(map_iter_seek_n(&it, "k0150~", 4));
+    ck_assert_str_eq(it.key, "k0150");
+    ck_assert_true(map_iter_seek(&it, ""));
+    ck_assert_str_eq(it.key, "k0000");
+    ck_assert_false(map_iter_seek(&it, "z"));
+    ck_assert_ptr_null(it.key);
+    ck_assert_true(map_iter_prev(&it));
+    ck_assert_str_eq(it.key, "k0299");
+
+    // После удаления нечётных ключей обход проходит только чётные.
+    for (i = 1; i < N; i += 2)
+        ck_assert_true(map_remove(map, buf[i]));
+    ck_assert_int_eq(map_iter_init(map, &it), 0);
+    i = 0;
+    for (int ok = map_iter_next(&it); ok; ok = map_iter_next(&it), i += 2)
+        ck_assert_str_eq(it.key, buf[i]);
+    ck_assert_int_eq(i, N);
+
+    range_acc_t acc = {.limit = 0};
+    ck_assert_int_eq(map_range(map, "k0100", "k0131", range_collect, &acc), 0);
+    ck_assert_int_eq(acc.n, 16);
+    ck_assert_str_eq(acc.keys[0], "k0100");
+    ck_assert_str_eq(acc.keys[15], "k0130");
+
+    // Обход прекращается, когда callback возвращает не 0.
+    acc = (range_acc_t){.limit = 3};
+    ck_assert_int_eq(map_range(map, NULL, NULL, range_collect, &acc), 0);
+    ck_assert_int_eq(acc.n, 3);
+    ck_assert_str_eq(acc.keys[2], "k0004");
+
+    acc = (range_acc_t){.limit = 0};
+    ck_assert_int_eq(map_range(map, "k0297", NULL, range_collect, &acc), 0);
+    ck_assert_int_eq(acc.n, 1);
+    ck_assert_str_eq(acc.keys[0], "k0298");
+} END_TEST
+
+START_TEST (test_map_iter_shuffled) {
+    enum { N = 2000 };
+    static char buf[N][16];
+
+    for (int i = 0; i < N; i++) {
+        const int k = i * 7919 % N;
+        snprintf(buf[k], sizeof(buf[k]), "%d", k);
+        map_insert(map, buf[k], k);
+    }
+
+    map_iter_t it;
+    ck_assert_int_eq(map_iter_init(map, &it), 0);
+    char prev[16] = "";
+    int count = 0;
+    for (int ok = map_iter_next(&it); ok; ok = map_iter_next(&it), count++) {
+        ck_assert_int_lt(strcmp(prev, it.key), 0);
+        ck_assert_str_eq(it.key, buf[it.value]);
+        snprintf(prev, sizeof(prev), "%s", it.key);
+    }
+    ck_assert_int_eq(count, N);
+} END_TEST
+
+START_TEST (test_map_key_prefix) {
+    // Ключи короче, длиннее и ровно в 8 байтов (длина префикса),
+    // совпадающие в префиксе и байты больше 127, в порядке strcmp.
+    static char *keys[] = {
+        "", "a", "abcdefg", "abcdefgh", "abcdefgh1", "abcdefgh12", "abcdefgh\xff",
+        "abcdefgi", "abcdefgi0", "b", "\xff", "\xff\xff\xff\xff\xff\xff\xff\xff\xff",
+    };
+    static char *missing[] = {"ab", "abcdefgh0", "abcdefgh2", "abcdefgh123", "abcdefgj", "\xfe"};
+
+    for (size_t i = 0; i < LEN(keys); i++) {
+        const size_t k = i * 5 % LEN(keys);
+        map_insert(map, keys[k], (mval_t) k);
+    }
+    for (size_t i = 0; i < LEN(keys); i++)
+        ck_assert_int_eq(map_lookup(map, keys[i]).data, i);
+    for (size_t i = 0; i < LEN(missing); i++)
+        ck_assert_false(map_lookup(map, missing[i]).ok);
+
+    map_iter_t it;
+    ck_assert_int_eq(map_iter_init(map, &it), 0);
+    size_t i = 0;
+    for (int ok = map_iter_next(&it); ok; ok = map_iter_next(&it), i++)
+        ck_assert_str_eq(it.key, keys[i]);
+    ck_assert_int_eq(i, LEN(keys));
+} END_TEST
+
+START_TEST (test_map_insert_sorted) {
+    enum { N = 1000 };
+    static char buf[N][16];
+    static char *keys[N];
+    static mval_t values[N];
+
+    for (int i = 0; i < N; i++)
+        snprintf(buf[i], sizeof(buf[i]), "k%04d", i);
+
+    // Неупорядоченные и повторяющиеся ключи отвергаются до вставки.
+    static char *unsorted[] = {"k0001", "k0000"};
+    static char *repeated[] = {"k0000", "k0000"};
+    ck_assert_int_eq(map_insert_sorted(map, unsorted, values, 2), EINVAL);
+    ck_assert_int_eq(map_insert_sorted(map, repeated, values, 2), EINVAL);
+    ck_assert_false(map_lookup(map, "k0000").ok);
+    ck_assert_int_eq(map_insert_sorted(map, keys, values, 0), 0);
+
+    // Пустая мапа: ключи с чётными номерами.
+    size_t n = 0;
+    for (int i = 0; i < N; i += 2, n++) {
+        keys[n] = buf[i];
+        values[n] = i;
+    }
+    ck_assert_int_eq(map_insert_sorted(map, keys, values, n), 0);
+
+    // Слияние с записями мапы: половина ключей уже есть, значения обновляются.
+    n = 0;
+    for (int i = 0; i < N; i += 3, n++) {
+        keys[n] = buf[i];
+        values[n] = -i;
+    }
+    ck_assert_int_eq(map_insert_sorted(map, keys, values, n), 0);
+
+    // Малый пакет.
+    static char *few[] = {"k0001", "k0005", "k0007"};
+    static mval_t few_values[] = {1, 5, 7};
+    ck_assert_int_eq(map_insert_sorted(map, few, few_values, LEN(few)), 0);
+
+    size_t count = 0;
+    for (int i = 0; i < N; i++) {
+        const map_res_t res = map_lookup(map, buf[i]);
+        const int present = i % 2 == 0 || i % 3 == 0 || i == 1 || i == 5 || i == 7;
+        ck_assert_int_eq(res.ok, present);
+        if (present)
+            ck_assert_int_eq(res.data, i % 3 == 0 ? -i : i);
+        count += present;
+    }
+
+    map_iter_t it;
+    if (map_iter_init(map, &it) == 0) {
+        int prev = -1;
+        size_t i = 0;
+        for (int ok = map_iter_next(&it); ok; ok = map_iter_next(&it), i++) {
+            const int k = atoi(it.key + 1);
+            ck_assert_int_gt(k, prev);
+            prev = k;
+        }
+        ck_assert_int_eq(i, count);
+    }
+} END_TEST
+
+START_TEST (test_map_build_sorted) {
+    enum { N = 1000 };
+    static char buf[N][16];
+    static char *keys[N];
+    static mval_t values[N];
+
+    for (int i = 0; i < N; i++) {
+        snprintf(buf[i], sizeof(buf[i]), "k%04d", i);
+        keys[i] = buf[i];
+        values[i] = i;
+    }
+
+    // Мапа строится того же класса, что и мапа теста, без параметров
+    // конструктора.
+    const imap_t *class = *(const imap_t *const *) map;
+    void *built = map_build_sorted(class, keys, values, N);
+    ck_assert_false(IS_ERR(built));
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(built, buf[i]).data, i);
+    ck_assert_false(map_lookup(built, "k").ok);
+    map_destroy(built);
+
+    keys[1] = keys[0];
+    built = map_build_sorted(class, keys, values, N);
+    ck_assert_true(IS_ERR(built));
+    ck_assert_int_eq(PTR_ERR(built), EINVAL);
+} END_TEST
+
+enum { RANK_N = 500 };
+static char rank_keys[RANK_N][16];
+
+// Сверяет ранги, выбор по рангу и количество в диапазонах с множеством
+// ключей present.
+static void check_rank_select(const int *present) {
+    size_t count = 0;
+    for (int i = 0; i < RANK_N; i++) {
+        size_t rank;
+        ck_assert_int_eq(map_rank(map, rank_keys[i], &rank), 0);
+        ck_assert_int_eq(rank, count);
+
+        size_t in_range;
+        ck_assert_int_eq(map_count_range(map, NULL, rank_keys[i], &in_range), 0);
+        ck_assert_int_eq(in_range, count);
+
+        if (present[i]) {
+            map_iter_t it;
+            ck_assert_int_eq(map_select(map, count, &it), 0);
+            ck_assert_str_eq(it.key, rank_keys[i]);
+            ck_assert_int_eq(it.value, i);
+            count++;
+        }
+    }
+
+    size_t rank;
+    ck_assert_int_eq(map_rank(map, "z", &rank), 0);
+    ck_assert_int_eq(rank, count);
+
+    map_iter_t it;
+    ck_assert_int_eq(map_select(map, count, &it), 0);
+    ck_assert_ptr_null(it.key);
+
+    size_t in_range;
+    ck_assert_int_eq(map_count_range(map, NULL, NULL, &in_range), 0);
+    ck_assert_int_eq(in_range, count);
+    ck_assert_int_eq(map_count_range(map, rank_keys[300], rank_keys[100], &in_range), 0);
+    ck_assert_int_eq(in_range, 0);
+}
+
+START_TEST (test_map_rank_select) {
+    static int present[RANK_N];
+    for (int i = 0; i < RANK_N; i++)
+        snprintf(rank_keys[i], sizeof(rank_keys[i]), "k%04d", i);
+
+    // Ключи с чётными номерами вставляются не по порядку, чтобы размеры
+    // поддеревьев проверялись после поворотов.
+    for (int i = 0; i < RANK_N / 2; i++) {
+        const int k = i * 7 % (RANK_N / 2) * 2;
+        map_insert(map, rank_keys[k], k);
+        present[k] = 1;
+    }
+    check_rank_select(present);
+
+    for (int i = 0; i < RANK_N; i += 10) {
+        map_remove(map, rank_keys[i]);
+        present[i] = 0;
+    }
+    check_rank_select(present);
+
+    // Выбор по рангу ставит курсор, с которого можно продолжить обход.
+    map_iter_t it;
+    ck_assert_int_eq(map_select(map, 0, &it), 0);
+    ck_assert_str_eq(it.key, "k0002");
+    ck_assert_true(map_iter_next(&it));
+    ck_assert_str_eq(it.key, "k0004");
+
+    size_t in_range;
+    ck_assert_int_eq(map_count_range(map, "k0100", "k0200", &in_range), 0);
+    ck_assert_int_eq(in_range, 40);
+
+    static char *keys[RANK_N / 5];
+    static mval_t values[RANK_N / 5];
+    for (int i = 0; i < RANK_N / 5; i++) {
+        keys[i] = rank_keys[i * 5];
+        values[i] = i * 5;
+        present[i * 5] = 1;
+    }
+    ck_assert_int_eq(map_insert_sorted(map, keys, values, RANK_N / 5), 0);
+    check_rank_select(present);
+} END_TEST
+
+START_TEST (test_map_rank_unsupported) {
+    map_insert(map, "foo", 1);
+
+    size_t n;
+    map_iter_t it;
+    ck_assert_int_eq(map_rank(map, "foo", &n), ENOTSUP);
+    ck_assert_int_eq(map_select(map, 0, &it), ENOTSUP);
+    ck_assert_int_eq(map_count_range(map, NULL, NULL, &n), ENOTSUP);
+} END_TEST
+
+START_TEST (test_map_iter_unsupported) {
+    map_insert(map, "foo", 1);
+
+    map_iter_t it;
+    range_acc_t acc = {.limit = 0};
+    ck_assert_int_eq(map_iter_init(map, &it), ENOTSUP);
+    ck_assert_int_eq(map_range(map, NULL, NULL, range_collect, &acc), ENOTSUP);
+    ck_assert_int_eq(acc.n, 0);
+} END_TEST
+
+START_TEST (test_hmap_reserve_no_growth) {
+    enum { N = 1000 };
+    char buf[N][16];
+
+    ck_assert_int_eq(map_reserve(map, N), 0);
+    const size_t chains = hmap_stats(map).chains;
+
+    for (int i = 0; i < N; i++) {
+        snprintf(buf[i], sizeof(buf[i]), "k%d", i);
+        map_insert(map, buf[i], i);
+    }
+
+    // Вставка зарезервированного количества ключей не вызывает роста.
+    const hmap_stats_t stats = hmap_stats(map);
+    ck_assert_int_eq(stats.chains, chains);
+    ck_assert_int_eq(stats.count, N);
+} END_TEST
+
+START_TEST (test_hmap_shrink) {
+    enum { N = 5000, LIVE = 16 };
+    // Длинные ключи хранятся в арене, которую уплотняет hmap_compact.
+    static char buf[N][32];
+
+    for (int i = 0; i < N; i++) {
+        snprintf(buf[i], sizeof(buf[i]), "some/long/key/%d", i);
+        map_insert(map, buf[i], i);
+    }
+    const size_t peak = hmap_stats(map).chains;
+
+    for (int i = LIVE; i < N; i++) {
+        ck_assert_true(map_remove(map, buf[i]));
+
+        // Перед каждым бакетом переполнения в цепочке стоят только
+        // заполненные бакеты.
+        if (i % 500 == 0) {
+            const hmap_stats_t stats = hmap_stats(map);
+            ck_assert_int_le(stats.overflow * 8, stats.count);
+        }
+    }
+
+    // Таблица уменьшается постепенно: часть бакетов может оставаться
+    // в старом массиве, пока hmap_compact не завершит перенос.
+    hmap_stats_t stats = hmap_stats(map);
+    ck_assert_int_eq(stats.count, LIVE);
+    ck_assert_int_lt(stats.chains, peak);
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).ok, i < LIVE);
+
+    ck_assert_int_eq(hmap_compact(map), 0);
+    stats = hmap_stats(map);
+    ck_assert_int_eq(stats.count, LIVE);
+    ck_assert_int_le(stats.chains, 2 * LIVE);
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).data, i < LIVE ? i : 0);
+} END_TEST
+
+START_TEST (test_rhmap_stats) {
+    const string_t *keys[] = { "a", "aa", "baa", "aab", "b", "baba", "ba", "ab", "bab" };
+
+    for (size_t i = 0; i < LEN(keys); i++)
+        map_insert(map, keys[i], (int) i);
+    map_remove(map, "b");
+
+    const rhmap_stats_t stats = rhmap_stats(map);
+    ck_assert_int_eq(stats.count, LEN(keys) - 1);
+    ck_assert_int_ge(stats.cap, stats.count);
+    ck_assert_int_ge(stats.max_probe, (size_t) stats.mean_probe);
+} END_TEST
+
+START_TEST (test_cuckoomap_high_load) {
+    enum { N = 3800 };
+    static char buf[N][16];
+
+    // 3800 записей занимают больше 90% из 4096 мест.
+    ck_assert_int_eq(map_reserve(map, N), 0);
+    const size_t cap = cuckoomap_stats(map).cap;
+    for (int i = 0; i < N; i++) {
+        snprintf(buf[i], sizeof(buf[i]), "k%d", i);
+        map_insert(map, buf[i], i);
+    }
+
+    cuckoomap_stats_t stats = cuckoomap_stats(map);
+    ck_assert_int_eq(stats.count, N);
+    ck_assert_int_eq(stats.cap, cap);
+    ck_assert_int_ge(stats.count * 10, stats.cap * 9);
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).data, i);
+
+    for (int i = 0; i < N; i += 2)
+        ck_assert_true(map_remove(map, buf[i]));
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).ok, i % 2);
+
+    stats = cuckoomap_stats(map);
+    ck_assert_int_eq(stats.count, N / 2);
+    ck_assert_int_eq(stats.stashed, 0);
+} END_TEST
+
+START_TEST (test_cuckoomap_colliding_keys) {
+    enum { BLOCKS = 8, N = 1 << BLOCKS };
+    static char buf[N][2 * BLOCKS + 1];
+
+    // Ключи одной длины из блоков "Aa" и "B@" имеют одинаковый хэш djb2
+    // при любом зерне: все они претендуют на одни и те же два бакета.
+    for (int i = 0; i < N; i++) {
+        for (int b = 0; b < BLOCKS; b++)
+            memcpy(buf[i] + 2 * b, (i >> b) & 1 ? "B@" : "Aa", 2);
+        buf[i][2 * BLOCKS] = '\0';
+    }
+    for (int i = 0; i < N; i++)
+        map_insert(map, buf[i], i);
+
+    // Все записи, не поместившиеся в два бакета, находятся в списке
+    // переполнения, и таблица не растёт неограниченно.
+    cuckoomap_stats_t stats = cuckoomap_stats(map);
+    ck_assert_int_eq(stats.count, N);
+    ck_assert_int_eq(stats.dropped, 0);
+    ck_assert_int_ge(stats.stashed, N - 2 * 4);
+    ck_assert_int_le(stats.cap, 4 * stats.count);
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).data, i);
+
+    for (int i = 0; i < N; i++)
+        map_insert(map, buf[i], -i);
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).data, -i);
+
+    for (int i = 0; i < N; i += 2)
+        ck_assert_true(map_remove(map, buf[i]));
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).ok, i % 2);
+    ck_assert_int_eq(cuckoomap_stats(map).count, N / 2);
+} END_TEST
+
+START_TEST (test_bloommap_overfill) {
+    enum { N = 3000 };
+    static char buf[N][16];
+
+    // Ключей втрое больше, чем ожидалось при создании фильтра.
+    for (int i = 0; i < N; i++) {
+        snprintf(buf[i], sizeof(buf[i]), "k%d", i);
+        map_insert(map, buf[i], i);
+    }
+    for (int i = 0; i < N; i++)
+        map_insert(map, buf[i], -i);
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).data, -i);
+
+    for (int i = 0; i < N; i += 2)
+        ck_assert_true(map_remove(map, buf[i]));
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).ok, i % 2);
+    ck_assert_int_eq(map_lookup(bloommap_inner(map), buf[1]).data, -1);
+
+    // Повторная вставка удалённых ключей.
+    for (int i = 0; i < N; i += 2)
+        map_insert(map, buf[i], i);
+    for (int i = 0; i < N; i++)
+        ck_assert_true(map_lookup(map, buf[i]).ok);
+} END_TEST
+
+START_TEST (test_lrucache_evict) {
+    void *cache = map_new(LRUCache, (size_t) 3, djb2);
+
+    map_insert(cache, "a", 1);
+    map_insert(cache, "b", 2);
+    map_insert(cache, "c", 3);
+
+    // "a" использована последней, вытесняется "b".
+    ck_assert_int_eq(map_lookup(cache, "a").data, 1);
+    map_insert(cache, "d", 4);
+    ck_assert_false(map_lookup(cache, "b").ok);
+
+    // Обновление значения - тоже использование: вытесняется "a".
+    map_insert(cache, "c", 30);
+    map_insert(cache, "e", 5);
+    ck_assert_false(map_lookup(cache, "a").ok);
+    ck_assert_int_eq(map_lookup(cache, "c").data, 30);
+    ck_assert_int_eq(map_lookup(cache, "d").data, 4);
+    ck_assert_int_eq(map_lookup(cache, "e").data, 5);
+
+    // Удаление освобождает место без вытеснения.
+    ck_assert_true(map_remove(cache, "d"));
+    map_insert(cache, "f", 6);
+    ck_assert_int_eq(map_lookup(cache, "c").data, 30);
+
+    const lrucache_stats_t stats = lrucache_stats(cache);
+    ck_assert_int_eq(stats.count, 3);
+    ck_assert_int_eq(stats.capacity, 3);
+    ck_assert_int_eq(stats.hits, 5);
+    ck_assert_int_eq(stats.misses, 2);
+    ck_assert_int_eq(stats.evictions, 2);
+
+    map_destroy(cache);
+
+    ck_assert_true(IS_ERR(map_new(LRUCache, (size_t) 0, djb2)));
+} END_TEST
+
+START_TEST (test_lrucache_churn) {
+    enum { N = 5000 };
+    static char buf[N][32];
+
+    // В кэше остаются последние 1024 ключа.
+    for (int i = 0; i < N; i++) {
+        snprintf(buf[i], sizeof(buf[i]), i % 2 ? "k%d" : "some/longer/key-%d", i);
+        map_insert(map, buf[i], i);
+    }
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).ok, i >= N - 1024);
+
+    const lrucache_stats_t stats = lrucache_stats(map);
+    ck_assert_int_eq(stats.count, 1024);
+    ck_assert_int_eq(stats.evictions, N - 1024);
+} END_TEST
+
+START_TEST (test_bptree_shape) {
+    enum { N = 20000 };
+    static char buf[N][32];
+
+    // Ключи с общим префиксом длиннее 8 байт сравниваются за пределами
+    // префикса, короткие ключи - только по префиксу.
+    for (int i = 0; i < N; i++) {
+        const int k = i * 7919 % N;
+        snprintf(buf[k], sizeof(buf[k]), k % 2 ? "%d" : "common/prefix/%d", k);
+        map_insert(map, buf[k], k);
+    }
+
+    bptree_stats_t stats = bptree_stats(map);
+    ck_assert_int_eq(stats.count, N);
+    ck_assert_int_ge(stats.height, 3);
+    // Листья заполнены не меньше чем наполовину.
+    ck_assert_int_le(stats.leaves, N / (BPTREE_MAX_KEYS / 2));
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).data, i);
+
+    for (int i = 0; i < N - 10; i++)
+        ck_assert_true(map_remove(map, buf[i]));
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).ok, i >= N - 10);
+
+    // После удаления дерево сжимается до одного листа.
+    stats = bptree_stats(map);
+    ck_assert_int_eq(stats.count, 10);
+    ck_assert_int_eq(stats.height, 1);
+    ck_assert_int_eq(stats.leaves, 1);
+    ck_assert_int_eq(stats.inners, 0);
+} END_TEST
+
+START_TEST (test_radix_nodes) {
+    char key[3] = "x";
+
+    // "x" и "x" + c для всех c из [1, 255]: у узла после "x" 256 детей.
+    map_insert(map, key, 0);
+    for (int c = 1; c < 256; c++) {
+        key[1] = (char) c;
+        map_insert(map, key, c);
+    }
+
+    radix_stats_t stats = radix_stats(map);
+    ck_assert_int_eq(stats.count, 256);
+    ck_assert_int_eq(stats.node256, 1);
+    ck_assert_int_eq(stats.node4 + stats.node16 + stats.node48, 0);
+    ck_assert_int_eq(map_lookup(map, "x").data, 0);
+    for (int c = 1; c < 256; c++) {
+        key[1] = (char) c;
+        ck_assert_int_eq(map_lookup(map, key).data, c);
+    }
+
+    // Узел уменьшается по мере удаления детей.
+    for (int c = 255; c > 2; c--) {
+        key[1] = (char) c;
+        ck_assert_true(map_remove(map, key));
+    }
+    stats = radix_stats(map);
+    ck_assert_int_eq(stats.count, 3);
+    ck_assert_int_eq(stats.node4, 1);
+    ck_assert_int_eq(stats.node16 + stats.node48 + stats.node256, 0);
+
+    ck_assert_true(map_remove(map, "x"));
+    ck_assert_true(map_remove(map, "x\x01"));
+    stats = radix_stats(map);
+    ck_assert_int_eq(stats.count, 1);
+    ck_assert_int_eq(stats.node_bytes, 0);
+    ck_assert_int_eq(map_lookup(map, "x\x02").data, 2);
+} END_TEST
+
+START_TEST (test_radix_long_prefix) {
+    enum { N = 1000 };
+    static char buf[N][64];
+
+    // Общий префикс длиннее хранимых в узле 8 байтов.
+    for (int i = 0; i < N; i++) {
+        snprintf(buf[i], sizeof(buf[i]), i % 2 ? "/usr/share/doc/package/%d" : "/usr/share/doc/%d", i);
+        map_insert(map, buf[i], i);
+    }
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).data, i);
+
+    // Ключи, расходящиеся с префиксом за пределами хранимых байтов.
+    ck_assert_false(map_lookup(map, "/usr/share/dox/1").ok);
+    ck_assert_false(map_lookup(map, "/usr/share/doc/package").ok);
+    ck_assert_false(map_lookup(map, "/usr/share/doc/").ok);
+    ck_assert_false(map_lookup(map, "/usr").ok);
+    map_insert(map, "/usr/share/dox/1", -1);
+    map_insert(map, "/usr", -2);
+    ck_assert_int_eq(map_lookup(map, "/usr/share/dox/1").data, -1);
+    ck_assert_int_eq(map_lookup(map, "/usr").data, -2);
+
+    for (int i = 0; i < N; i++)
+        ck_assert_int_eq(map_lookup(map, buf[i]).data, i);
+    for (int i = 0; i < N; i++)
+        ck_assert_true(map_remove(map, buf[i]));
+    ck_assert_int_eq(map_lookup(map, "/usr/share/dox/1").data, -1);
+    ck_assert_int_eq(radix_stats(map).count, 2);
+} END_TEST
+
+static int radix_collect(const string_t *key, const mval_t value, void *arg) {
+    range_acc_t *acc = arg;
+    snprintf(acc->keys[acc->n % 16], sizeof(acc->keys[0]), "%s", key);
+    acc->n++;
+    return acc->n == acc->limit;
+}
+
+START_TEST (test_radix_prefix_scan) {
+    static char *keys[] = {
+        "a", "ab", "abc", "abd", "abcdefghijklmn", "abcdefghijklmo", "b", "ba",
+    };
+    for (size_t i = 0; i < LEN(keys); i++)
+        map_insert(map, keys[i], (mval_t) i);
+
+    range_acc_t acc = {.limit = 0};
+    ck_assert_int_eq(radix_prefix_scan(map, "ab", 2, radix_collect, &acc), 0);
+    ck_assert_int_eq(acc.n, 5);
+    ck_assert_str_eq(acc.keys[0], "ab");
+    ck_assert_str_eq(acc.keys[1], "abc");
+    ck_assert_str_eq(acc.keys[2], "abcdefghijklmn");
+    ck_assert_str_eq(acc.keys[3], "abcdefghijklmo");
+    ck_assert_str_eq(acc.keys[4], "abd");
+
+    acc = (range_acc_t){.limit = 0};
+    ck_assert_int_eq(radix_prefix_scan(map, "abcdefghijk", 11, radix_collect, &acc), 0);
+    ck_assert_int_eq(acc.n, 2);
+
+    acc = (range_acc_t){.limit = 0};
+    ck_assert_int_eq(radix_prefix_scan(map, "abcdefghijx", 11, radix_collect, &acc), 0);
+    ck_assert_int_eq(acc.n, 0);
+
+    acc = (range_acc_t){.limit = 0};
+    ck_assert_int_eq(radix_prefix_scan(map, "ba", 2, radix_collect, &acc), 0);
+    ck_assert_int_eq(acc.n, 1);
+    ck_assert_str_eq(acc.keys[0], "ba");
+
+    acc = (range_acc_t){.limit = 0};
+    ck_assert_int_eq(radix_prefix_scan(map, "c", 1, radix_collect, &acc), 0);
+    ck_assert_int_eq(acc.n, 0);
+
+    // Пустой префикс - все ключи по возрастанию, обход можно прервать.
+    acc = (range_acc_t){.limit = 3};
+    ck_assert_int_eq(radix_prefix_scan(map, "", 0, radix_collect, &acc), 0);
+    ck_assert_int_eq(acc.n, 3);
+    ck_assert_str_eq(acc.keys[0], "a");
+    ck_assert_str_eq(acc.keys[2], "abc");
+} END_TEST
+
+START_TEST (test_pavltree_snapshot) {
+    enum { N = 1000 };
+    static char buf[N][16];
+
+    for (int i = 0; i < N; i++) {
+        snprintf(buf[i], sizeof(buf[i]), "k%d", i);
+        map_insert(map, buf[i], i);
+    }
+
+    // Снимок видит дерево на момент взятия, последующие записи - нет.
+    const void *snapshot = pavltree_snapshot(map);
+    for (int i = 0; i < N; i++) {
+        if (i % 2)
+            ck_assert_true(map_remove(map, buf[i]));
+        else
+            map_insert(map, buf[i], -i);
+    }
+    map_insert(map, "new", 1);
+
+    for (int i = 0; i < N; i++) {
+        ck_assert_int_eq(pavltree_snapshot_lookup(snapshot, buf[i], strlen(buf[i])).data, i);
+        ck_assert_int_eq(map_lookup(map, buf[i]).ok, i % 2 == 0);
+        ck_assert_int_eq(map_lookup(map, buf[i]).data, i % 2 ? 0 : -i);
+    }
+    ck_assert_false(pavltree_snapshot_lookup(snapshot, "new", 3).ok);
+    ck_assert_int_eq(map_lookup(map, "new").data, 1);
+
+    // Пока снимок закреплён, версии, вытесненные после него, не освобождаются.
+    pavltree_stats_t stats = pavltree_stats(map);
+    ck_assert_int_eq(stats.versions, N + 1);
+    ck_assert_int_gt(stats.retired, 0);
+
+    // Первая запись после освобождения снимка освобождает все версии.
+    pavltree_snapshot_release(snapshot);
+    map_insert(map, "new", 2);
+    stats = pavltree_stats(map);
+    ck_assert_int_eq(stats.versions, 0);
+    ck_assert_int_eq(stats.retired, 0);
+} END_TEST
+
+enum { PAVLTREE_BASE = 2000, PAVLTREE_READERS = 4 };
+
+typedef struct {
+    char        base[PAVLTREE_BASE][16];
+    atomic_int  done;
+    atomic_long errors;
+} pavltree_stress_t;
+
+// Читатель ищет ключи, вставленные до запуска потоков, в дереве и снимках,
+// пока писатель изменяет другие ключи.
+static void *pavltree_reader(void *arg) {
+    pavltree_stress_t *stress = arg;
+    unsigned seed = 1;
+    long errors = 0;
+    for (long n = 0; !atomic_load(&stress->done); n++) {
+        const int i = (int) (rand_r(&seed) % PAVLTREE_BASE);
+        const map_res_t res = map_lookup(map, stress->base[i]);
+        errors += !res.ok || res.data != i;
+
+        if (n % 64 == 0) {
+            // Снимок не меняется, пока закреплён.
+            const void *snapshot = pavltree_snapshot(map);
+            const map_res_t before = pavltree_snapshot_lookup(snapshot, "w7", 2);
+            for (int j = 0; j < PAVLTREE_BASE; j += 37) {
+                const string_t *key = stress->base[j];
+                errors += pavltree_snapshot_lookup(snapshot, key, strlen(key)).data != j;
+            }
+            const map_res_t after = pavltree_snapshot_lookup(snapshot, "w7", 2);
+            errors += before.ok != after.ok || before.data != after.data;
+            pavltree_snapshot_release(snapshot);
+        }
+    }
+    atomic_fetch_add(&stress->errors, errors);
+    return NULL;
+}
+
+START_TEST (test_pavltree_concurrent) {
+    enum { WRITES = 20000 };
+    static pavltree_stress_t stress;
+
+    for (int i = 0; i < PAVLTREE_BASE; i++) {
+        snprintf(stress.base[i], sizeof(stress.base[i]), "b%d", i);
+        map_insert(map, stress.base[i], i);
+    }
+    atomic_init(&stress.done, 0);
+    atomic_init(&stress.errors, 0);
+
+    pthread_t readers[PAVLTREE_READERS];
+    for (int i = 0; i < PAVLTREE_READERS; i++)
+        ck_assert_int_eq(pthread_create(&readers[i], NULL, pavltree_reader, &stress), 0);
+
+    // Единственный писатель - поток теста.
+    char key[16];
+    for (int i = 0; i < WRITES; i++) {
+        snprintf(key, sizeof(key), "w%d", i % 100);
+        if (i % 3 == 0)
+            map_remove(map, key);
+        else
+            map_insert(map, key, i);
+    }
+
+    atomic_store(&stress.done, 1);
+    for (int i = 0; i < PAVLTREE_READERS; i++)
+        pthread_join(readers[i], NULL);
+    ck_assert_int_eq(atomic_load(&stress.errors), 0);
+
+    // Читатели отпустили все версии: их освобождает следующая запись.
+    map_insert(map, "w0", 0);
+    ck_assert_int_eq(pavltree_stats(map).versions, 0);
+} END_TEST
+
+START_TEST (test_bloom_fpr) {
+    enum { N = 10000 };
+    bloom_t bloom;
+    cbloom_t cbloom;
+
+    ck_assert_int_eq(bloom_init(&bloom, N, 0.0), EINVAL);
+    ck_assert_int_eq(bloom_init(&bloom, N, 0.01), 0);
+    ck_assert_int_eq(cbloom_init(&cbloom, N, 0.01), 0);
+
+    for (hash_t i = 0; i < N; i++) {
+        bloom_add(&bloom, wyhash(0, (const char *) &i, sizeof(i)));
+        cbloom_add(&cbloom, wyhash(0, (const char *) &i, sizeof(i)));
+    }
+
+    // Ложноотрицательных ответов нет.
+    for (hash_t i = 0; i < N; i++) {
+        ck_assert_true(bloom_test(&bloom, wyhash(0, (const char *) &i, sizeof(i))));
+        ck_assert_true(cbloom_test(&cbloom, wyhash(0, (const char *) &i, sizeof(i))));
+    }
+
+    // Доля ложных срабатываний близка к заданной.
+    size_t fp = 0, cfp = 0;
+    for (hash_t i = N; i < 11 * N; i++) {
+        fp += bloom_test(&bloom, wyhash(0, (const char *) &i, sizeof(i)));
+        cfp += cbloom_test(&cbloom, wyhash(0, (const char *) &i, sizeof(i)));
+    }
+    ck_assert_int_lt(fp, 10 * N * 15 / 1000);
+    ck_assert_int_lt(cfp, 10 * N * 15 / 1000);
+
+    // Удаление из фильтра со счётчиками.
+    for (hash_t i = 0; i < N; i += 2)
+        cbloom_remove(&cbloom, wyhash(0, (const char *) &i, sizeof(i)));
+    size_t removed = 0;
+    for (hash_t i = 0; i < N; i++) {
+        const int ok = cbloom_test(&cbloom, wyhash(0, (const char *) &i, sizeof(i)));
+        if (i % 2)
+            ck_assert_true(ok);
+        else
+            removed += !ok;
+    }
+    ck_assert_int_gt(removed, N / 2 * 9 / 10);
+
+    bloom_clear(&bloom);
+    ck_assert_false(bloom_test(&bloom, wyhash(0, (const char *) &(hash_t){1}, sizeof(hash_t))));
+
+    bloom_destroy(&bloom);
+    cbloom_destroy(&cbloom);
+} END_TEST
+
+START_TEST (test_hash_family) {
+    const hash_func_t funcs[] = { djb2, fnv1a, wyhash, xxh3 };
+    // Ключи всех длин, обрабатываемых разными ветвями хэш-функций.
+    const string_t *keys[] = {
+        "", "a", "ab", "abc", "abcd", "abcdefgh", "abcdefghi", "abcdefghijklmnop",
+        "abcdefghijklmnopq", "abcdefghijklmnopqrstuvwxyz012345",
+        "abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz",
+    };
+
+    for (size_t f = 0; f < LEN(funcs); f++) {
+        // Одинаковые ключи и зерно дают одинаковый хэш.
+        for (size_t i = 0; i < LEN(keys); i++)
+            ck_assert_int_eq(funcs[f](42, keys[i], strlen(keys[i])), funcs[f](42, keys[i], strlen(keys[i])));
+        ck_assert_int_ne(funcs[f](42, "abcdefgh", 8), funcs[f](42, "abcdefgi", 8));
+        // Хэшируются только len байт ключа.
+        ck_assert_int_eq(funcs[f](42, "abcdefghij", 9), funcs[f](42, "abcdefghi", 9));
+
+        void *m = map_new(HashMap, funcs[f]);
+        for (size_t i = 0; i < LEN(keys); i++)
+            map_insert(m, keys[i], (int) i);
+        for (size_t i = 0; i < LEN(keys); i++) {
+            const map_res_t res = map_lookup(m, keys[i]);
+            ck_assert_true(res.ok);
+            ck_assert_int_eq(res.data, (int) i);
+        }
+        map_destroy(m);
+    }
+} END_TEST
+
 TCase *check_bstree_insert_and_lookup(void) {
     TCase *tc = tcase_create("check_bstree_insert_and_lookup");
     tcase_add_unchecked_fixture(tc, setup_bstree, teardown_map);
@@ -131,14 +1154,94 @@ TCase *check_bstree_insert_update(void) {
     return tc;
 }
 
-Suite *check_bstree_suite(void) {
-    Suite *suite = suite_create("check_bstree");
-    suite_add_tcase(suite, check_bstree_insert_and_lookup());
-    suite_add_tcase(suite, check_bstree_lookup_not_existing());
-    suite_add_tcase(suite, check_bstree_insert_many_and_lookup());
-    suite_add_tcase(suite, check_bstree_insert_many_and_remove_all());
-    suite_add_tcase(suite, check_bstree_insert_update());
-    return suite;
+TCase *check_bstree_slices(void) {
+    TCase *tc = tcase_create("check_bstree_slices");
+    tcase_add_unchecked_fixture(tc, setup_bstree, teardown_map);
+    tcase_add_test(tc, test_map_slices);
+    return tc;
+}
+
+TCase *check_bstree_lookup_batch(void) {
+    TCase *tc = tcase_create("check_bstree_lookup_batch");
+    tcase_add_unchecked_fixture(tc, setup_bstree, teardown_map);
+    tcase_add_test(tc, test_map_lookup_batch);
+    return tc;
+}
+
+TCase *check_bstree_remove_interleaved(void) {
+    TCase *tc = tcase_create("check_bstree_remove_interleaved");
+    tcase_add_unchecked_fixture(tc, setup_bstree, teardown_map);
+    tcase_add_test(tc, test_map_remove_interleaved);
+    return tc;
+}
+
+TCase *check_bstree_reserve(void) {
+    TCase *tc = tcase_create("check_bstree_reserve");
+    tcase_add_unchecked_fixture(tc, setup_bstree, teardown_map);
+    tcase_add_test(tc, test_map_reserve);
+    return tc;
+}
+
+TCase *check_bstree_iter(void) {
+    TCase *tc = tcase_create("check_bstree_iter");
+    tcase_add_unchecked_fixture(tc, setup_bstree, teardown_map);
+    tcase_add_test(tc, test_map_iter);
+    return tc;
+}
+
+TCase *check_bstree_iter_shuffled(void) {
+    TCase *tc = tcase_create("check_bstree_iter_shuffled");
+    tcase_add_unchecked_fixture(tc, setup_bstree, teardown_map);
+    tcase_add_test(tc, test_map_iter_shuffled);
+    return tc;
+}
+
+TCase *check_bstree_key_prefix(void) {
+    TCase *tc = tcase_create("check_bstree_key_prefix");
+    tcase_add_unchecked_fixture(tc, setup_bstree, teardown_map);
+    tcase_add_test(tc, test_map_key_prefix);
+    return tc;
+}
+
+TCase *check_bstree_insert_sorted(void) {
+    TCase *tc = tcase_create("check_bstree_insert_sorted");
+    tcase_add_unchecked_fixture(tc, setup_bstree, teardown_map);
+    tcase_add_test(tc, test_map_insert_sorted);
+    return tc;
+}
+
+TCase *check_bstree_build_sorted(void) {
+    TCase *tc = tcase_create("check_bstree_build_sorted");
+    tcase_add_unchecked_fixture(tc, setup_bstree, teardown_map);
+    tcase_add_test(tc, test_map_build_sorted);
+    return tc;
+}
+
+TCase *check_bstree_rank_unsupported(void) {
+    TCase *tc = tcase_create("check_bstree_rank_unsupported");
+    tcase_add_unchecked_fixture(tc, setup_bstree, teardown_map);
+    tcase_add_test(tc, test_map_rank_unsupported);
+    return tc;
+}
+
+Suite *check_bstree_suite(void) {
+    Suite *suite = suite_create("check_bstree");
+    suite_add_tcase(suite, check_bstree_insert_and_lookup());
+    suite_add_tcase(suite, check_bstree_lookup_not_existing());
+    suite_add_tcase(suite, check_bstree_insert_many_and_lookup());
+    suite_add_tcase(suite, check_bstree_insert_many_and_remove_all());
+    suite_add_tcase(suite, check_bstree_insert_update());
+    suite_add_tcase(suite, check_bstree_slices());
+    suite_add_tcase(suite, check_bstree_lookup_batch());
+    suite_add_tcase(suite, check_bstree_reserve());
+    suite_add_tcase(suite, check_bstree_remove_interleaved());
+    suite_add_tcase(suite, check_bstree_iter());
+    suite_add_tcase(suite, check_bstree_iter_shuffled());
+    suite_add_tcase(suite, check_bstree_key_prefix());
+    suite_add_tcase(suite, check_bstree_insert_sorted());
+    suite_add_tcase(suite, check_bstree_build_sorted());
+    suite_add_tcase(suite, check_bstree_rank_unsupported());
+    return suite;
 }
 
 TCase *check_avltree_insert_and_lookup(void) {
@@ -176,6 +1279,76 @@ TCase *check_avltree_insert_update(void) {
     return tc;
 }
 
+TCase *check_avltree_slices(void) {
+    TCase *tc = tcase_create("check_avltree_slices");
+    tcase_add_unchecked_fixture(tc, setup_avltree, teardown_map);
+    tcase_add_test(tc, test_map_slices);
+    return tc;
+}
+
+TCase *check_avltree_lookup_batch(void) {
+    TCase *tc = tcase_create("check_avltree_lookup_batch");
+    tcase_add_unchecked_fixture(tc, setup_avltree, teardown_map);
+    tcase_add_test(tc, test_map_lookup_batch);
+    return tc;
+}
+
+TCase *check_avltree_remove_interleaved(void) {
+    TCase *tc = tcase_create("check_avltree_remove_interleaved");
+    tcase_add_unchecked_fixture(tc, setup_avltree, teardown_map);
+    tcase_add_test(tc, test_map_remove_interleaved);
+    return tc;
+}
+
+TCase *check_avltree_reserve(void) {
+    TCase *tc = tcase_create("check_avltree_reserve");
+    tcase_add_unchecked_fixture(tc, setup_avltree, teardown_map);
+    tcase_add_test(tc, test_map_reserve);
+    return tc;
+}
+
+TCase *check_avltree_iter(void) {
+    TCase *tc = tcase_create("check_avltree_iter");
+    tcase_add_unchecked_fixture(tc, setup_avltree, teardown_map);
+    tcase_add_test(tc, test_map_iter);
+    return tc;
+}
+
+TCase *check_avltree_iter_shuffled(void) {
+    TCase *tc = tcase_create("check_avltree_iter_shuffled");
+    tcase_add_unchecked_fixture(tc, setup_avltree, teardown_map);
+    tcase_add_test(tc, test_map_iter_shuffled);
+    return tc;
+}
+
+TCase *check_avltree_key_prefix(void) {
+    TCase *tc = tcase_create("check_avltree_key_prefix");
+    tcase_add_unchecked_fixture(tc, setup_avltree, teardown_map);
+    tcase_add_test(tc, test_map_key_prefix);
+    return tc;
+}
+
+TCase *check_avltree_insert_sorted(void) {
+    TCase *tc = tcase_create("check_avltree_insert_sorted");
+    tcase_add_unchecked_fixture(tc, setup_avltree, teardown_map);
+    tcase_add_test(tc, test_map_insert_sorted);
+    return tc;
+}
+
+TCase *check_avltree_build_sorted(void) {
+    TCase *tc = tcase_create("check_avltree_build_sorted");
+    tcase_add_unchecked_fixture(tc, setup_avltree, teardown_map);
+    tcase_add_test(tc, test_map_build_sorted);
+    return tc;
+}
+
+TCase *check_avltree_rank_select(void) {
+    TCase *tc = tcase_create("check_avltree_rank_select");
+    tcase_add_unchecked_fixture(tc, setup_avltree, teardown_map);
+    tcase_add_test(tc, test_map_rank_select);
+    return tc;
+}
+
 Suite *check_avltree_suite(void) {
     Suite *suite = suite_create("check_avltree");
     suite_add_tcase(suite, check_avltree_insert_and_lookup());
@@ -183,9 +1356,340 @@ Suite *check_avltree_suite(void) {
     suite_add_tcase(suite, check_avltree_insert_many_and_lookup());
     suite_add_tcase(suite, check_avltree_insert_many_and_remove_all());
     suite_add_tcase(suite, check_avltree_insert_update());
+    suite_add_tcase(suite, check_avltree_slices());
+    suite_add_tcase(suite, check_avltree_lookup_batch());
+    suite_add_tcase(suite, check_avltree_reserve());
+    suite_add_tcase(suite, check_avltree_remove_interleaved());
+    suite_add_tcase(suite, check_avltree_iter());
+    suite_add_tcase(suite, check_avltree_iter_shuffled());
+    suite_add_tcase(suite, check_avltree_key_prefix());
+    suite_add_tcase(suite, check_avltree_insert_sorted());
+    suite_add_tcase(suite, check_avltree_build_sorted());
+    suite_add_tcase(suite, check_avltree_rank_select());
+    return suite;
+}
+
+TCase *check_pavltree_insert_and_lookup(void) {
+    TCase *tc = tcase_create("check_pavltree_insert_and_lookup");
+    tcase_add_unchecked_fixture(tc, setup_pavltree, teardown_map);
+    tcase_add_test(tc, test_map_insert_and_lookup);
+    return tc;
+}
+
+TCase *check_pavltree_lookup_not_existing(void) {
+    TCase *tc = tcase_create("check_pavltree_lookup_not_existing");
+    tcase_add_unchecked_fixture(tc, setup_pavltree, teardown_map);
+    tcase_add_test(tc, test_map_lookup_not_existing);
+    return tc;
+}
+
+TCase *check_pavltree_insert_many_and_lookup(void) {
+    TCase *tc = tcase_create("check_pavltree_insert_many_and_lookup");
+    tcase_add_unchecked_fixture(tc, setup_pavltree, teardown_map);
+    tcase_add_test(tc, test_map_insert_many_and_lookup);
+    return tc;
+}
+
+TCase *check_pavltree_insert_many_and_remove_all(void) {
+    TCase *tc = tcase_create("check_pavltree_insert_many_and_remove_all");
+    tcase_add_unchecked_fixture(tc, setup_pavltree, teardown_map);
+    tcase_add_test(tc, test_map_insert_many_and_remove_all);
+    return tc;
+}
+
+TCase *check_pavltree_insert_update(void) {
+    TCase *tc = tcase_create("check_pavltree_insert_update");
+    tcase_add_unchecked_fixture(tc, setup_pavltree, teardown_map);
+    tcase_add_test(tc, test_map_insert_update);
+    return tc;
+}
+
+TCase *check_pavltree_slices(void) {
+    TCase *tc = tcase_create("check_pavltree_slices");
+    tcase_add_unchecked_fixture(tc, setup_pavltree, teardown_map);
+    tcase_add_test(tc, test_map_slices);
+    return tc;
+}
+
+TCase *check_pavltree_lookup_batch(void) {
+    TCase *tc = tcase_create("check_pavltree_lookup_batch");
+    tcase_add_unchecked_fixture(tc, setup_pavltree, teardown_map);
+    tcase_add_test(tc, test_map_lookup_batch);
+    return tc;
+}
+
+TCase *check_pavltree_reserve(void) {
+    TCase *tc = tcase_create("check_pavltree_reserve");
+    tcase_add_unchecked_fixture(tc, setup_pavltree, teardown_map);
+    tcase_add_test(tc, test_map_reserve);
+    return tc;
+}
+
+TCase *check_pavltree_remove_interleaved(void) {
+    TCase *tc = tcase_create("check_pavltree_remove_interleaved");
+    tcase_add_unchecked_fixture(tc, setup_pavltree, teardown_map);
+    tcase_add_test(tc, test_map_remove_interleaved);
+    return tc;
+}
+
+TCase *check_pavltree_insert_sorted(void) {
+    TCase *tc = tcase_create("check_pavltree_insert_sorted");
+    tcase_add_unchecked_fixture(tc, setup_pavltree, teardown_map);
+    tcase_add_test(tc, test_map_insert_sorted);
+    return tc;
+}
+
+TCase *check_pavltree_rank_unsupported(void) {
+    TCase *tc = tcase_create("check_pavltree_rank_unsupported");
+    tcase_add_unchecked_fixture(tc, setup_pavltree, teardown_map);
+    tcase_add_test(tc, test_map_rank_unsupported);
+    return tc;
+}
+
+TCase *check_pavltree_snapshot(void) {
+    TCase *tc = tcase_create("check_pavltree_snapshot");
+    tcase_add_unchecked_fixture(tc, setup_pavltree, teardown_map);
+    tcase_add_test(tc, test_pavltree_snapshot);
+    return tc;
+}
+
+TCase *check_pavltree_concurrent(void) {
+    TCase *tc = tcase_create("check_pavltree_concurrent");
+    tcase_add_unchecked_fixture(tc, setup_pavltree, teardown_map);
+    tcase_add_test(tc, test_pavltree_concurrent);
+    return tc;
+}
+
+Suite *check_pavltree_suite(void) {
+    Suite *suite = suite_create("check_pavltree");
+    suite_add_tcase(suite, check_pavltree_insert_and_lookup());
+    suite_add_tcase(suite, check_pavltree_lookup_not_existing());
+    suite_add_tcase(suite, check_pavltree_insert_many_and_lookup());
+    suite_add_tcase(suite, check_pavltree_insert_many_and_remove_all());
+    suite_add_tcase(suite, check_pavltree_insert_update());
+    suite_add_tcase(suite, check_pavltree_slices());
+    suite_add_tcase(suite, check_pavltree_lookup_batch());
+    suite_add_tcase(suite, check_pavltree_reserve());
+    suite_add_tcase(suite, check_pavltree_remove_interleaved());
+    suite_add_tcase(suite, check_pavltree_insert_sorted());
+    suite_add_tcase(suite, check_pavltree_rank_unsupported());
+    suite_add_tcase(suite, check_pavltree_snapshot());
+    suite_add_tcase(suite, check_pavltree_concurrent());
+    return suite;
+}
+
+TCase *check_bptree_insert_and_lookup(void) {
+    TCase *tc = tcase_create("check_bptree_insert_and_lookup");
+    tcase_add_unchecked_fixture(tc, setup_bptree, teardown_map);
+    tcase_add_test(tc, test_map_insert_and_lookup);
+    return tc;
+}
+
+TCase *check_bptree_lookup_not_existing(void) {
+    TCase *tc = tcase_create("check_bptree_lookup_not_existing");
+    tcase_add_unchecked_fixture(tc, setup_bptree, teardown_map);
+    tcase_add_test(tc, test_map_lookup_not_existing);
+    return tc;
+}
+
+TCase *check_bptree_insert_many_and_lookup(void) {
+    TCase *tc = tcase_create("check_bptree_insert_many_and_lookup");
+    tcase_add_unchecked_fixture(tc, setup_bptree, teardown_map);
+    tcase_add_test(tc, test_map_insert_many_and_lookup);
+    return tc;
+}
+
+TCase *check_bptree_insert_many_and_remove_all(void) {
+    TCase *tc = tcase_create("check_bptree_insert_many_and_remove_all");
+    tcase_add_unchecked_fixture(tc, setup_bptree, teardown_map);
+    tcase_add_test(tc, test_map_insert_many_and_remove_all);
+    return tc;
+}
+
+TCase *check_bptree_insert_update(void) {
+    TCase *tc = tcase_create("check_bptree_insert_update");
+    tcase_add_unchecked_fixture(tc, setup_bptree, teardown_map);
+    tcase_add_test(tc, test_map_insert_update);
+    return tc;
+}
+
+TCase *check_bptree_slices(void) {
+    TCase *tc = tcase_create("check_bptree_slices");
+    tcase_add_unchecked_fixture(tc, setup_bptree, teardown_map);
+    tcase_add_test(tc, test_map_slices);
+    return tc;
+}
+
+TCase *check_bptree_lookup_batch(void) {
+    TCase *tc = tcase_create("check_bptree_lookup_batch");
+    tcase_add_unchecked_fixture(tc, setup_bptree, teardown_map);
+    tcase_add_test(tc, test_map_lookup_batch);
+    return tc;
+}
+
+TCase *check_bptree_remove_interleaved(void) {
+    TCase *tc = tcase_create("check_bptree_remove_interleaved");
+    tcase_add_unchecked_fixture(tc, setup_bptree, teardown_map);
+    tcase_add_test(tc, test_map_remove_interleaved);
+    return tc;
+}
+
+TCase *check_bptree_reserve(void) {
+    TCase *tc = tcase_create("check_bptree_reserve");
+    tcase_add_unchecked_fixture(tc, setup_bptree, teardown_map);
+    tcase_add_test(tc, test_map_reserve);
+    return tc;
+}
+
+TCase *check_bptree_shape(void) {
+    TCase *tc = tcase_create("check_bptree_shape");
+    tcase_add_unchecked_fixture(tc, setup_bptree, teardown_map);
+    tcase_add_test(tc, test_bptree_shape);
+    return tc;
+}
+
+TCase *check_bptree_iter(void) {
+    TCase *tc = tcase_create("check_bptree_iter");
+    tcase_add_unchecked_fixture(tc, setup_bptree, teardown_map);
+    tcase_add_test(tc, test_map_iter);
+    return tc;
+}
+
+TCase *check_bptree_iter_shuffled(void) {
+    TCase *tc = tcase_create("check_bptree_iter_shuffled");
+    tcase_add_unchecked_fixture(tc, setup_bptree, teardown_map);
+    tcase_add_test(tc, test_map_iter_shuffled);
+    return tc;
+}
+
+TCase *check_bptree_key_prefix(void) {
+    TCase *tc = tcase_create("check_bptree_key_prefix");
+    tcase_add_unchecked_fixture(tc, setup_bptree, teardown_map);
+    tcase_add_test(tc, test_map_key_prefix);
+    return tc;
+}
+
+Suite *check_bptree_suite(void) {
+    Suite *suite = suite_create("check_bptree");
+    suite_add_tcase(suite, check_bptree_insert_and_lookup());
+    suite_add_tcase(suite, check_bptree_lookup_not_existing());
+    suite_add_tcase(suite, check_bptree_insert_many_and_lookup());
+    suite_add_tcase(suite, check_bptree_insert_many_and_remove_all());
+    suite_add_tcase(suite, check_bptree_insert_update());
+    suite_add_tcase(suite, check_bptree_slices());
+    suite_add_tcase(suite, check_bptree_lookup_batch());
+    suite_add_tcase(suite, check_bptree_remove_interleaved());
+    suite_add_tcase(suite, check_bptree_reserve());
+    suite_add_tcase(suite, check_bptree_shape());
+    suite_add_tcase(suite, check_bptree_iter());
+    suite_add_tcase(suite, check_bptree_iter_shuffled());
+    suite_add_tcase(suite, check_bptree_key_prefix());
     return suite;
 }
 
+
+TCase *check_radix_insert_and_lookup(void) {
+    TCase *tc = tcase_create("check_radix_insert_and_lookup");
+    tcase_add_unchecked_fixture(tc, setup_radix, teardown_map);
+    tcase_add_test(tc, test_map_insert_and_lookup);
+    return tc;
+}
+
+TCase *check_radix_lookup_not_existing(void) {
+    TCase *tc = tcase_create("check_radix_lookup_not_existing");
+    tcase_add_unchecked_fixture(tc, setup_radix, teardown_map);
+    tcase_add_test(tc, test_map_lookup_not_existing);
+    return tc;
+}
+
+TCase *check_radix_insert_many_and_lookup(void) {
+    TCase *tc = tcase_create("check_radix_insert_many_and_lookup");
+    tcase_add_unchecked_fixture(tc, setup_radix, teardown_map);
+    tcase_add_test(tc, test_map_insert_many_and_lookup);
+    return tc;
+}
+
+TCase *check_radix_insert_many_and_remove_all(void) {
+    TCase *tc = tcase_create("check_radix_insert_many_and_remove_all");
+    tcase_add_unchecked_fixture(tc, setup_radix, teardown_map);
+    tcase_add_test(tc, test_map_insert_many_and_remove_all);
+    return tc;
+}
+
+TCase *check_radix_insert_update(void) {
+    TCase *tc = tcase_create("check_radix_insert_update");
+    tcase_add_unchecked_fixture(tc, setup_radix, teardown_map);
+    tcase_add_test(tc, test_map_insert_update);
+    return tc;
+}
+
+TCase *check_radix_slices(void) {
+    TCase *tc = tcase_create("check_radix_slices");
+    tcase_add_unchecked_fixture(tc, setup_radix, teardown_map);
+    tcase_add_test(tc, test_map_slices);
+    return tc;
+}
+
+TCase *check_radix_lookup_batch(void) {
+    TCase *tc = tcase_create("check_radix_lookup_batch");
+    tcase_add_unchecked_fixture(tc, setup_radix, teardown_map);
+    tcase_add_test(tc, test_map_lookup_batch);
+    return tc;
+}
+
+TCase *check_radix_remove_interleaved(void) {
+    TCase *tc = tcase_create("check_radix_remove_interleaved");
+    tcase_add_unchecked_fixture(tc, setup_radix, teardown_map);
+    tcase_add_test(tc, test_map_remove_interleaved);
+    return tc;
+}
+
+TCase *check_radix_reserve(void) {
+    TCase *tc = tcase_create("check_radix_reserve");
+    tcase_add_unchecked_fixture(tc, setup_radix, teardown_map);
+    tcase_add_test(tc, test_map_reserve);
+    return tc;
+}
+
+TCase *check_radix_nodes(void) {
+    TCase *tc = tcase_create("check_radix_nodes");
+    tcase_add_unchecked_fixture(tc, setup_radix, teardown_map);
+    tcase_add_test(tc, test_radix_nodes);
+    return tc;
+}
+
+TCase *check_radix_long_prefix(void) {
+    TCase *tc = tcase_create("check_radix_long_prefix");
+    tcase_add_unchecked_fixture(tc, setup_radix, teardown_map);
+    tcase_add_test(tc, test_radix_long_prefix);
+    return tc;
+}
+
+TCase *check_radix_prefix_scan(void) {
+    TCase *tc = tcase_create("check_radix_prefix_scan");
+    tcase_add_unchecked_fixture(tc, setup_radix, teardown_map);
+    tcase_add_test(tc, test_radix_prefix_scan);
+    return tc;
+}
+
+Suite *check_radix_suite(void) {
+    Suite *suite = suite_create("check_radix");
+    suite_add_tcase(suite, check_radix_insert_and_lookup());
+    suite_add_tcase(suite, check_radix_lookup_not_existing());
+    suite_add_tcase(suite, check_radix_insert_many_and_lookup());
+    suite_add_tcase(suite, check_radix_insert_many_and_remove_all());
+    suite_add_tcase(suite, check_radix_insert_update());
+    suite_add_tcase(suite, check_radix_slices());
+    suite_add_tcase(suite, check_radix_lookup_batch());
+    suite_add_tcase(suite, check_radix_remove_interleaved());
+    suite_add_tcase(suite, check_radix_reserve());
+    suite_add_tcase(suite, check_radix_nodes());
+    suite_add_tcase(suite, check_radix_long_prefix());
+    suite_add_tcase(suite, check_radix_prefix_scan());
+    return suite;
+}
+
+
 TCase *check_shmap_insert_and_lookup(void) {
     TCase *tc = tcase_create("check_shmap_insert_and_lookup");
     tcase_add_unchecked_fixture(tc, setup_shmap, teardown_map);
@@ -221,6 +1725,27 @@ TCase *check_shmap_insert_update(void) {
     return tc;
 }
 
+TCase *check_shmap_slices(void) {
+    TCase *tc = tcase_create("check_shmap_slices");
+    tcase_add_unchecked_fixture(tc, setup_shmap, teardown_map);
+    tcase_add_test(tc, test_map_slices);
+    return tc;
+}
+
+TCase *check_shmap_lookup_batch(void) {
+    TCase *tc = tcase_create("check_shmap_lookup_batch");
+    tcase_add_unchecked_fixture(tc, setup_shmap, teardown_map);
+    tcase_add_test(tc, test_map_lookup_batch);
+    return tc;
+}
+
+TCase *check_shmap_reserve(void) {
+    TCase *tc = tcase_create("check_shmap_reserve");
+    tcase_add_unchecked_fixture(tc, setup_shmap, teardown_map);
+    tcase_add_test(tc, test_map_reserve);
+    return tc;
+}
+
 Suite *check_shmap_suite(void) {
     Suite *suite = suite_create("check_shmap");
     suite_add_tcase(suite, check_shmap_insert_and_lookup());
@@ -228,6 +1753,9 @@ Suite *check_shmap_suite(void) {
     suite_add_tcase(suite, check_shmap_insert_many_and_lookup());
     suite_add_tcase(suite, check_shmap_insert_many_and_remove_all());
     suite_add_tcase(suite, check_shmap_insert_update());
+    suite_add_tcase(suite, check_shmap_slices());
+    suite_add_tcase(suite, check_shmap_lookup_batch());
+    suite_add_tcase(suite, check_shmap_reserve());
     return suite;
 }
 
@@ -266,6 +1794,62 @@ TCase *check_hmap_insert_update(void) {
     return tc;
 }
 
+TCase *check_hmap_slices(void) {
+    TCase *tc = tcase_create("check_hmap_slices");
+    tcase_add_unchecked_fixture(tc, setup_hmap, teardown_map);
+    tcase_add_test(tc, test_map_slices);
+    return tc;
+}
+
+TCase *check_hmap_lookup_batch(void) {
+    TCase *tc = tcase_create("check_hmap_lookup_batch");
+    tcase_add_unchecked_fixture(tc, setup_hmap, teardown_map);
+    tcase_add_test(tc, test_map_lookup_batch);
+    return tc;
+}
+
+TCase *check_hmap_reserve(void) {
+    TCase *tc = tcase_create("check_hmap_reserve");
+    tcase_add_unchecked_fixture(tc, setup_hmap, teardown_map);
+    tcase_add_test(tc, test_map_reserve);
+    return tc;
+}
+
+TCase *check_hmap_reserve_no_growth(void) {
+    TCase *tc = tcase_create("check_hmap_reserve_no_growth");
+    tcase_add_unchecked_fixture(tc, setup_hmap, teardown_map);
+    tcase_add_test(tc, test_hmap_reserve_no_growth);
+    return tc;
+}
+
+TCase *check_hmap_shrink(void) {
+    TCase *tc = tcase_create("check_hmap_shrink");
+    tcase_add_unchecked_fixture(tc, setup_hmap, teardown_map);
+    tcase_add_test(tc, test_hmap_shrink);
+    return tc;
+}
+
+TCase *check_hmap_iter_unsupported(void) {
+    TCase *tc = tcase_create("check_hmap_iter_unsupported");
+    tcase_add_unchecked_fixture(tc, setup_hmap, teardown_map);
+    tcase_add_test(tc, test_map_iter_unsupported);
+    return tc;
+}
+
+TCase *check_hmap_insert_sorted(void) {
+    TCase *tc = tcase_create("check_hmap_insert_sorted");
+    tcase_add_unchecked_fixture(tc, setup_hmap, teardown_map);
+    tcase_add_test(tc, test_map_insert_sorted);
+    return tc;
+}
+
+TCase *check_hmap_rank_unsupported(void) {
+    TCase *tc = tcase_create("check_hmap_rank_unsupported");
+    tcase_add_unchecked_fixture(tc, setup_hmap, teardown_map);
+    tcase_add_test(tc, test_map_rank_unsupported);
+    return tc;
+}
+
 Suite *check_hmap_suite(void) {
     Suite *suite = suite_create("check_hmap");
     suite_add_tcase(suite, check_hmap_insert_and_lookup());
@@ -273,5 +1857,421 @@ Suite *check_hmap_suite(void) {
     suite_add_tcase(suite, check_hmap_insert_many_and_lookup());
     suite_add_tcase(suite, check_hmap_insert_many_and_remove_all());
     suite_add_tcase(suite, check_hmap_insert_update());
+    suite_add_tcase(suite, check_hmap_slices());
+    suite_add_tcase(suite, check_hmap_lookup_batch());
+    suite_add_tcase(suite, check_hmap_reserve());
+    suite_add_tcase(suite, check_hmap_reserve_no_growth());
+    suite_add_tcase(suite, check_hmap_shrink());
+    suite_add_tcase(suite, check_hmap_iter_unsupported());
+    suite_add_tcase(suite, check_hmap_insert_sorted());
+    suite_add_tcase(suite, check_hmap_rank_unsupported());
+    return suite;
+}
+
+TCase *check_swissmap_insert_and_lookup(void) {
+    TCase *tc = tcase_create("check_swissmap_insert_and_lookup");
+    tcase_add_unchecked_fixture(tc, setup_swissmap, teardown_map);
+    tcase_add_test(tc, test_map_insert_and_lookup);
+    return tc;
+}
+
+TCase *check_swissmap_lookup_not_existing(void) {
+    TCase *tc = tcase_create("check_swissmap_lookup_not_existing");
+    tcase_add_unchecked_fixture(tc, setup_swissmap, teardown_map);
+    tcase_add_test(tc, test_map_lookup_not_existing);
+    return tc;
+}
+
+TCase *check_swissmap_insert_many_and_lookup(void) {
+    TCase *tc = tcase_create("check_swissmap_insert_many_and_lookup");
+    tcase_add_unchecked_fixture(tc, setup_swissmap, teardown_map);
+    tcase_add_test(tc, test_map_insert_many_and_lookup);
+    return tc;
+}
+
+TCase *check_swissmap_insert_many_and_remove_all(void) {
+    TCase *tc = tcase_create("check_swissmap_insert_many_and_remove_all");
+    tcase_add_unchecked_fixture(tc, setup_swissmap, teardown_map);
+    tcase_add_test(tc, test_map_insert_many_and_remove_all);
+    return tc;
+}
+
+TCase *check_swissmap_insert_update(void) {
+    TCase *tc = tcase_create("check_swissmap_insert_update");
+    tcase_add_unchecked_fixture(tc, setup_swissmap, teardown_map);
+    tcase_add_test(tc, test_map_insert_update);
+    return tc;
+}
+
+TCase *check_swissmap_slices(void) {
+    TCase *tc = tcase_create("check_swissmap_slices");
+    tcase_add_unchecked_fixture(tc, setup_swissmap, teardown_map);
+    tcase_add_test(tc, test_map_slices);
+    return tc;
+}
+
+TCase *check_swissmap_lookup_batch(void) {
+    TCase *tc = tcase_create("check_swissmap_lookup_batch");
+    tcase_add_unchecked_fixture(tc, setup_swissmap, teardown_map);
+    tcase_add_test(tc, test_map_lookup_batch);
+    return tc;
+}
+
+TCase *check_swissmap_reserve(void) {
+    TCase *tc = tcase_create("check_swissmap_reserve");
+    tcase_add_unchecked_fixture(tc, setup_swissmap, teardown_map);
+    tcase_add_test(tc, test_map_reserve);
+    return tc;
+}
+
+Suite *check_swissmap_suite(void) {
+    Suite *suite = suite_create("check_swissmap");
+    suite_add_tcase(suite, check_swissmap_insert_and_lookup());
+    suite_add_tcase(suite, check_swissmap_lookup_not_existing());
+    suite_add_tcase(suite, check_swissmap_insert_many_and_lookup());
+    suite_add_tcase(suite, check_swissmap_insert_many_and_remove_all());
+    suite_add_tcase(suite, check_swissmap_insert_update());
+    suite_add_tcase(suite, check_swissmap_slices());
+    suite_add_tcase(suite, check_swissmap_lookup_batch());
+    suite_add_tcase(suite, check_swissmap_reserve());
+    return suite;
+}
+
+TCase *check_rhmap_insert_and_lookup(void) {
+    TCase *tc = tcase_create("check_rhmap_insert_and_lookup");
+    tcase_add_unchecked_fixture(tc, setup_rhmap, teardown_map);
+    tcase_add_test(tc, test_map_insert_and_lookup);
+    return tc;
+}
+
+TCase *check_rhmap_lookup_not_existing(void) {
+    TCase *tc = tcase_create("check_rhmap_lookup_not_existing");
+    tcase_add_unchecked_fixture(tc, setup_rhmap, teardown_map);
+    tcase_add_test(tc, test_map_lookup_not_existing);
+    return tc;
+}
+
+TCase *check_rhmap_insert_many_and_lookup(void) {
+    TCase *tc = tcase_create("check_rhmap_insert_many_and_lookup");
+    tcase_add_unchecked_fixture(tc, setup_rhmap, teardown_map);
+    tcase_add_test(tc, test_map_insert_many_and_lookup);
+    return tc;
+}
+
+TCase *check_rhmap_insert_many_and_remove_all(void) {
+    TCase *tc = tcase_create("check_rhmap_insert_many_and_remove_all");
+    tcase_add_unchecked_fixture(tc, setup_rhmap, teardown_map);
+    tcase_add_test(tc, test_map_insert_many_and_remove_all);
+    return tc;
+}
+
+TCase *check_rhmap_insert_update(void) {
+    TCase *tc = tcase_create("check_rhmap_insert_update");
+    tcase_add_unchecked_fixture(tc, setup_rhmap, teardown_map);
+    tcase_add_test(tc, test_map_insert_update);
+    return tc;
+}
+
+TCase *check_rhmap_slices(void) {
+    TCase *tc = tcase_create("check_rhmap_slices");
+    tcase_add_unchecked_fixture(tc, setup_rhmap, teardown_map);
+    tcase_add_test(tc, test_map_slices);
+    return tc;
+}
+
+TCase *check_rhmap_lookup_batch(void) {
+    TCase *tc = tcase_create("check_rhmap_lookup_batch");
+    tcase_add_unchecked_fixture(tc, setup_rhmap, teardown_map);
+    tcase_add_test(tc, test_map_lookup_batch);
+    return tc;
+}
+
+TCase *check_rhmap_reserve(void) {
+    TCase *tc = tcase_create("check_rhmap_reserve");
+    tcase_add_unchecked_fixture(tc, setup_rhmap, teardown_map);
+    tcase_add_test(tc, test_map_reserve);
+    return tc;
+}
+
+TCase *check_rhmap_stats(void) {
+    TCase *tc = tcase_create("check_rhmap_stats");
+    tcase_add_unchecked_fixture(tc, setup_rhmap, teardown_map);
+    tcase_add_test(tc, test_rhmap_stats);
+    return tc;
+}
+
+Suite *check_rhmap_suite(void) {
+    Suite *suite = suite_create("check_rhmap");
+    suite_add_tcase(suite, check_rhmap_insert_and_lookup());
+    suite_add_tcase(suite, check_rhmap_lookup_not_existing());
+    suite_add_tcase(suite, check_rhmap_insert_many_and_lookup());
+    suite_add_tcase(suite, check_rhmap_insert_many_and_remove_all());
+    suite_add_tcase(suite, check_rhmap_insert_update());
+    suite_add_tcase(suite, check_rhmap_slices());
+    suite_add_tcase(suite, check_rhmap_lookup_batch());
+    suite_add_tcase(suite, check_rhmap_reserve());
+    suite_add_tcase(suite, check_rhmap_stats());
+    return suite;
+}
+
+TCase *check_cuckoomap_insert_and_lookup(void) {
+    TCase *tc = tcase_create("check_cuckoomap_insert_and_lookup");
+    tcase_add_unchecked_fixture(tc, setup_cuckoomap, teardown_map);
+    tcase_add_test(tc, test_map_insert_and_lookup);
+    return tc;
+}
+
+TCase *check_cuckoomap_lookup_not_existing(void) {
+    TCase *tc = tcase_create("check_cuckoomap_lookup_not_existing");
+    tcase_add_unchecked_fixture(tc, setup_cuckoomap, teardown_map);
+    tcase_add_test(tc, test_map_lookup_not_existing);
+    return tc;
+}
+
+TCase *check_cuckoomap_insert_many_and_lookup(void) {
+    TCase *tc = tcase_create("check_cuckoomap_insert_many_and_lookup");
+    tcase_add_unchecked_fixture(tc, setup_cuckoomap, teardown_map);
+    tcase_add_test(tc, test_map_insert_many_and_lookup);
+    return tc;
+}
+
+TCase *check_cuckoomap_insert_many_and_remove_all(void) {
+    TCase *tc = tcase_create("check_cuckoomap_insert_many_and_remove_all");
+    tcase_add_unchecked_fixture(tc, setup_cuckoomap, teardown_map);
+    tcase_add_test(tc, test_map_insert_many_and_remove_all);
+    return tc;
+}
+
+TCase *check_cuckoomap_insert_update(void) {
+    TCase *tc = tcase_create("check_cuckoomap_insert_update");
+    tcase_add_unchecked_fixture(tc, setup_cuckoomap, teardown_map);
+    tcase_add_test(tc, test_map_insert_update);
+    return tc;
+}
+
+TCase *check_cuckoomap_slices(void) {
+    TCase *tc = tcase_create("check_cuckoomap_slices");
+    tcase_add_unchecked_fixture(tc, setup_cuckoomap, teardown_map);
+    tcase_add_test(tc, test_map_slices);
+    return tc;
+}
+
+TCase *check_cuckoomap_lookup_batch(void) {
+    TCase *tc = tcase_create("check_cuckoomap_lookup_batch");
+    tcase_add_unchecked_fixture(tc, setup_cuckoomap, teardown_map);
+    tcase_add_test(tc, test_map_lookup_batch);
+    return tc;
+}
+
+TCase *check_cuckoomap_reserve(void) {
+    TCase *tc = tcase_create("check_cuckoomap_reserve");
+    tcase_add_unchecked_fixture(tc, setup_cuckoomap, teardown_map);
+    tcase_add_test(tc, test_map_reserve);
+    return tc;
+}
+
+TCase *check_cuckoomap_high_load(void) {
+    TCase *tc = tcase_create("check_cuckoomap_high_load");
+    tcase_add_unchecked_fixture(tc, setup_cuckoomap, teardown_map);
+    tcase_add_test(tc, test_cuckoomap_high_load);
+    return tc;
+}
+
+TCase *check_cuckoomap_colliding_keys(void) {
+    TCase *tc = tcase_create("check_cuckoomap_colliding_keys");
+    tcase_add_unchecked_fixture(tc, setup_cuckoomap, teardown_map);
+    tcase_add_test(tc, test_cuckoomap_colliding_keys);
+    return tc;
+}
+
+Suite *check_cuckoomap_suite(void) {
+    Suite *suite = suite_create("check_cuckoomap");
+    suite_add_tcase(suite, check_cuckoomap_insert_and_lookup());
+    suite_add_tcase(suite, check_cuckoomap_lookup_not_existing());
+    suite_add_tcase(suite, check_cuckoomap_insert_many_and_lookup());
+    suite_add_tcase(suite, check_cuckoomap_insert_many_and_remove_all());
+    suite_add_tcase(suite, check_cuckoomap_insert_update());
+    suite_add_tcase(suite, check_cuckoomap_slices());
+    suite_add_tcase(suite, check_cuckoomap_lookup_batch());
+    suite_add_tcase(suite, check_cuckoomap_reserve());
+    suite_add_tcase(suite, check_cuckoomap_high_load());
+    suite_add_tcase(suite, check_cuckoomap_colliding_keys());
+    return suite;
+}
+
+TCase *check_bloommap_insert_and_lookup(void) {
+    TCase *tc = tcase_create("check_bloommap_insert_and_lookup");
+    tcase_add_unchecked_fixture(tc, setup_bloommap, teardown_map);
+    tcase_add_test(tc, test_map_insert_and_lookup);
+    return tc;
+}
+
+TCase *check_bloommap_lookup_not_existing(void) {
+    TCase *tc = tcase_create("check_bloommap_lookup_not_existing");
+    tcase_add_unchecked_fixture(tc, setup_bloommap, teardown_map);
+    tcase_add_test(tc, test_map_lookup_not_existing);
+    return tc;
+}
+
+TCase *check_bloommap_insert_many_and_lookup(void) {
+    TCase *tc = tcase_create("check_bloommap_insert_many_and_lookup");
+    tcase_add_unchecked_fixture(tc, setup_bloommap, teardown_map);
+    tcase_add_test(tc, test_map_insert_many_and_lookup);
+    return tc;
+}
+
+TCase *check_bloommap_insert_many_and_remove_all(void) {
+    TCase *tc = tcase_create("check_bloommap_insert_many_and_remove_all");
+    tcase_add_unchecked_fixture(tc, setup_bloommap, teardown_map);
+    tcase_add_test(tc, test_map_insert_many_and_remove_all);
+    return tc;
+}
+
+TCase *check_bloommap_insert_update(void) {
+    TCase *tc = tcase_create("check_bloommap_insert_update");
+    tcase_add_unchecked_fixture(tc, setup_bloommap, teardown_map);
+    tcase_add_test(tc, test_map_insert_update);
+    return tc;
+}
+
+TCase *check_bloommap_slices(void) {
+    TCase *tc = tcase_create("check_bloommap_slices");
+    tcase_add_unchecked_fixture(tc, setup_bloommap, teardown_map);
+    tcase_add_test(tc, test_map_slices);
+    return tc;
+}
+
+TCase *check_bloommap_lookup_batch(void) {
+    TCase *tc = tcase_create("check_bloommap_lookup_batch");
+    tcase_add_unchecked_fixture(tc, setup_bloommap, teardown_map);
+    tcase_add_test(tc, test_map_lookup_batch);
+    return tc;
+}
+
+TCase *check_bloommap_reserve(void) {
+    TCase *tc = tcase_create("check_bloommap_reserve");
+    tcase_add_unchecked_fixture(tc, setup_bloommap, teardown_map);
+    tcase_add_test(tc, test_map_reserve);
+    return tc;
+}
+
+TCase *check_bloommap_overfill(void) {
+    TCase *tc = tcase_create("check_bloommap_overfill");
+    tcase_add_unchecked_fixture(tc, setup_bloommap, teardown_map);
+    tcase_add_test(tc, test_bloommap_overfill);
+    return tc;
+}
+
+Suite *check_bloommap_suite(void) {
+    Suite *suite = suite_create("check_bloommap");
+    suite_add_tcase(suite, check_bloommap_insert_and_lookup());
+    suite_add_tcase(suite, check_bloommap_lookup_not_existing());
+    suite_add_tcase(suite, check_bloommap_insert_many_and_lookup());
+    suite_add_tcase(suite, check_bloommap_insert_many_and_remove_all());
+    suite_add_tcase(suite, check_bloommap_insert_update());
+    suite_add_tcase(suite, check_bloommap_slices());
+    suite_add_tcase(suite, check_bloommap_lookup_batch());
+    suite_add_tcase(suite, check_bloommap_reserve());
+    suite_add_tcase(suite, check_bloommap_overfill());
+    return suite;
+}
+
+TCase *check_lrucache_insert_and_lookup(void) {
+    TCase *tc = tcase_create("check_lrucache_insert_and_lookup");
+    tcase_add_unchecked_fixture(tc, setup_lrucache, teardown_map);
+    tcase_add_test(tc, test_map_insert_and_lookup);
+    return tc;
+}
+
+TCase *check_lrucache_lookup_not_existing(void) {
+    TCase *tc = tcase_create("check_lrucache_lookup_not_existing");
+    tcase_add_unchecked_fixture(tc, setup_lrucache, teardown_map);
+    tcase_add_test(tc, test_map_lookup_not_existing);
+    return tc;
+}
+
+TCase *check_lrucache_insert_many_and_lookup(void) {
+    TCase *tc = tcase_create("check_lrucache_insert_many_and_lookup");
+    tcase_add_unchecked_fixture(tc, setup_lrucache, teardown_map);
+    tcase_add_test(tc, test_map_insert_many_and_lookup);
+    return tc;
+}
+
+TCase *check_lrucache_insert_many_and_remove_all(void) {
+    TCase *tc = tcase_create("check_lrucache_insert_many_and_remove_all");
+    tcase_add_unchecked_fixture(tc, setup_lrucache, teardown_map);
+    tcase_add_test(tc, test_map_insert_many_and_remove_all);
+    return tc;
+}
+
+TCase *check_lrucache_insert_update(void) {
+    TCase *tc = tcase_create("check_lrucache_insert_update");
+    tcase_add_unchecked_fixture(tc, setup_lrucache, teardown_map);
+    tcase_add_test(tc, test_map_insert_update);
+    return tc;
+}
+
+TCase *check_lrucache_slices(void) {
+    TCase *tc = tcase_create("check_lrucache_slices");
+    tcase_add_unchecked_fixture(tc, setup_lrucache, teardown_map);
+    tcase_add_test(tc, test_map_slices);
+    return tc;
+}
+
+TCase *check_lrucache_lookup_batch(void) {
+    TCase *tc = tcase_create("check_lrucache_lookup_batch");
+    tcase_add_unchecked_fixture(tc, setup_lrucache, teardown_map);
+    tcase_add_test(tc, test_map_lookup_batch);
+    return tc;
+}
+
+TCase *check_lrucache_reserve(void) {
+    TCase *tc = tcase_create("check_lrucache_reserve");
+    tcase_add_unchecked_fixture(tc, setup_lrucache, teardown_map);
+    tcase_add_test(tc, test_map_reserve);
+    return tc;
+}
+
+TCase *check_lrucache_churn(void) {
+    TCase *tc = tcase_create("check_lrucache_churn");
+    tcase_add_unchecked_fixture(tc, setup_lrucache, teardown_map);
+    tcase_add_test(tc, test_lrucache_churn);
+    return tc;
+}
+
+TCase *check_lrucache_evict(void) {
+    TCase *tc = tcase_create("check_lrucache_evict");
+    tcase_add_test(tc, test_lrucache_evict);
+    return tc;
+}
+
+Suite *check_lrucache_suite(void) {
+    Suite *suite = suite_create("check_lrucache");
+    suite_add_tcase(suite, check_lrucache_insert_and_lookup());
+    suite_add_tcase(suite, check_lrucache_lookup_not_existing());
+    suite_add_tcase(suite, check_lrucache_insert_many_and_lookup());
+    suite_add_tcase(suite, check_lrucache_insert_many_and_remove_all());
+    suite_add_tcase(suite, check_lrucache_insert_update());
+    suite_add_tcase(suite, check_lrucache_slices());
+    suite_add_tcase(suite, check_lrucache_lookup_batch());
+    suite_add_tcase(suite, check_lrucache_reserve());
+    suite_add_tcase(suite, check_lrucache_churn());
+    suite_add_tcase(suite, check_lrucache_evict());
+    return suite;
+}
+
+Suite *check_bloom_suite(void) {
+    Suite *suite = suite_create("check_bloom");
+    TCase *tc = tcase_create("check_bloom_fpr");
+    tcase_add_test(tc, test_bloom_fpr);
+    suite_add_tcase(suite, tc);
+    return suite;
+}
+
+Suite *check_hash_suite(void) {
+    Suite *suite = suite_create("check_hash");
+    TCase *tc = tcase_create("check_hash_family");
+    tcase_add_test(tc, test_hash_family);
+    suite_add_tcase(suite, tc);
     return suite;
 }
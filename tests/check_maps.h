@@ -7,8 +7,28 @@ Suite *check_bstree_suite(void);
 
 Suite *check_avltree_suite(void);
 
+Suite *check_pavltree_suite(void);
+
+Suite *check_bptree_suite(void);
+
+Suite *check_radix_suite(void);
+
 Suite *check_shmap_suite(void);
 
 Suite *check_hmap_suite(void);
 
+Suite *check_swissmap_suite(void);
+
+Suite *check_rhmap_suite(void);
+
+Suite *check_cuckoomap_suite(void);
+
+Suite *check_bloommap_suite(void);
+
+Suite *check_bloom_suite(void);
+
+Suite *check_lrucache_suite(void);
+
+Suite *check_hash_suite(void);
+
 #endif // CHECK_MAPS_H